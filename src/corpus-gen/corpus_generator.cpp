@@ -0,0 +1,215 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file corpus_generator.cpp
+/// Contains implementation of the corpus_generator class.
+
+#include "corpus_generator.hpp"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace fs = std::filesystem;
+
+
+/// Output file stream counting written lines
+class line_counting_ostream {
+public:
+    /// Opens file at specified path for writing
+    explicit line_counting_ostream(const fs::path & path): str_{path} {
+        if (!str_.is_open()) {
+            std::ostringstream msg;
+            msg << "can't open corpus file " << path << " for writing";
+            throw std::runtime_error{msg.str()};
+        }
+    }
+
+    /// Writes line to file
+    void line(const std::string & s) {
+        str_ << s << '\n';
+        ++line_;
+    }
+
+    /// Returns number of the next line to write (1-based)
+    std::size_t next_line() const { return line_ + 1; }
+
+private:
+    std::ofstream str_;                     ///< Output file stream
+    std::size_t line_ = 0;                  ///< Number of written lines
+};
+
+
+/// Returns position string for file, line and column
+static std::string position(const fs::path & path, std::size_t line, std::size_t col) {
+    return path.filename().string() + ":" + std::to_string(line) + ":" + std::to_string(col);
+}
+
+
+/// Returns template parameters list "typename T0, typename T1, ..."
+static std::string params_list(std::size_t params, bool with_typename) {
+    std::string res;
+    for (std::size_t p = 0; p < params; ++p) {
+        if (p != 0) {
+            res += ", ";
+        }
+
+        if (with_typename) {
+            res += "typename ";
+        }
+
+        res += "T" + std::to_string(p);
+    }
+
+    return res;
+}
+
+
+corpus_generator::corpus_generator(const corpus_options & opts): opts_{opts} {
+    if (opts_.params == 0) {
+        throw std::runtime_error{"corpus templates must have at least one parameter"};
+    }
+
+    if (opts_.tus == 0) {
+        throw std::runtime_error{"corpus must have at least one translation unit"};
+    }
+}
+
+
+corpus_info corpus_generator::generate(const fs::path & dir) const {
+    fs::create_directories(dir);
+
+    corpus_info info;
+    info.param_positions.resize(opts_.templates);
+    info.use_positions.resize(opts_.templates);
+
+    // distributing templates over headers
+    for (std::size_t h = 0; h < opts_.headers; ++h) {
+        auto path = dir / ("corpus_" + std::to_string(h) + ".hpp");
+        auto first = opts_.templates * h / opts_.headers;
+        auto last = opts_.templates * (h + 1) / opts_.headers;
+        write_templates(path, first, last, info);
+        info.headers.push_back(path);
+    }
+
+    for (std::size_t t = 0; t < opts_.tus; ++t) {
+        auto path = dir / ("corpus_" + std::to_string(t) + ".cpp");
+        write_tu(path, t, info);
+        info.tus.push_back(path);
+    }
+
+    return info;
+}
+
+
+/// Writes template definitions to stream and records parameter positions
+static void write_template_defs(line_counting_ostream & ostr,
+                                const fs::path & path,
+                                const corpus_options & opts,
+                                std::size_t first, std::size_t last,
+                                corpus_info & info) {
+    auto templ_line = "template <" + params_list(opts.params, true) + ">";
+
+    for (auto i = first; i < last; ++i) {
+        auto name = "templ_" + std::to_string(i);
+
+        // recording positions of template parameters
+        auto line = ostr.next_line();
+        for (std::size_t p = 0; p < opts.params; ++p) {
+            auto col = templ_line.find("T" + std::to_string(p) + (p + 1 == opts.params ? ">" : ","));
+            info.param_positions[i].push_back(position(path, line, col + 1));
+        }
+
+        ostr.line(templ_line);
+        ostr.line("class " + name + " {");
+        ostr.line("public:");
+        for (std::size_t m = 0; m < opts.outline_members; ++m) {
+            auto par = "T" + std::to_string(m % opts.params);
+            ostr.line("    void method_" + std::to_string(m) + "(" + par + " x);");
+        }
+
+        ostr.line("private:");
+        for (std::size_t p = 0; p < opts.params; ++p) {
+            ostr.line("    T" + std::to_string(p) + " field_" + std::to_string(p) + "_;");
+        }
+
+        ostr.line("};");
+        ostr.line("");
+
+        // outline member definitions
+        for (std::size_t m = 0; m < opts.outline_members; ++m) {
+            auto par = "T" + std::to_string(m % opts.params);
+            ostr.line(templ_line);
+            ostr.line("void " + name + "<" + params_list(opts.params, false) + ">::method_" +
+                      std::to_string(m) + "(" + par + " x) {");
+            ostr.line("    " + name + "<" + params_list(opts.params, false) + "> tmp;");
+            ostr.line("    " + par + " y = x;");
+            ostr.line("}");
+            ostr.line("");
+        }
+    }
+}
+
+
+void corpus_generator::write_templates(const fs::path & path,
+                                       std::size_t first, std::size_t last,
+                                       corpus_info & info) const {
+    line_counting_ostream ostr{path};
+    ostr.line("#pragma once");
+    ostr.line("");
+    write_template_defs(ostr, path, opts_, first, last, info);
+}
+
+
+void corpus_generator::write_tu(const fs::path & path, std::size_t tu_idx,
+                                corpus_info & info) const {
+    line_counting_ostream ostr{path};
+
+    for (std::size_t h = 0; h < opts_.headers; ++h) {
+        ostr.line("#include \"corpus_" + std::to_string(h) + ".hpp\"");
+    }
+
+    ostr.line("");
+
+    // defining templates in translation unit if there are no headers
+    if (opts_.headers == 0) {
+        corpus_info tu_info;
+        tu_info.param_positions.resize(opts_.templates);
+        write_template_defs(ostr, path, opts_, 0, opts_.templates, tu_info);
+        if (tu_idx == 0) {
+            info.param_positions = std::move(tu_info.param_positions);
+        }
+    }
+
+    // instantiation sites with distinct argument types
+    for (std::size_t i = 0; i < opts_.templates; ++i) {
+        auto name = "templ_" + std::to_string(i);
+        for (std::size_t n = 0; n < opts_.insts; ++n) {
+            auto suffix = std::to_string(tu_idx) + "_" + std::to_string(i) + "_" +
+                std::to_string(n);
+            auto arg = "arg_" + suffix;
+
+            std::string args = "int";
+            for (std::size_t p = 1; p < opts_.params; ++p) {
+                args += ", " + arg;
+            }
+
+            ostr.line("struct " + arg + " {};");
+
+            auto func_prefix = "void use_" + suffix + "(";
+            auto pos = position(path, ostr.next_line(), func_prefix.size() + 1);
+            if (tu_idx == 0) {
+                info.use_positions[i].push_back(pos);
+            }
+
+            if (i == 0 && n + 1 == opts_.insts) {
+                info.tu_use_positions.push_back(pos);
+            }
+
+            ostr.line(func_prefix + name + "<" + args + "> x) {}");
+        }
+    }
+}
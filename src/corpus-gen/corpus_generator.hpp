@@ -0,0 +1,75 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file corpus_generator.hpp
+/// Contains definition of the corpus_generator class.
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+
+/// Parameters of generated C++ corpus
+struct corpus_options {
+    std::size_t templates = 10;             ///< Number of class templates
+    std::size_t params = 2;                 ///< Number of parameters of each template
+    std::size_t insts = 10;                 ///< Instantiation sites of each template in each TU
+    std::size_t outline_members = 1;        ///< Outline member definitions of each template
+    std::size_t tus = 1;                    ///< Number of translation units
+    std::size_t headers = 1;                ///< Number of headers included by each TU.
+                                            ///< Templates are defined in TUs if zero
+};
+
+
+/// Information about generated corpus
+struct corpus_info {
+    std::vector<std::filesystem::path> tus;     ///< Paths of translation units
+    std::vector<std::filesystem::path> headers; ///< Paths of headers
+
+    /// Positions ("file:line:column") of template parameters indexed by template and
+    /// parameter. Position refers to file containing template definition (the first
+    /// TU if templates are defined in TUs)
+    std::vector<std::vector<std::string>> param_positions;
+
+    /// Positions of template names at instantiation sites in the first TU indexed by
+    /// template and instantiation
+    std::vector<std::vector<std::string>> use_positions;
+
+    /// Positions of template name at the last instantiation site of the first template
+    /// indexed by TU. Empty if there are no instantiation sites
+    std::vector<std::string> tu_use_positions;
+};
+
+
+/// Generator of synthetic C++ corpora for scaling tests of refactor actions.
+/// Corpus consists of class templates with outline members distributed over headers
+/// and translation units instantiating each template with distinct argument types.
+/// Positions in generated files use file names only.
+class corpus_generator {
+public:
+    /// Constructs generator with specified corpus parameters
+    explicit corpus_generator(const corpus_options & opts);
+
+    /// Writes corpus to specified directory (created if not exists) and returns
+    /// information about generated files
+    corpus_info generate(const std::filesystem::path & dir) const;
+
+private:
+    /// Writes definitions of templates with specified indices to file and records
+    /// positions of template parameters
+    void write_templates(const std::filesystem::path & path,
+                         std::size_t first, std::size_t last,
+                         corpus_info & info) const;
+
+    /// Writes translation unit with specified index
+    void write_tu(const std::filesystem::path & path, std::size_t tu_idx,
+                  corpus_info & info) const;
+
+    corpus_options opts_;                   ///< Corpus parameters
+};
@@ -0,0 +1,74 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file main.cpp
+/// Main entry point to cxx-refactor-corpus-gen utility
+
+#include "corpus_generator.hpp"
+#include <iostream>
+#include <boost/program_options.hpp>
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+int main(int argc, char * argv[]) {
+    try {
+        corpus_options copts;
+
+        po::options_description opts{"cxx-refactor-corpus-gen arguments"};
+        opts.add_options()
+            ("help", "Produce help message and exit")
+            ("output-dir,o", po::value<fs::path>()->required(),
+                "Directory for generated corpus")
+            ("templates", po::value(&copts.templates)->default_value(copts.templates),
+                "Number of class templates")
+            ("params", po::value(&copts.params)->default_value(copts.params),
+                "Number of parameters of each template")
+            ("insts", po::value(&copts.insts)->default_value(copts.insts),
+                "Number of instantiation sites of each template in each translation unit")
+            ("outline-members", po::value(&copts.outline_members)->default_value(copts.outline_members),
+                "Number of outline member definitions of each template")
+            ("tus", po::value(&copts.tus)->default_value(copts.tus),
+                "Number of translation units")
+            ("headers", po::value(&copts.headers)->default_value(copts.headers),
+                "Number of headers included by each translation unit "
+                "(templates are defined in translation units if zero)");
+
+        po::variables_map var_map;
+        po::store(po::parse_command_line(argc, argv, opts), var_map);
+
+        if (var_map.count("help") > 0) {
+            std::cout << opts << std::endl;
+            return 1;
+        }
+
+        po::notify(var_map);
+
+        corpus_generator gen{copts};
+        auto info = gen.generate(var_map["output-dir"].as<fs::path>());
+
+        // printing generated translation units and positions for refactor actions
+        for (auto && tu : info.tus) {
+            std::cout << "translation unit: " << tu.string() << std::endl;
+        }
+
+        if (!info.param_positions.empty()) {
+            std::cout << "template parameter: " << info.param_positions[0].back() << std::endl;
+        }
+
+        if (!info.use_positions.empty() && !info.use_positions[0].empty()) {
+            std::cout << "template use: " << info.use_positions[0].front() << std::endl;
+        }
+    }
+    catch (std::exception & err) {
+        std::cerr << "ERROR: " << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file action_result.hpp
+/// Contains definition of the action_result class.
+
+#pragma once
+
+#include "multi_source_modifications.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+
+/// Result of refactor action extracted from code model: source modifications and
+/// messages for user. Does not reference code model, so code model may be released
+/// after result is extracted
+class action_result {
+public:
+    /// Constructs empty result
+    explicit action_result() = default;
+
+    /// Constructs result with source modifications
+    explicit action_result(multi_source_modifications && mods): mods_{std::move(mods)} {}
+
+    /// Returns const reference to source modifications
+    const auto & mods() const { return mods_; }
+
+    /// Returns reference to source modifications
+    auto & mods() { return mods_; }
+
+    /// Returns messages for user
+    const auto & messages() const { return messages_; }
+
+    /// Adds message for user
+    void add_message(const std::string & msg) { messages_.push_back(msg); }
+
+    /// Returns true if result contains neither modifications nor messages
+    bool empty() const { return mods_.empty() && messages_.empty(); }
+
+    /// Merges result extracted from another translation unit. Identical modifications
+    /// and messages are merged into one
+    void merge(action_result && other) {
+        mods_.merge(std::move(other.mods_));
+        for (auto && msg : other.messages_) {
+            if (std::ranges::find(messages_, msg) == messages_.end()) {
+                messages_.push_back(std::move(msg));
+            }
+        }
+    }
+
+private:
+    multi_source_modifications mods_;       ///< Source modifications
+    std::vector<std::string> messages_;     ///< Messages for user
+};
@@ -0,0 +1,49 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file apply_edits_action.cpp
+/// Contains implementation of the apply_edits_action class.
+
+#include "pch.hpp"
+#include "apply_edits_action.hpp"
+#include "edit_script.hpp"
+#include "refactor_stats.hpp"
+#include "source_modification_action.hpp"
+#include <boost/program_options.hpp>
+
+
+namespace po = boost::program_options;
+
+
+boost::program_options::options_description apply_edits_action::opts() const {
+    po::options_description desc{"apply-edits arguments"};
+    desc.add_options()
+        ("script", po::value<std::filesystem::path>()->required(),
+            "Path to edit script in JSON or binary format");
+    return desc;
+}
+
+
+action_result
+apply_edits_action::extract(const cm::src::source_code_model &,
+                            const boost::program_options::variables_map & opts) const {
+    stats_phase phase{"read-edits"};
+    memory_scope mem_scope{memory_subsystem::modifications};
+    auto mods = read_edit_script(opts["script"].as<std::filesystem::path>());
+
+    for (auto && [path, smods] : mods.mods()) {
+        refactor_stats::global().add(stats_counter::edits_produced, smods.size());
+    }
+
+    return action_result{std::move(mods)};
+}
+
+
+void apply_edits_action::output(const action_result & res,
+                                const boost::program_options::variables_map & opts) const {
+    refactor_action::output(res, opts);
+    source_modification_action::write_sources(res.mods(), std::cout);
+}
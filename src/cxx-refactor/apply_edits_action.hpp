@@ -0,0 +1,40 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file apply_edits_action.hpp
+/// Contains definition of the apply_edits_action class.
+
+#pragma once
+
+
+#include "refactor_action.hpp"
+
+
+/// Apply edits action. Replays edit script produced by external tool, see the
+/// parse_edit_script function for supported formats. Doesn't require code model
+class apply_edits_action: public refactor_action {
+public:
+    /// Constructs action
+    explicit apply_edits_action() = default;
+
+    /// Returns actions name
+    std::string name() const override { return "apply-edits"; }
+
+    /// Constructs and returns options description for this action
+    boost::program_options::options_description opts() const override;
+
+    /// Returns false, edits are read from script
+    bool requires_code_model() const override { return false; }
+
+    /// Reads source modifications from edit script, code model is not used
+    action_result extract(const cm::src::source_code_model & cm,
+                          const boost::program_options::variables_map & opts) const override;
+
+    /// Prints modified sources to standard output. Each source is preceded by
+    /// header with source path if multiple sources are modified
+    void output(const action_result & res,
+                const boost::program_options::variables_map & opts) const override;
+};
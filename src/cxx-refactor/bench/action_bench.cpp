@@ -0,0 +1,128 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file action_bench.cpp
+/// Contains benchmarks of AST lookup, refactor action pipelines and end-to-end runs.
+
+#include "bench.hpp"
+#include "../find_definition_action.hpp"
+#include "../source_rewriter.hpp"
+#include "../template_parameter_remove_action.hpp"
+#include <cm/src/cxx/clang/cmsrcclang.hpp>
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+/// Returns variables map with single position option
+static po::variables_map position_opts(const std::string & pos) {
+    po::variables_map opts;
+    opts.emplace("position", po::variable_value{pos, false});
+    return opts;
+}
+
+
+/// Measures lookup of AST nodes at positions of all template instantiations
+CXX_REFACTOR_BENCH(find_node_at_pos) {
+    for (std::size_t insts_count : {1000, 10000}) {
+        auto src_path = fs::temp_directory_path() / "cxx-refactor-bench-find-node.cpp";
+        write_template_source(src_path, insts_count);
+
+        cm::src::source_code_model cm;
+        cm::src::clang::parse_source_file(cm, src_path, {});
+
+        auto src = cm.find_source(src_path.filename(), true);
+        if (src == nullptr) {
+            throw std::runtime_error{"can't find benchmark source in code model"};
+        }
+
+        std::vector<cm::src::source_file_position> positions;
+        for (std::size_t i = 0; i < insts_count; ++i) {
+            auto pos_str = template_use_position(src_path, i);
+            auto pos_desc = cm::src::source_file_position_desc::from_string(pos_str);
+            positions.emplace_back(src->cm_src(), pos_desc.pos());
+        }
+
+        auto timing = bench_measure(ctx.repetitions(), [&]() {
+            for (auto && pos : positions) {
+                if (cm.find_node_at_pos(pos) == nullptr) {
+                    throw std::runtime_error{"can't find AST node at benchmark position"};
+                }
+            }
+        });
+
+        ctx.report("find_node_at_pos",
+                   {{"instantiations", insts_count}, {"lookups", positions.size()}},
+                   timing);
+
+        fs::remove(src_path);
+    }
+}
+
+
+/// Measures template parameter remove pipeline on parsed code model: collecting
+/// modifications and rewriting source
+CXX_REFACTOR_BENCH(template_parameter_remove_pipeline) {
+    for (std::size_t insts_count : {1000, 10000}) {
+        auto src_path = fs::temp_directory_path() / "cxx-refactor-bench-pipeline.cpp";
+        auto opts = position_opts(write_template_source(src_path, insts_count));
+
+        cm::src::source_code_model cm;
+        cm::src::clang::parse_source_file(cm, src_path, {});
+
+        template_parameter_remove_action action;
+        auto timing = bench_measure(ctx.repetitions(), [&]() {
+            auto mods = action.collect_mods(cm, opts, thread_pool::global());
+            std::ostringstream ostr;
+            source_rewriter rw;
+            for (auto && [file, smods] : mods.mods()) {
+                rw.rewrite(smods, mods.path(file), ostr);
+            }
+        });
+
+        ctx.report("template_parameter_remove_pipeline",
+                   {{"instantiations", insts_count}},
+                   timing);
+
+        fs::remove(src_path);
+    }
+}
+
+
+/// Measures end-to-end runs of actions: parsing source and performing action
+CXX_REFACTOR_BENCH(end_to_end) {
+    for (std::size_t insts_count : {1000, 10000}) {
+        auto src_path = fs::temp_directory_path() / "cxx-refactor-bench-end-to-end.cpp";
+        auto templ_pos = write_template_source(src_path, insts_count);
+        auto use_pos = template_use_position(src_path, insts_count / 2);
+
+        find_definition_action find_def;
+        template_parameter_remove_action tpr;
+
+        std::tuple<const char *, const refactor_action *, std::string> cases[] = {
+            {"find-definition", &find_def, use_pos},
+            {"template-parameter-remove", &tpr, templ_pos}
+        };
+
+        for (auto && [name, action, pos] : cases) {
+            auto opts = position_opts(pos);
+            auto timing = bench_measure(ctx.repetitions(), [&]() {
+                cm::src::source_code_model cm;
+                cm::src::clang::parse_source_file(cm, src_path, {});
+
+                cout_redirect redirect;
+                action->perform(cm, opts);
+            });
+
+            ctx.report(std::string{"end_to_end/"} + name,
+                       {{"instantiations", insts_count}},
+                       timing);
+        }
+
+        fs::remove(src_path);
+    }
+}
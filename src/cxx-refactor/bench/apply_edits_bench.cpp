@@ -0,0 +1,91 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file apply_edits_bench.cpp
+/// Contains benchmarks of reading edit scripts.
+
+#include "bench.hpp"
+#include "../edit_script.hpp"
+#include "../result_serialization.hpp"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+
+namespace fs = std::filesystem;
+
+
+/// Returns edit script in JSON format with specified number of edits spread over
+/// specified sources. Edits of each source are shuffled
+static std::string make_json_script(const std::vector<fs::path> & srcs, std::size_t edits_count) {
+    std::vector<std::size_t> order(edits_count);
+    for (std::size_t i = 0; i < edits_count; ++i) {
+        order[i] = i;
+    }
+
+    std::shuffle(order.begin(), order.end(), std::mt19937{42});
+
+    std::ostringstream ostr;
+    ostr << "{\"edits\": [\n";
+    for (std::size_t i = 0; i < edits_count; ++i) {
+        auto idx = order[i];
+        ostr << (i == 0 ? "" : ",\n")
+             << "{\"path\": \"" << srcs[idx % srcs.size()].string() << "\", "
+             << "\"offset\": " << idx / srcs.size() * 16 << ", \"length\": 8, "
+             << "\"replacement\": \"renamed_" << idx << "\"}";
+    }
+
+    ostr << "\n]}\n";
+    return ostr.str();
+}
+
+
+/// Measures parsing of edit scripts in JSON and binary formats
+CXX_REFACTOR_BENCH(apply_edits_parse) {
+    auto dir = fs::temp_directory_path() / "cxx-refactor-apply-edits-bench";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<fs::path> srcs;
+    for (std::size_t i = 0; i < 16; ++i) {
+        srcs.push_back(dir / ("src_" + std::to_string(i) + ".cpp"));
+        std::ofstream{srcs.back()};
+    }
+
+    for (std::size_t edits_count : {10000, 1000000}) {
+        auto json = make_json_script(srcs, edits_count);
+
+        std::ostringstream bin_ostr;
+        write_action_result(bin_ostr, action_result{parse_edit_script(json)});
+        auto bin = std::move(bin_ostr).str();
+
+        std::pair<const char *, const std::string *> formats[] = {
+            {"json", &json},
+            {"binary", &bin}
+        };
+
+        for (auto && [name, script] : formats) {
+            auto timing = bench_measure(ctx.repetitions(), [&]() {
+                auto mods = parse_edit_script(*script);
+                if (mods.mods().size() != srcs.size()) {
+                    throw std::runtime_error{"unexpected number of modified sources"};
+                }
+            });
+
+            ctx.report(std::string{"apply_edits_parse/"} + name,
+                       {{"edits", edits_count},
+                        {"bytes", script->size()}},
+                       timing);
+
+            ctx.report_metrics(std::string{"apply_edits_parse/"} + name,
+                               {{"edits", edits_count}},
+                               {{"edits_per_sec", edits_count / (timing.median_ns / 1e9)}});
+        }
+    }
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file arena_bench.cpp
+/// Contains benchmarks of arena allocation of small objects and code models.
+
+#include "bench.hpp"
+#include "../memory_arena.hpp"
+#include "corpus-gen/corpus_generator.hpp"
+#include <cm/src/cxx/clang/cmsrcclang.hpp>
+#include <memory>
+#include <optional>
+
+
+namespace fs = std::filesystem;
+
+
+/// Small AST-like node
+struct bench_node {
+    std::vector<bench_node*> children;      ///< Child nodes
+    std::string name;                       ///< Node name
+    std::size_t value = 0;                  ///< Node value
+};
+
+
+/// Allocates tree of nodes with specified number of nodes and adds them to vector.
+/// Vector must have capacity reserved for all nodes
+static void build_nodes(std::vector<bench_node*> & nodes, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        auto node = new bench_node{};
+        node->name = "node_name_" + std::to_string(i);
+        node->value = i;
+        if (i != 0) {
+            nodes[(i - 1) / 4]->children.push_back(node);
+        }
+        nodes.push_back(node);
+    }
+}
+
+
+/// Measures allocation and teardown of small objects with heap and arena
+CXX_REFACTOR_BENCH(arena_allocation) {
+    for (std::size_t count : {100000, 1000000}) {
+        for (bool use_arena : {false, true}) {
+            std::vector<double> alloc_times;
+            std::vector<double> teardown_times;
+
+            auto before = memory_arena::all_totals();
+            for (std::size_t rep = 0; rep < ctx.repetitions(); ++rep) {
+                std::optional<memory_arena> arena;
+                if (use_arena) {
+                    arena.emplace();
+                }
+
+                // vector of nodes is allocated outside of arena, it outlives arena
+                std::vector<bench_node*> nodes;
+                nodes.reserve(count);
+
+                auto alloc = bench_measure(1, [&]() {
+                    std::optional<arena_scope> scope;
+                    if (arena) {
+                        scope.emplace(*arena);
+                    }
+                    build_nodes(nodes, count);
+                });
+
+                auto teardown = bench_measure(1, [&]() {
+                    for (auto node : nodes) {
+                        delete node;
+                    }
+                    if (arena) {
+                        arena->release();
+                    }
+                });
+
+                alloc_times.push_back(alloc.min_ns);
+                teardown_times.push_back(teardown.min_ns);
+            }
+
+            auto after = memory_arena::all_totals();
+            double committed = static_cast<double>(after.committed_bytes - before.committed_bytes);
+            double requested = static_cast<double>(after.requested_bytes - before.requested_bytes);
+
+            std::string mode = use_arena ? "arena" : "heap";
+            ctx.report_metrics("arena_allocation/" + mode,
+                               {{"nodes", count}},
+                               {{"alloc_min_ns", *std::ranges::min_element(alloc_times)},
+                                {"teardown_min_ns", *std::ranges::min_element(teardown_times)},
+                                {"fragmentation", committed == 0 ? 0.0 : 1.0 - requested / committed}});
+        }
+    }
+}
+
+
+/// Measures parsing and release of code model of generated translation unit
+/// with heap and arena allocation
+CXX_REFACTOR_BENCH(arena_code_model) {
+    auto dir = fs::temp_directory_path() / "cxx-refactor-bench-arena";
+    corpus_options copts;
+    copts.templates = 20;
+    copts.insts = 200;
+    auto info = corpus_generator{copts}.generate(dir);
+
+    // warming up parser outside of arena
+    {
+        cm::src::source_code_model cm;
+        cm::src::clang::parse_source_file(cm, info.tus[0], {});
+    }
+
+    for (bool use_arena : {false, true}) {
+        std::vector<double> parse_times;
+        std::vector<double> release_times;
+
+        for (std::size_t rep = 0; rep < ctx.repetitions(); ++rep) {
+            std::optional<memory_arena> arena;
+            if (use_arena) {
+                arena.emplace();
+            }
+
+            auto cm = std::make_unique<cm::src::source_code_model>();
+            auto parse = bench_measure(1, [&]() {
+                std::optional<arena_scope> scope;
+                if (arena) {
+                    scope.emplace(*arena);
+                }
+                cm::src::clang::parse_source_file(*cm, info.tus[0], {});
+            });
+
+            auto release = bench_measure(1, [&]() {
+                cm.reset();
+                if (arena) {
+                    arena->release();
+                }
+            });
+
+            parse_times.push_back(parse.min_ns);
+            release_times.push_back(release.min_ns);
+        }
+
+        std::string mode = use_arena ? "arena" : "heap";
+        ctx.report_metrics("arena_code_model/" + mode,
+                           {{"templates", copts.templates}, {"insts", copts.insts}},
+                           {{"parse_min_ns", *std::ranges::min_element(parse_times)},
+                            {"release_min_ns", *std::ranges::min_element(release_times)}});
+    }
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file bench.cpp
+/// Contains main function for cxx-refactor benchmarks.
+
+#include "bench.hpp"
+#include <fstream>
+#include <iostream>
+#include <boost/program_options.hpp>
+
+
+namespace po = boost::program_options;
+
+
+int main(int argc, char * argv[]) {
+    try {
+        po::options_description opts{"cxx-refactor-bench arguments"};
+        opts.add_options()
+            ("help", "Produce help message and exit")
+            ("filter", po::value<std::string>()->default_value(""),
+                "Run only benchmarks which names contain specified string")
+            ("repetitions", po::value<std::size_t>()->default_value(5),
+                "Number of repetitions of each benchmark case")
+            ("output,o", po::value<std::string>(), "Path to output JSON file (default: stdout)");
+
+        po::variables_map var_map;
+        po::store(po::parse_command_line(argc, argv, opts), var_map);
+        po::notify(var_map);
+
+        if (var_map.count("help") > 0) {
+            std::cout << opts << std::endl;
+            std::cout << "Available benchmarks:" << std::endl;
+            for (auto && [name, fn] : bench_registry()) {
+                std::cout << "  " << name << std::endl;
+            }
+            return 1;
+        }
+
+        std::ofstream ofile;
+        if (var_map.count("output") > 0) {
+            ofile.open(var_map["output"].as<std::string>());
+            if (!ofile.is_open()) {
+                throw std::runtime_error{"can't open output file for writing"};
+            }
+        }
+
+        std::ostream & ostr = ofile.is_open() ? ofile : std::cout;
+        json_writer wr{ostr};
+        wr.begin_object();
+        wr.key("benchmarks").begin_array();
+
+        bench_context ctx{wr, var_map["repetitions"].as<std::size_t>()};
+        auto filter = var_map["filter"].as<std::string>();
+        for (auto && [name, fn] : bench_registry()) {
+            if (name.find(filter) == std::string::npos) {
+                continue;
+            }
+
+            std::cerr << "running benchmark " << name << std::endl;
+            fn(ctx);
+        }
+
+        wr.end_array();
+        wr.end_object();
+        ostr << std::endl;
+
+        // reporting problems flagged by benchmarks
+        if (!ctx.flags().empty()) {
+            for (auto && msg : ctx.flags()) {
+                std::cerr << "FLAGGED: " << msg << std::endl;
+            }
+
+            return 2;
+        }
+    }
+    catch (std::exception & err) {
+        std::cerr << "ERROR: " << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file bench.hpp
+/// Contains definitions of benchmark registration and measurement utilities.
+
+#pragma once
+
+#include "../json_writer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+/// Timing statistics of benchmark repetitions in nanoseconds
+struct bench_timing {
+    double min_ns = 0;                      ///< Minimal time
+    double median_ns = 0;                   ///< Median time
+    double mean_ns = 0;                     ///< Mean time
+    std::size_t repetitions = 0;            ///< Number of repetitions
+};
+
+
+/// Runs function specified number of times and returns timing statistics
+template <typename Fn>
+bench_timing bench_measure(std::size_t repetitions, Fn && fn) {
+    std::vector<double> times;
+    for (std::size_t i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    bench_timing res;
+    res.repetitions = times.size();
+    if (!times.empty()) {
+        res.min_ns = times.front();
+        res.median_ns = times[times.size() / 2];
+        for (auto t : times) {
+            res.mean_ns += t;
+        }
+        res.mean_ns /= times.size();
+    }
+
+    return res;
+}
+
+
+/// Benchmark execution context. Provides benchmark arguments and collects results
+class bench_context {
+public:
+    /// Constructs context writing results with specified JSON writer
+    explicit bench_context(json_writer & wr, std::size_t reps): wr_{wr}, reps_{reps} {}
+
+    /// Returns default number of repetitions
+    std::size_t repetitions() const { return reps_; }
+
+    /// Reports result of benchmark case with specified name and parameters
+    void report(const std::string & name,
+                const std::map<std::string, double> & params,
+                const bench_timing & timing) {
+        wr_.begin_object();
+        wr_.member("name", name);
+        wr_.key("params").begin_object();
+        for (auto && [key, val] : params) {
+            wr_.member(key, val);
+        }
+        wr_.end_object();
+        wr_.member("repetitions", timing.repetitions);
+        wr_.member("min_ns", timing.min_ns);
+        wr_.member("median_ns", timing.median_ns);
+        wr_.member("mean_ns", timing.mean_ns);
+        wr_.end_object();
+    }
+
+    /// Reports metrics computed by benchmark case with specified name and parameters
+    void report_metrics(const std::string & name,
+                        const std::map<std::string, double> & params,
+                        const std::map<std::string, double> & metrics) {
+        wr_.begin_object();
+        wr_.member("name", name);
+        wr_.key("params").begin_object();
+        for (auto && [key, val] : params) {
+            wr_.member(key, val);
+        }
+        wr_.end_object();
+        wr_.key("metrics").begin_object();
+        for (auto && [key, val] : metrics) {
+            wr_.member(key, val);
+        }
+        wr_.end_object();
+        wr_.end_object();
+    }
+
+    /// Flags problem detected by benchmark. Benchmark run fails if any problem is flagged
+    void flag(const std::string & msg) { flags_.push_back(msg); }
+
+    /// Returns flagged problems
+    const std::vector<std::string> & flags() const { return flags_; }
+
+private:
+    json_writer & wr_;                      ///< JSON writer for results
+    std::size_t reps_;                      ///< Default number of repetitions
+    std::vector<std::string> flags_;        ///< Flagged problems
+};
+
+
+/// Writes source with template class instantiated with specified number of
+/// different argument types. Returns position of the second template parameter
+std::string write_template_source(const std::filesystem::path & path, std::size_t insts_count);
+
+/// Returns position of template name in parameter of function using instantiation with
+/// specified index in source written by write_template_source
+std::string template_use_position(const std::filesystem::path & path, std::size_t inst_idx);
+
+
+/// Redirects standard output to string stream while alive
+class cout_redirect {
+public:
+    explicit cout_redirect(): old_buf_{std::cout.rdbuf(ostr_.rdbuf())} {}
+    ~cout_redirect() { std::cout.rdbuf(old_buf_); }
+
+    cout_redirect(const cout_redirect &) = delete;
+    cout_redirect & operator=(const cout_redirect &) = delete;
+
+private:
+    std::ostringstream ostr_;               ///< Stream receiving output
+    std::streambuf * old_buf_;              ///< Original buffer of standard output
+};
+
+
+/// Benchmark function
+using bench_fn = std::function<void(bench_context &)>;
+
+/// Returns reference to registry of all benchmarks
+inline std::map<std::string, bench_fn> & bench_registry() {
+    static std::map<std::string, bench_fn> registry;
+    return registry;
+}
+
+/// Registers benchmark function in registry on construction
+struct bench_registrar {
+    bench_registrar(const std::string & name, bench_fn fn) {
+        bench_registry().emplace(name, std::move(fn));
+    }
+};
+
+/// Defines and registers benchmark function with specified name
+#define CXX_REFACTOR_BENCH(name) \
+    static void name(bench_context & ctx); \
+    static bench_registrar name##_registrar{#name, name}; \
+    static void name([[maybe_unused]] bench_context & ctx)
@@ -0,0 +1,51 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file bench_sources.cpp
+/// Contains generators of sources used by benchmarks.
+
+#include "bench.hpp"
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+/// Number of lines in template definition before instantiations
+static constexpr std::size_t template_header_lines = 9;
+
+
+std::string write_template_source(const fs::path & path, std::size_t insts_count) {
+    std::ofstream ostr{path};
+    if (!ostr.is_open()) {
+        throw std::runtime_error{"can't open benchmark source for writing"};
+    }
+
+    std::string templ_line = "template <typename T1, typename T2>";
+    ostr << templ_line << "\n"
+         << "class my_class {\n"
+         << "public:\n"
+         << "    void foo(T1 x, T2 y);\n"
+         << "private:\n"
+         << "    T1 x_;\n"
+         << "    T2 y_;\n"
+         << "};\n\n";
+
+    for (std::size_t i = 0; i < insts_count; ++i) {
+        ostr << "struct arg_" << i << " {};\n"
+             << "void func_" << i << "(my_class<int, arg_" << i << "> x) {}\n";
+    }
+
+    auto col = templ_line.find("T2") + 1;
+    return path.filename().string() + ":1:" + std::to_string(col);
+}
+
+
+std::string template_use_position(const fs::path & path, std::size_t inst_idx) {
+    auto line = template_header_lines + 2 * inst_idx + 2;
+    auto col = ("void func_" + std::to_string(inst_idx) + "(").size() + 1;
+    return path.filename().string() + ":" + std::to_string(line) + ":" + std::to_string(col);
+}
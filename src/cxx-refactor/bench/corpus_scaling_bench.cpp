@@ -0,0 +1,155 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file corpus_scaling_bench.cpp
+/// Contains scaling tests of refactor actions on generated corpora.
+
+#include "bench.hpp"
+#include "../find_definition_action.hpp"
+#include "../memory_accounting.hpp"
+#include "../source_rewriter.hpp"
+#include "../template_parameter_remove_action.hpp"
+#include "corpus-gen/corpus_generator.hpp"
+#include <cm/src/cxx/clang/cmsrcclang.hpp>
+#include <cmath>
+#include <unistd.h>
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+/// Maximal allowed growth exponent of time and memory. Growth with larger exponent
+/// between the smallest and the largest corpus is flagged as super-linear
+static constexpr double max_growth_exponent = 1.3;
+
+
+/// Runs action on all translation units of corpus: parses each source, collects
+/// modifications or performs action with captured output
+static void run_action(const std::string & action_name, const corpus_info & info) {
+    for (std::size_t tu = 0; tu < info.tus.size(); ++tu) {
+        po::variables_map opts;
+        auto pos = action_name == "template-parameter-remove" ?
+            info.param_positions[0].back() : info.tu_use_positions[tu];
+        opts.emplace("position", po::variable_value{pos, false});
+
+        cm::src::source_code_model cm;
+        cm::src::clang::parse_source_file(cm, info.tus[tu], {});
+
+        if (action_name == "template-parameter-remove") {
+            template_parameter_remove_action action;
+            auto mods = action.collect_mods(cm, opts, thread_pool::global());
+            std::ostringstream ostr;
+            source_rewriter rw;
+            for (auto && [file, smods] : mods.mods()) {
+                rw.rewrite(smods, mods.path(file), ostr);
+            }
+        } else {
+            find_definition_action action;
+            cout_redirect redirect;
+            action.perform(cm, opts);
+        }
+    }
+}
+
+
+/// Returns growth exponent of value between two corpus sizes
+static double growth_exponent(double size1, double val1, double size2, double val2) {
+    return std::log(val2 / val1) / std::log(size2 / size1);
+}
+
+
+/// Corpus parameter varied by scaling test
+struct corpus_sweep {
+    const char * name;                              ///< Parameter name
+    std::size_t corpus_options::* param;            ///< Varied parameter
+    std::vector<std::size_t> values;                ///< Increasing parameter values
+};
+
+
+/// Runs actions on corpora with increasing values of each corpus parameter, other
+/// parameters keep base values. Flags super-linear growth of time or allocated memory
+CXX_REFACTOR_BENCH(corpus_scaling) {
+    auto base_dir = fs::temp_directory_path() /
+        ("cxx-refactor-bench-corpus-" + std::to_string(::getpid()));
+
+    corpus_options base;
+    base.templates = 10;
+    base.params = 2;
+    base.insts = 50;
+    base.outline_members = 2;
+    base.tus = 1;
+    base.headers = 1;
+
+    // templates are kept in headers, so parameter position is valid in all TUs
+    std::vector<corpus_sweep> sweeps{
+        {"insts", &corpus_options::insts, {50, 100, 200, 400}},
+        {"tus", &corpus_options::tus, {1, 2, 4, 8}},
+        {"headers", &corpus_options::headers, {1, 2, 4, 8}},
+        {"templates", &corpus_options::templates, {10, 20, 40, 80}},
+        {"params", &corpus_options::params, {2, 4, 8, 16}},
+        {"outline_members", &corpus_options::outline_members, {2, 4, 8, 16}},
+    };
+
+    for (std::string action_name : {"template-parameter-remove", "find-definition"}) {
+        for (auto && sweep : sweeps) {
+            std::vector<double> times;
+            std::vector<double> memory;
+
+            for (auto val : sweep.values) {
+                auto copts = base;
+                copts.*sweep.param = val;
+
+                auto dir = base_dir / (std::string{sweep.name} + "-" + std::to_string(val));
+                auto info = corpus_generator{copts}.generate(dir);
+
+                auto timing = bench_measure(ctx.repetitions(), [&]() {
+                    run_action(action_name, info);
+                });
+
+                // measuring memory allocated by single run
+                memory_accounting::set_enabled(true);
+                auto start = memory_accounting::all_totals();
+                run_action(action_name, info);
+                auto end = memory_accounting::all_totals();
+                memory_accounting::set_enabled(false);
+
+                times.push_back(timing.min_ns);
+                memory.push_back(static_cast<double>(end.allocated_bytes - start.allocated_bytes));
+
+                ctx.report("corpus_scaling/" + action_name + "/" + sweep.name,
+                           {{"templates", copts.templates}, {"params", copts.params},
+                            {"insts", copts.insts}, {"outline_members", copts.outline_members},
+                            {"tus", copts.tus}, {"headers", copts.headers}},
+                           timing);
+
+                fs::remove_all(dir);
+            }
+
+            auto min_val = static_cast<double>(sweep.values.front());
+            auto max_val = static_cast<double>(sweep.values.back());
+            auto time_exp = growth_exponent(min_val, times.front(), max_val, times.back());
+            auto mem_exp = growth_exponent(min_val, memory.front(), max_val, memory.back());
+
+            auto test_name = action_name + "/" + sweep.name;
+            ctx.report_metrics("corpus_scaling_growth/" + test_name,
+                               {{"min", sweep.values.front()}, {"max", sweep.values.back()}},
+                               {{"time_exponent", time_exp}, {"memory_exponent", mem_exp}});
+
+            if (time_exp > max_growth_exponent) {
+                ctx.flag(test_name + ": super-linear time growth, exponent " +
+                         std::to_string(time_exp));
+            }
+
+            if (mem_exp > max_growth_exponent) {
+                ctx.flag(test_name + ": super-linear memory growth, exponent " +
+                         std::to_string(mem_exp));
+            }
+        }
+    }
+
+    fs::remove_all(base_dir);
+}
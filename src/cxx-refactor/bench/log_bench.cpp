@@ -0,0 +1,68 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_bench.cpp
+/// Contains benchmarks of logging overhead with synchronous and asynchronous sinks.
+
+#include "bench.hpp"
+#include "log/log.hpp"
+#include "log/log_init.hpp"
+#include <filesystem>
+#include <thread>
+
+
+namespace fs = std::filesystem;
+
+
+/// Measures logging overhead per record on producer threads
+CXX_REFACTOR_BENCH(log_record_overhead) {
+    constexpr std::size_t records_per_thread = 100000;
+
+    auto log_path = fs::temp_directory_path() / "cxx-refactor-bench-log.txt";
+    std::size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+
+    struct sink_mode {
+        const char * name;
+        log_sink_options opts;
+    };
+
+    std::vector<sink_mode> modes{
+        {"sync", {false, 8192, log_overflow_policy::block}},
+        {"async-block", {true, 8192, log_overflow_policy::block}},
+        {"async-drop", {true, 8192, log_overflow_policy::drop}}
+    };
+
+    for (auto && mode : modes) {
+        for (std::size_t threads_count : {std::size_t{1}, max_threads}) {
+            log_init(false, log_path, mode.opts);
+
+            auto timing = bench_measure(ctx.repetitions(), [&]() {
+                std::vector<std::jthread> threads;
+                for (std::size_t t = 0; t < threads_count; ++t) {
+                    threads.emplace_back([t]() {
+                        for (std::size_t i = 0; i < records_per_thread; ++i) {
+                            REFACTOR_LOG_INFO(bench) << "benchmark record " << i
+                                                     << " from thread " << t;
+                        }
+                    });
+                }
+            });
+
+            log_shutdown();
+            fs::remove(log_path);
+
+            // converting timing to time per record
+            double records = static_cast<double>(records_per_thread * threads_count);
+            timing.min_ns /= records;
+            timing.median_ns /= records;
+            timing.mean_ns /= records;
+
+            ctx.report(std::string{"log_record_overhead/"} + mode.name,
+                       {{"threads", threads_count}, {"records_per_thread", records_per_thread}},
+                       timing);
+        }
+    }
+}
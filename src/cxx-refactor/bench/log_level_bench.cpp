@@ -0,0 +1,74 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_level_bench.cpp
+/// Contains benchmark of log statements removed at compile time versus filtered at runtime.
+
+#include "bench.hpp"
+#include "log_level_kernel.hpp"
+#include "log/log_init.hpp"
+
+
+namespace fs = std::filesystem;
+
+
+/// Traverses template uses with trace and debug log statements compiled out
+std::size_t traverse_template_uses_compiled_out(const cm::template_parameter * par);
+
+
+/// Returns template parameter located at specified position
+static const cm::template_parameter *
+find_template_parameter(const cm::src::source_code_model & cm, const std::string & pos_str) {
+    auto pos_desc = cm::src::source_file_position_desc::from_string(pos_str);
+    auto src = cm.find_source(pos_desc.path(), true);
+    if (src == nullptr) {
+        throw std::runtime_error{"can't find benchmark source in code model"};
+    }
+
+    cm::src::source_file_position pos{src->cm_src(), pos_desc.pos()};
+    auto ident = dynamic_cast<const cm::src::identifier*>(cm.find_node_at_pos(pos));
+    auto par = ident ? dynamic_cast<const cm::template_parameter*>(ident->entity()) : nullptr;
+    if (par == nullptr) {
+        throw std::runtime_error{"can't find template parameter in benchmark source"};
+    }
+
+    return par;
+}
+
+
+/// Measures traversal of template uses with trace logging compiled out and with
+/// trace logging compiled in but filtered at runtime
+CXX_REFACTOR_BENCH(log_level_template_uses) {
+    auto log_path = fs::temp_directory_path() / "cxx-refactor-bench-log-level.txt";
+    log_init(false, log_path);
+    refactor_log_configure(boost::log::trivial::info, {});
+
+    for (std::size_t insts_count : {1000, 10000}) {
+        auto src_path = fs::temp_directory_path() / "cxx-refactor-bench-log-level.cpp";
+        auto pos = write_template_source(src_path, insts_count);
+
+        cm::src::source_code_model cm;
+        cm::src::clang::parse_source_file(cm, src_path, {});
+        auto par = find_template_parameter(cm, pos);
+
+        std::pair<const char *, std::size_t (*)(const cm::template_parameter*)> modes[] = {
+            {"compiled-out", traverse_template_uses_compiled_out},
+            {"runtime-filtered", traverse_template_uses}
+        };
+
+        for (auto && [name, fn] : modes) {
+            auto timing = bench_measure(ctx.repetitions(), [&]() { fn(par); });
+            ctx.report(std::string{"log_level_template_uses/"} + name,
+                       {{"instantiations", insts_count}, {"uses", fn(par)}},
+                       timing);
+        }
+
+        fs::remove(src_path);
+    }
+
+    log_shutdown();
+    fs::remove(log_path);
+}
@@ -0,0 +1,20 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_level_compiled_out.cpp
+/// Contains template uses traversal compiled with trace and debug log statements removed.
+
+// removing log statements below info level from this translation unit
+#undef REFACTOR_LOG_MIN_LEVEL
+#define REFACTOR_LOG_MIN_LEVEL 2
+
+#include "log_level_kernel.hpp"
+
+
+/// Traverses template uses with trace and debug log statements compiled out
+std::size_t traverse_template_uses_compiled_out(const cm::template_parameter * par) {
+    return traverse_template_uses(par);
+}
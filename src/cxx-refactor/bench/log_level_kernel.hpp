@@ -0,0 +1,50 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_level_kernel.hpp
+/// Contains template uses traversal with logging used by log level benchmarks.
+/// Included into translation units compiled with different REFACTOR_LOG_MIN_LEVEL.
+
+#pragma once
+
+#include "log/log.hpp"
+#include <cm/src/cxx/clang/cmsrcclang.hpp>
+
+
+// logging functions
+#define LLB_TRACE REFACTOR_LOG_SCAT_TRACE(bench, log-level)
+#define LLB_DEBUG REFACTOR_LOG_SCAT_DEBUG(bench, log-level)
+
+
+namespace {
+
+/// Traverses uses of template and template parameter logging them the same way
+/// as template parameter remove action does. Returns number of visited uses
+std::size_t traverse_template_uses(const cm::template_parameter * par) {
+    std::size_t count = 0;
+
+    for (auto use : par->templ()->uses()) {
+        ++count;
+        if (auto subst = dynamic_cast<const cm::template_substitution*>(use)) {
+            LLB_DEBUG << "found template substitution: " << subst->desc();
+            LLB_TRACE << REFACTOR_LOG_LAZY(subst->dump_to_string());
+        } else if (auto node = dynamic_cast<const cm::src::ast_node*>(use)) {
+            LLB_DEBUG << "found template use AST node, skipping: " << node->class_name();
+        }
+    }
+
+    for (auto use : par->uses()) {
+        ++count;
+        if (auto node = dynamic_cast<const cm::src::ast_node*>(use)) {
+            LLB_TRACE << "found template parameter use: "
+                      << node->class_name() << ' ' << node->source_range();
+        }
+    }
+
+    return count;
+}
+
+}
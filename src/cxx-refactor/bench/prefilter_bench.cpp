@@ -0,0 +1,49 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file prefilter_bench.cpp
+/// Contains benchmarks of textual pre-filter of translation units.
+
+#include "bench.hpp"
+#include "../symbol_prefilter.hpp"
+#include <sstream>
+
+
+/// Returns source text of specified size without target symbol
+static std::string make_filler_source(std::size_t bytes) {
+    std::ostringstream ostr;
+    for (std::size_t i = 0; ostr.tellp() < static_cast<std::streamoff>(bytes); ++i) {
+        ostr << "int my_var_" << i << " = my_func(" << i << ");\n";
+    }
+
+    return ostr.str();
+}
+
+
+/// Measures search of missing symbol spelling with vectorized and standard search
+CXX_REFACTOR_BENCH(prefilter_search) {
+    for (std::size_t bytes : {std::size_t{1} << 16, std::size_t{1} << 24}) {
+        auto text = make_filler_source(bytes);
+        std::string_view needle = "my_class";
+
+        std::size_t found = 0;
+        auto simd_timing = bench_measure(ctx.repetitions(), [&]() {
+            found += contains_substring(text, needle);
+        });
+
+        ctx.report("prefilter_search/contains-substring", {{"bytes", text.size()}}, simd_timing);
+
+        auto std_timing = bench_measure(ctx.repetitions(), [&]() {
+            found += std::string_view{text}.find(needle) != std::string_view::npos;
+        });
+
+        ctx.report("prefilter_search/string-view-find", {{"bytes", text.size()}}, std_timing);
+
+        if (found != 0) {
+            throw std::runtime_error{"missing symbol spelling found in filler source"};
+        }
+    }
+}
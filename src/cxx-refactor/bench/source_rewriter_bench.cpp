@@ -0,0 +1,174 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file source_rewriter_bench.cpp
+/// Contains benchmarks of the source_rewriter and single_source_modifications classes.
+
+#include "bench.hpp"
+#include "../source_rewriter.hpp"
+#include <random>
+#include <sstream>
+
+
+/// Returns source with specified number of variable definitions
+static std::string make_vars_source(std::size_t lines_count) {
+    std::ostringstream ostr;
+    for (std::size_t i = 0; i < lines_count; ++i) {
+        ostr << "int var_" << i << " = " << i << ";\n";
+    }
+
+    return ostr.str();
+}
+
+
+/// Returns modification renaming variable defined at specified line index
+static compact_modification make_rename_mod(const line_index & idx, std::size_t line_idx) {
+    auto name_size = ("var_" + std::to_string(line_idx)).size();
+    cm::src::source_position start{line_idx + 1, 5};
+    cm::src::source_position end{line_idx + 1, 5 + name_size};
+    source_modification mod{{start, end}, "renamed_" + std::to_string(line_idx)};
+    return compact_modification{mod, idx};
+}
+
+
+/// Returns modifications renaming variables at every line with specified interval
+static std::vector<compact_modification> make_rename_mods(const line_index & idx,
+                                                          std::size_t lines_count,
+                                                          std::size_t interval) {
+    std::vector<compact_modification> res;
+    for (std::size_t i = 0; i < lines_count; i += interval) {
+        res.push_back(make_rename_mod(idx, i));
+    }
+
+    return res;
+}
+
+
+/// Measures rewriting of source with different sizes and densities of modifications
+CXX_REFACTOR_BENCH(source_rewriter_rewrite) {
+    for (std::size_t lines_count : {1000, 100000}) {
+        auto src = make_vars_source(lines_count);
+        auto idx = std::make_shared<const line_index>(src);
+
+        for (std::size_t interval : {1, 16}) {
+            single_source_modifications mods{idx};
+            for (auto && mod : make_rename_mods(*idx, lines_count, interval)) {
+                mods.add(mod);
+            }
+
+            auto timing = bench_measure(ctx.repetitions(), [&]() {
+                std::istringstream istr{src};
+                istr.unsetf(std::ios::skipws);
+                std::ostringstream ostr;
+                source_rewriter rw;
+                rw.rewrite(mods, istr, ostr);
+            });
+
+            ctx.report("source_rewriter_rewrite",
+                       {{"lines", lines_count},
+                        {"bytes", src.size()},
+                        {"modifications", mods.size()}},
+                       timing);
+        }
+    }
+}
+
+
+/// Measures adding modifications in sequential, reverse and random order
+CXX_REFACTOR_BENCH(single_source_modifications_add) {
+    for (std::size_t mods_count : {1000, 100000}) {
+        line_index idx{make_vars_source(mods_count)};
+        auto seq_mods = make_rename_mods(idx, mods_count, 1);
+
+        auto rev_mods = seq_mods;
+        std::reverse(rev_mods.begin(), rev_mods.end());
+
+        auto rand_mods = seq_mods;
+        std::shuffle(rand_mods.begin(), rand_mods.end(), std::mt19937{42});
+
+        std::pair<const char *, const std::vector<compact_modification> *> orders[] = {
+            {"sequential", &seq_mods},
+            {"reverse", &rev_mods},
+            {"random", &rand_mods}
+        };
+
+        for (auto && [name, order_mods] : orders) {
+            auto timing = bench_measure(ctx.repetitions(), [&]() {
+                single_source_modifications mods;
+                for (auto && mod : *order_mods) {
+                    mods.add(mod);
+                }
+            });
+
+            ctx.report(std::string{"single_source_modifications_add/"} + name,
+                       {{"modifications", mods_count}},
+                       timing);
+        }
+    }
+}
+
+
+/// Measures conversion of line/column modifications to byte offsets
+CXX_REFACTOR_BENCH(line_index_offset) {
+    for (std::size_t lines_count : {1000, 100000}) {
+        auto src = make_vars_source(lines_count);
+
+        auto build_timing = bench_measure(ctx.repetitions(), [&]() {
+            line_index idx{src};
+            if (idx.lines_count() == 0) {
+                throw std::runtime_error{"empty line index"};
+            }
+        });
+
+        ctx.report("line_index_offset/build",
+                   {{"lines", lines_count},
+                    {"bytes", src.size()}},
+                   build_timing);
+
+        line_index idx{src};
+        std::size_t total = 0;
+        auto convert_timing = bench_measure(ctx.repetitions(), [&]() {
+            for (std::size_t i = 0; i < lines_count; ++i) {
+                total += idx.offset({i + 1, 5});
+            }
+        });
+
+        if (total == 0) {
+            throw std::runtime_error{"empty offsets converted"};
+        }
+
+        ctx.report("line_index_offset/convert",
+                   {{"lines", lines_count}},
+                   convert_timing);
+    }
+}
+
+
+/// Measures iteration over modifications ordered by start position
+CXX_REFACTOR_BENCH(single_source_modifications_iterate) {
+    for (std::size_t mods_count : {1000, 100000}) {
+        line_index idx{make_vars_source(mods_count)};
+        single_source_modifications mods;
+        for (auto && mod : make_rename_mods(idx, mods_count, 1)) {
+            mods.add(mod);
+        }
+
+        std::size_t total = 0;
+        auto timing = bench_measure(ctx.repetitions(), [&]() {
+            for (auto && mod : mods.mods()) {
+                total += mod.insert_string().size();
+            }
+        });
+
+        if (total == 0) {
+            throw std::runtime_error{"empty modifications iterated"};
+        }
+
+        ctx.report("single_source_modifications_iterate",
+                   {{"modifications", mods_count}},
+                   timing);
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file template_parameter_remove_bench.cpp
+/// Contains scaling benchmark of the template_parameter_remove_action class.
+
+#include "bench.hpp"
+#include "../source_rewriter.hpp"
+#include "../template_parameter_remove_action.hpp"
+#include <cm/src/cxx/clang/cmsrcclang.hpp>
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+/// Rewrites source with specified modifications and returns result as string
+static std::string rewrite_to_string(const multi_source_modifications & mods) {
+    std::ostringstream ostr;
+    source_rewriter rw;
+    for (auto && [file, smods] : mods.mods()) {
+        rw.rewrite(smods, mods.path(file), ostr);
+    }
+
+    return ostr.str();
+}
+
+
+/// Measures collecting of template parameter remove modifications with 1 to 32 threads
+CXX_REFACTOR_BENCH(template_parameter_remove_scaling) {
+    for (std::size_t insts_count : {1000, 10000}) {
+        auto src_path = fs::temp_directory_path() / "cxx-refactor-bench-tpr.cpp";
+        auto pos = write_template_source(src_path, insts_count);
+
+        cm::src::source_code_model cm;
+        cm::src::clang::parse_source_file(cm, src_path, {});
+
+        po::variables_map opts;
+        opts.emplace("position", po::variable_value{pos, false});
+
+        template_parameter_remove_action action;
+        std::string reference;
+
+        for (std::size_t threads_count : {1, 2, 4, 8, 16, 32}) {
+            thread_pool pool{threads_count};
+
+            // checking that output is identical to output of sequential traversal
+            auto output = rewrite_to_string(action.collect_mods(cm, opts, pool));
+            if (threads_count == 1) {
+                reference = output;
+            } else if (output != reference) {
+                throw std::runtime_error{"parallel template parameter remove output differs "
+                                         "from sequential output"};
+            }
+
+            auto timing = bench_measure(ctx.repetitions(), [&]() {
+                action.collect_mods(cm, opts, pool);
+            });
+
+            ctx.report("template_parameter_remove_scaling",
+                       {{"instantiations", insts_count}, {"threads", threads_count}},
+                       timing);
+        }
+
+        fs::remove(src_path);
+    }
+}
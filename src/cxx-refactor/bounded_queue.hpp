@@ -0,0 +1,78 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file bounded_queue.hpp
+/// Contains definition of the bounded_queue class.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+
+/// Blocking queue with limited capacity for passing items between pipeline stages.
+/// Producers block while queue is full, so fast stage can't run ahead of slow one.
+/// Queue is closed by producers when there are no more items; consumers receive
+/// remaining items and then empty result. All member functions are thread safe.
+template <typename T>
+class bounded_queue {
+public:
+    /// Constructs queue with specified capacity
+    explicit bounded_queue(std::size_t capacity): capacity_{capacity != 0 ? capacity : 1} {}
+
+    /// Pushes item into queue, blocks while queue is full. Returns false if queue
+    /// is closed and item was not pushed
+    bool push(T && item) {
+        std::unique_lock lock{mtx_};
+        not_full_cv_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+
+        items_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_cv_.notify_one();
+        return true;
+    }
+
+    /// Pops item from queue, blocks while queue is empty and not closed. Returns
+    /// nullopt if queue is closed and empty
+    std::optional<T> pop() {
+        std::unique_lock lock{mtx_};
+        not_empty_cv_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+
+        std::optional<T> res{std::move(items_.front())};
+        items_.pop_front();
+        lock.unlock();
+        not_full_cv_.notify_one();
+        return res;
+    }
+
+    /// Closes queue. Items already in queue may still be popped
+    void close() {
+        {
+            std::lock_guard lock{mtx_};
+            closed_ = true;
+        }
+
+        not_full_cv_.notify_all();
+        not_empty_cv_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;                  ///< Maximum number of items in queue
+    std::mutex mtx_;                        ///< Queue mutex
+    std::condition_variable not_full_cv_;   ///< Condition for waiting producers
+    std::condition_variable not_empty_cv_;  ///< Condition for waiting consumers
+    std::deque<T> items_;                   ///< Queued items
+    bool closed_ = false;                   ///< Queue is closed
+};
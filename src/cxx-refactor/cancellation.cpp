@@ -0,0 +1,43 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file cancellation.cpp
+/// Contains implementation of the cancellation_token class.
+
+#include "pch.hpp"
+#include "cancellation.hpp"
+
+
+/// Cancellation token of current thread
+static thread_local const cancellation_token * current_token = nullptr;
+
+
+void cancellation_token::check() const {
+    if (!cancelled()) {
+        return;
+    }
+
+    if (deadline_exceeded()) {
+        throw cancelled_error{"deadline exceeded"};
+    }
+
+    throw cancelled_error{"operation cancelled"};
+}
+
+
+const cancellation_token * cancellation_token::current() {
+    return current_token;
+}
+
+
+cancellation_scope::cancellation_scope(const cancellation_token * token): prev_{current_token} {
+    current_token = token;
+}
+
+
+cancellation_scope::~cancellation_scope() {
+    current_token = prev_;
+}
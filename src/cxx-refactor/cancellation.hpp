@@ -0,0 +1,106 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file cancellation.hpp
+/// Contains definition of the cancellation_token class.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+
+/// Exception thrown by cancellation checks when operation is cancelled or its
+/// deadline is exceeded
+class cancelled_error: public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+
+/// Token for cooperative cancellation of long running operations. Token is cancelled
+/// explicitly (cancel may be called from signal handler) or when its deadline is
+/// exceeded. Loops over translation units and traversals of actions check token of
+/// current thread, which is set by cancellation_scope and propagated to tasks of
+/// thread pool.
+class cancellation_token {
+public:
+    /// Clock of deadlines
+    using clock = std::chrono::steady_clock;
+
+    /// Constructs token without deadline
+    explicit cancellation_token() = default;
+
+    /// Constructs token with specified deadline
+    explicit cancellation_token(clock::time_point deadline):
+        deadline_{deadline}, has_deadline_{true} {}
+
+    /// Cancels operation. Async signal safe
+    void cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+
+    /// Returns true if operation is cancelled or deadline is exceeded
+    bool cancelled() const noexcept {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+            return true;
+        }
+
+        if (has_deadline_ && clock::now() >= deadline_) {
+            cancelled_.store(true, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    /// Returns true if token has deadline and it's exceeded
+    bool deadline_exceeded() const noexcept {
+        return has_deadline_ && clock::now() >= deadline_;
+    }
+
+    /// Throws cancelled_error if operation is cancelled
+    void check() const;
+
+    /// Returns token of current thread or nullptr
+    static const cancellation_token * current();
+
+private:
+    mutable std::atomic<bool> cancelled_{false};    ///< Operation is cancelled
+    clock::time_point deadline_;                    ///< Deadline of operation
+    bool has_deadline_ = false;                     ///< Token has deadline
+};
+
+
+/// Sets cancellation token of current thread for lifetime of scope
+class cancellation_scope {
+public:
+    /// Sets token of current thread, token may be nullptr
+    explicit cancellation_scope(const cancellation_token * token);
+
+    /// Restores previous token of current thread
+    ~cancellation_scope();
+
+    cancellation_scope(const cancellation_scope &) = delete;
+    cancellation_scope & operator=(const cancellation_scope &) = delete;
+
+private:
+    const cancellation_token * prev_;       ///< Previous token of thread
+};
+
+
+/// Returns true if token of current thread is cancelled
+inline bool cancellation_requested() {
+    auto token = cancellation_token::current();
+    return token != nullptr && token->cancelled();
+}
+
+
+/// Throws cancelled_error if token of current thread is cancelled
+inline void check_cancelled() {
+    if (auto token = cancellation_token::current()) {
+        token->check();
+    }
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file child_process.cpp
+/// Contains implementation of the run_process function.
+
+#include "pch.hpp"
+#include "child_process.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+extern char ** environ;
+
+
+process_result run_process(const std::vector<std::string> & args, process_stream captured) {
+    auto argv_strs = args;
+    std::vector<char *> argv;
+    for (auto && arg : argv_strs) {
+        argv.push_back(arg.data());
+    }
+
+    argv.push_back(nullptr);
+
+    // pipe is not inherited by processes started concurrently by other threads,
+    // otherwise end of output would not be detected
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) != 0) {
+        std::ostringstream msg;
+        msg << "can't create pipe for output of '" << args.front() << "': "
+            << std::strerror(errno);
+        throw std::runtime_error{msg.str()};
+    }
+
+    auto captured_fd = captured == process_stream::out ? 1 : 2;
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 3 - captured_fd, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], captured_fd);
+
+    pid_t pid = 0;
+    auto err = ::posix_spawnp(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+
+    if (err != 0) {
+        ::close(fds[0]);
+        std::ostringstream msg;
+        msg << "can't run '" << args.front() << "': " << std::strerror(err);
+        throw std::runtime_error{msg.str()};
+    }
+
+    process_result res;
+    char buf[4096];
+    for (;;) {
+        auto count = ::read(fds[0], buf, sizeof(buf));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (count <= 0) {
+            break;
+        }
+
+        res.output.append(buf, static_cast<std::size_t>(count));
+    }
+
+    ::close(fds[0]);
+
+    while (::waitpid(pid, &res.status, 0) < 0 && errno == EINTR) {}
+    return res;
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file child_process.hpp
+/// Contains declaration of the run_process function.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+/// Output stream of child process
+enum class process_stream {
+    out,                                    ///< Standard output stream
+    err                                     ///< Standard error stream
+};
+
+
+/// Result of finished child process
+struct process_result {
+    std::string output;                     ///< Captured output stream
+    int status = 0;                         ///< Wait status of process
+};
+
+
+/// Runs program with specified arguments and waits for its completion. The first
+/// argument is program name, which is searched in PATH. Specified output stream of
+/// process is captured, the other one is discarded. Throws exception if process
+/// can't be started. May be called concurrently from multiple threads
+process_result run_process(const std::vector<std::string> & args, process_stream captured);
@@ -0,0 +1,51 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file compact_modification.hpp
+/// Contains definition of the compact_modification class.
+
+#pragma once
+
+#include "line_index.hpp"
+#include "source_modification.hpp"
+
+
+/// Modification in source code with range stored as pair of byte offsets. Line and
+/// column of range are computed with line index of source file only for display
+class compact_modification {
+public:
+    /// Constructs modification
+    explicit compact_modification(source_offset start, source_offset end, std::string insert_s):
+        start_{start}, end_{end}, insert_str_{std::move(insert_s)} {}
+
+    /// Constructs modification from line/column modification using line index of source file
+    explicit compact_modification(const source_modification & mod, const line_index & idx):
+        start_{idx.offset(mod.range().start())},
+        end_{idx.offset(mod.range().end())},
+        insert_str_{mod.insert_string()} {}
+
+    /// Returns offset of modification range start
+    source_offset start() const { return start_; }
+
+    /// Returns offset of modification range end
+    source_offset end() const { return end_; }
+
+    /// Returns insert string for modification
+    const auto & insert_string() const { return insert_str_; }
+
+    /// Returns line/column modification range computed with line index of source file
+    cm::src::source_range range(const line_index & idx) const {
+        return cm::src::source_range{idx.position(start_), idx.position(end_)};
+    }
+
+    /// Returns true if modifications have the same range and insert string
+    bool operator==(const compact_modification & other) const = default;
+
+private:
+    source_offset start_;                   ///< Offset of modification range start
+    source_offset end_;                     ///< Offset of modification range end
+    std::string insert_str_;                ///< Insert string for modification
+};
@@ -0,0 +1,111 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file concurrent_source_modifications.cpp
+/// Contains implementation of the concurrent_source_modifications class.
+
+#include "pch.hpp"
+#include "concurrent_source_modifications.hpp"
+#include <algorithm>
+#include <thread>
+
+
+concurrent_source_modifications::concurrent_source_modifications(std::size_t shards_count,
+                                                                 source_path_table & paths):
+paths_{paths},
+shards_(shards_count != 0 ? shards_count : std::max(1u, std::thread::hardware_concurrency())) {}
+
+
+void concurrent_source_modifications::add(file_id file, const compact_modification & mod) {
+    auto & sh = shard_for(file);
+    std::lock_guard lock{sh.mtx};
+    sh.mods.push_back({file, mod});
+}
+
+
+void concurrent_source_modifications::add_all(const std::vector<file_modification> & mods) {
+    if (mods.empty()) {
+        return;
+    }
+
+    // grouping modifications by shards to take each shard lock once
+    std::vector<std::vector<const file_modification*>> groups(shards_.size());
+    for (auto && fmod : mods) {
+        groups[fmod.file % shards_.size()].push_back(&fmod);
+    }
+
+    for (std::size_t i = 0; i < shards_.size(); ++i) {
+        if (groups[i].empty()) {
+            continue;
+        }
+
+        std::lock_guard lock{shards_[i].mtx};
+        for (auto fmod : groups[i]) {
+            shards_[i].mods.push_back(*fmod);
+        }
+    }
+}
+
+
+/// Sorts modifications of a shard by file and position. Order of modifications
+/// is total, so result doesn't depend on order in which modifications were added
+static void sort_shard_mods(std::vector<concurrent_source_modifications::file_modification> & mods) {
+    auto less = [](const auto & x, const auto & y) {
+        if (x.file != y.file) {
+            return x.file < y.file;
+        }
+
+        if (x.mod.start() != y.mod.start()) {
+            return x.mod.start() < y.mod.start();
+        }
+
+        if (x.mod.end() != y.mod.end()) {
+            return x.mod.end() < y.mod.end();
+        }
+
+        return x.mod.insert_string() < y.mod.insert_string();
+    };
+
+    std::sort(mods.begin(), mods.end(), less);
+}
+
+
+multi_source_modifications concurrent_source_modifications::merge(thread_pool & pool) {
+    // sorting and grouping modifications of each shard in separate task
+    using file_mods = std::pair<file_id, single_source_modifications>;
+    std::vector<std::vector<file_mods>> shard_results(shards_.size());
+
+    pool.parallel_for(shards_.size(), [&](std::size_t idx) {
+        auto & mods = shards_[idx].mods;
+        sort_shard_mods(mods);
+
+        auto & res = shard_results[idx];
+        for (std::size_t i = 0; i < mods.size(); ++i) {
+            auto & fmod = mods[i];
+            if (res.empty() || res.back().first != fmod.file) {
+                auto line_idx = line_index_table::global().find(paths_.path(fmod.file));
+                res.emplace_back(fmod.file, single_source_modifications{std::move(line_idx)});
+            } else if (mods[i - 1].mod == fmod.mod) {
+                // skipping modification identical to previous one
+                continue;
+            }
+
+            res.back().second.append(compact_modification{fmod.mod});
+        }
+
+        mods.clear();
+    });
+
+    // moving sorted modifications into result
+    multi_source_modifications res;
+    for (auto && sh_res : shard_results) {
+        for (auto && [file, smods] : sh_res) {
+            res.add(paths_.path(file), std::move(smods));
+        }
+    }
+
+    return res;
+}
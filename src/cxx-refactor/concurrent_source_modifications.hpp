@@ -0,0 +1,146 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file concurrent_source_modifications.hpp
+/// Contains definition of the concurrent_source_modifications class.
+
+#pragma once
+
+#include "line_index_table.hpp"
+#include "multi_source_modifications.hpp"
+#include "source_path_table.hpp"
+#include "thread_pool.hpp"
+#include <mutex>
+#include <vector>
+
+
+/// Collector of source modifications which may be fed from multiple threads.
+/// Modifications are distributed over shards by source file identifier. Producer
+/// threads may add modifications one by one or accumulate them in a local buffer
+/// and flush it into shards in one step. Collected modifications are sorted and
+/// merged into multi_source_modifications object by the merge function on thread
+/// pool. Line/column modifications are converted to byte offsets when they are added,
+/// so sorting and intersection checks compare integer offsets only.
+class concurrent_source_modifications {
+public:
+    /// Modification for a source file identified by interned file identifier
+    struct file_modification {
+        file_id file;                       ///< Source file identifier
+        compact_modification mod;           ///< Modification
+    };
+
+    /// Per thread buffer of modifications. Not thread safe, must be used by single thread.
+    /// Buffered modifications must be flushed explicitly, modifications left in buffer
+    /// on destruction are discarded, so buffer destroyed by exception doesn't throw
+    class buffer {
+    public:
+        /// Constructs buffer for specified collector
+        explicit buffer(concurrent_source_modifications & coll): coll_{coll} {}
+
+        buffer(const buffer &) = delete;
+        buffer & operator=(const buffer &) = delete;
+
+        /// Adds modification to buffer
+        void add(file_id file, const compact_modification & mod) {
+            mods_.push_back({file, mod});
+            if (mods_.size() >= flush_threshold) {
+                flush();
+            }
+        }
+
+        /// Adds line/column modification to buffer
+        void add(file_id file, const source_modification & mod) {
+            if (index_ == nullptr || index_file_ != file) {
+                index_ = coll_.index(file);
+                index_file_ = file;
+            }
+
+            add(file, compact_modification{mod, *index_});
+        }
+
+        /// Adds modification for source file with specified path to buffer
+        template <typename Mod>
+        void add(const std::filesystem::path & src_path, const Mod & mod) {
+            add(coll_.paths().intern(src_path), mod);
+        }
+
+        /// Adds all modifications from multi source modifications object to buffer
+        void add(const multi_source_modifications & mods) {
+            for (auto && [file, smods] : mods.mods()) {
+                auto id = coll_.paths().intern(multi_source_modifications::path(file));
+                for (auto && mod : smods.mods()) {
+                    add(id, mod);
+                }
+            }
+        }
+
+        /// Moves all buffered modifications into collector
+        void flush() {
+            coll_.add_all(mods_);
+            mods_.clear();
+        }
+
+    private:
+        /// Number of buffered modifications which triggers flush
+        static constexpr std::size_t flush_threshold = 256;
+
+        concurrent_source_modifications & coll_;        ///< Reference to collector
+        std::vector<file_modification> mods_;           ///< Buffered modifications
+        std::shared_ptr<const line_index> index_;       ///< Line index of last used file
+        file_id index_file_ = 0;                        ///< Identifier of last used file
+    };
+
+
+    /// Constructs collector with specified number of shards. Zero number of shards
+    /// means number of hardware threads
+    explicit concurrent_source_modifications(std::size_t shards_count = 0,
+                                             source_path_table & paths = source_path_table::global());
+
+    /// Returns reference to path table used for interning source paths
+    source_path_table & paths() const { return paths_; }
+
+    /// Returns line index of source file with specified identifier. Thread safe
+    std::shared_ptr<const line_index> index(file_id file) const {
+        return line_index_table::global().get(paths_.path(file));
+    }
+
+    /// Adds modification for source file with specified identifier. Thread safe
+    void add(file_id file, const compact_modification & mod);
+
+    /// Adds line/column modification for source file with specified identifier. Thread safe
+    void add(file_id file, const source_modification & mod) {
+        add(file, compact_modification{mod, *index(file)});
+    }
+
+    /// Adds modification for source file with specified path. Thread safe
+    template <typename Mod>
+    void add(const std::filesystem::path & src_path, const Mod & mod) {
+        add(paths_.intern(src_path), mod);
+    }
+
+    /// Adds all modifications from vector. Thread safe
+    void add_all(const std::vector<file_modification> & mods);
+
+    /// Sorts collected modifications of shards in parallel on thread pool and merges them
+    /// into multi source modifications object. Identical modifications are merged into one,
+    /// other modifications starting at the same offset or intersecting are reported as
+    /// errors. Collector is left empty after merge. Must not be called concurrently with
+    /// adding modifications.
+    multi_source_modifications merge(thread_pool & pool);
+
+private:
+    /// Shard of modifications
+    struct shard {
+        std::mutex mtx;                                 ///< Shard mutex
+        std::vector<file_modification> mods;            ///< Modifications in shard
+    };
+
+    /// Returns reference to shard for specified file identifier
+    shard & shard_for(file_id file) { return shards_[file % shards_.size()]; }
+
+    source_path_table & paths_;                         ///< Table of source paths
+    std::vector<shard> shards_;                         ///< Modifications shards
+};
@@ -0,0 +1,467 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file edit_script.cpp
+/// Contains implementation of functions for reading edit scripts.
+
+#include "pch.hpp"
+#include "edit_script.hpp"
+#include "mapped_file.hpp"
+#include "result_serialization.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace fs = std::filesystem;
+
+
+/// Edits of single source collected from edit script
+struct source_edits {
+    file_id file;                                   ///< Source file identifier
+    std::vector<compact_modification> edits;        ///< Edits in order of script
+};
+
+
+/// Parser of edit script in JSON format. Edits are collected into lists of sources
+/// in order of first occurrence of sources in script
+class json_script_parser {
+public:
+    /// Constructs parser of specified script text
+    explicit json_script_parser(std::string_view text): text_{text} {}
+
+    /// Parses script and returns edits grouped by sources
+    std::vector<source_edits> parse() {
+        skip_ws();
+        if (peek() == '[') {
+            parse_edits();
+        }
+        else {
+            expect('{');
+            bool found = false;
+            if (!consume('}')) {
+                do {
+                    auto key = parse_string();
+                    expect(':');
+                    if (key == "edits") {
+                        parse_edits();
+                        found = true;
+                    }
+                    else {
+                        skip_value();
+                    }
+                } while (consume(','));
+
+                expect('}');
+            }
+
+            if (!found) {
+                error("missing \"edits\" member");
+            }
+        }
+
+        skip_ws();
+        if (pos_ != text_.size()) {
+            error("unexpected data after end of script");
+        }
+
+        return std::move(sources_);
+    }
+
+private:
+    /// Parses array of edits
+    void parse_edits() {
+        expect('[');
+        if (consume(']')) {
+            return;
+        }
+
+        do {
+            parse_edit();
+        } while (consume(','));
+
+        expect(']');
+    }
+
+    /// Parses single edit object
+    void parse_edit() {
+        skip_ws();
+        auto edit_pos = pos_;
+        expect('{');
+
+        std::optional<std::size_t> src;
+        std::optional<std::uint64_t> offset;
+        std::uint64_t length = 0;
+        std::string replacement;
+        if (!consume('}')) {
+            do {
+                auto key = parse_string();
+                expect(':');
+                if (key == "path") {
+                    src = source_index(parse_string());
+                }
+                else if (key == "offset") {
+                    offset = parse_uint();
+                }
+                else if (key == "length") {
+                    length = parse_uint();
+                }
+                else if (key == "replacement") {
+                    replacement = parse_string();
+                }
+                else {
+                    skip_value();
+                }
+            } while (consume(','));
+
+            expect('}');
+        }
+
+        if (!src || !offset) {
+            error_at(edit_pos, "edit must have \"path\" and \"offset\" members");
+        }
+
+        auto end = *offset + length;
+        if (end > std::numeric_limits<source_offset>::max()) {
+            error_at(edit_pos, "edit range exceeds maximum source size");
+        }
+
+        sources_[*src].edits.emplace_back(static_cast<source_offset>(*offset),
+                                          static_cast<source_offset>(end),
+                                          std::move(replacement));
+    }
+
+    /// Returns index of source with specified path in list of sources. Paths are
+    /// interned once for each spelling, edits are usually grouped by paths in scripts,
+    /// so the last path is checked first
+    std::size_t source_index(std::string && path) {
+        if (!sources_.empty() && path == last_path_) {
+            return last_idx_;
+        }
+
+        auto it = spelling_idxs_.find(path);
+        if (it == spelling_idxs_.end()) {
+            auto file = source_path_table::global().intern(path);
+            auto [file_it, inserted] = file_idxs_.emplace(file, sources_.size());
+            if (inserted) {
+                sources_.emplace_back(file);
+            }
+
+            it = spelling_idxs_.emplace(path, file_it->second).first;
+        }
+
+        last_path_ = std::move(path);
+        last_idx_ = it->second;
+        return last_idx_;
+    }
+
+    /// Parses string and returns its unescaped value
+    std::string parse_string() {
+        expect('"');
+
+        // fast path for strings without escape sequences
+        auto start = pos_;
+        while (pos_ < text_.size() && text_[pos_] != '"' && text_[pos_] != '\\') {
+            ++pos_;
+        }
+
+        std::string res{text_.substr(start, pos_ - start)};
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            auto ch = text_[pos_++];
+            if (ch != '\\') {
+                res.push_back(ch);
+                continue;
+            }
+
+            if (pos_ == text_.size()) {
+                break;
+            }
+
+            switch (auto esc = text_[pos_++]) {
+            case '"': case '\\': case '/': res.push_back(esc); break;
+            case 'b': res.push_back('\b'); break;
+            case 'f': res.push_back('\f'); break;
+            case 'n': res.push_back('\n'); break;
+            case 'r': res.push_back('\r'); break;
+            case 't': res.push_back('\t'); break;
+            case 'u': append_utf8(res, parse_code_point()); break;
+            default: error_at(pos_ - 1, "invalid escape sequence");
+            }
+        }
+
+        if (pos_ == text_.size()) {
+            error("unterminated string");
+        }
+
+        ++pos_;
+        return res;
+    }
+
+    /// Parses code point of \u escape sequence, surrogate pairs are combined
+    std::uint32_t parse_code_point() {
+        auto cp = parse_hex4();
+        if (cp >= 0xD800 && cp < 0xDC00) {
+            if (text_.substr(pos_, 2) != "\\u") {
+                error("unpaired surrogate in escape sequence");
+            }
+
+            pos_ += 2;
+            auto low = parse_hex4();
+            if (low < 0xDC00 || low >= 0xE000) {
+                error("invalid surrogate pair in escape sequence");
+            }
+
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        return cp;
+    }
+
+    /// Parses 4 hexadecimal digits
+    std::uint32_t parse_hex4() {
+        std::uint32_t res = 0;
+        for (int i = 0; i < 4; ++i, ++pos_) {
+            auto ch = pos_ < text_.size() ? text_[pos_] : '\0';
+            res <<= 4;
+            if (ch >= '0' && ch <= '9') {
+                res |= static_cast<std::uint32_t>(ch - '0');
+            }
+            else if (ch >= 'a' && ch <= 'f') {
+                res |= static_cast<std::uint32_t>(ch - 'a' + 10);
+            }
+            else if (ch >= 'A' && ch <= 'F') {
+                res |= static_cast<std::uint32_t>(ch - 'A' + 10);
+            }
+            else {
+                error("invalid hexadecimal digit in escape sequence");
+            }
+        }
+
+        return res;
+    }
+
+    /// Appends code point encoded in UTF-8 to string
+    static void append_utf8(std::string & str, std::uint32_t cp) {
+        if (cp < 0x80) {
+            str.push_back(static_cast<char>(cp));
+        }
+        else if (cp < 0x800) {
+            str.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+            str.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else if (cp < 0x10000) {
+            str.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+            str.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        else {
+            str.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+            str.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+            str.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+    }
+
+    /// Parses non-negative integer
+    std::uint64_t parse_uint() {
+        skip_ws();
+        auto start = pos_;
+        std::uint64_t res = 0;
+        while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9') {
+            if (res > std::numeric_limits<std::uint32_t>::max()) {
+                error_at(start, "integer is too large");
+            }
+
+            res = res * 10 + static_cast<std::uint64_t>(text_[pos_++] - '0');
+        }
+
+        if (pos_ == start) {
+            error("expected non-negative integer");
+        }
+
+        return res;
+    }
+
+    /// Skips value of unknown member
+    void skip_value() {
+        skip_ws();
+        auto ch = peek();
+        if (ch == '"') {
+            parse_string();
+        }
+        else if (ch == '{' || ch == '[') {
+            auto close = ch == '{' ? '}' : ']';
+            ++pos_;
+            if (consume(close)) {
+                return;
+            }
+
+            do {
+                if (ch == '{') {
+                    parse_string();
+                    expect(':');
+                }
+
+                skip_value();
+            } while (consume(','));
+
+            expect(close);
+        }
+        else {
+            // numbers and literals
+            auto start = pos_;
+            while (pos_ < text_.size() && std::strchr("+-.0123456789Eaeflnrstu", text_[pos_]) != nullptr) {
+                ++pos_;
+            }
+
+            if (pos_ == start) {
+                error("expected value");
+            }
+        }
+    }
+
+    /// Skips whitespace
+    void skip_ws() {
+        while (pos_ < text_.size() &&
+               (text_[pos_] == ' ' || text_[pos_] == '\n' || text_[pos_] == '\r' || text_[pos_] == '\t')) {
+            ++pos_;
+        }
+    }
+
+    /// Returns next character after whitespace, zero at end of text
+    char peek() {
+        skip_ws();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    /// Skips character if it's the next character after whitespace. Returns true if
+    /// character is skipped
+    bool consume(char ch) {
+        if (peek() != ch) {
+            return false;
+        }
+
+        ++pos_;
+        return true;
+    }
+
+    /// Skips expected character, throws exception if next character differs
+    void expect(char ch) {
+        if (!consume(ch)) {
+            std::ostringstream msg;
+            msg << "expected '" << ch << "'";
+            error(msg.str());
+        }
+    }
+
+    /// Throws exception about error at current position
+    [[noreturn]] void error(std::string_view what) const {
+        error_at(pos_, what);
+    }
+
+    /// Throws exception about error at specified position
+    [[noreturn]] static void error_at(std::size_t pos, std::string_view what) {
+        std::ostringstream msg;
+        msg << "invalid edit script: " << what << " at offset " << pos;
+        throw std::runtime_error{msg.str()};
+    }
+
+    std::string_view text_;                                     ///< Script text
+    std::size_t pos_ = 0;                                       ///< Current position
+    std::vector<source_edits> sources_;                         ///< Edits of sources
+    std::unordered_map<std::string, std::size_t> spelling_idxs_; ///< Source indices by path spellings
+    std::unordered_map<file_id, std::size_t> file_idxs_;        ///< Source indices by file identifiers
+    std::string last_path_;                                     ///< Path of last edit
+    std::size_t last_idx_ = 0;                                  ///< Source index of last edit
+};
+
+
+/// Sorts edits of each source by offsets in parallel and converts them into source
+/// modifications. Throws exception if edits of the same source overlap
+static multi_source_modifications build_mods(std::vector<source_edits> && sources,
+                                             thread_pool & pool) {
+    std::vector<single_source_modifications> smods(sources.size());
+    pool.parallel_for(sources.size(), [&](std::size_t idx) {
+        auto & path = multi_source_modifications::path(sources[idx].file);
+        auto & edits = sources[idx].edits;
+
+        // stable sort keeps order of script for reporting of edits with the same offset
+        std::ranges::stable_sort(edits, {}, &compact_modification::start);
+
+        single_source_modifications res{line_index_table::global().find(path)};
+        for (std::size_t i = 0; i < edits.size(); ++i) {
+            if (i != 0 && (edits[i].start() < edits[i - 1].end() ||
+                           edits[i].start() == edits[i - 1].start())) {
+                std::ostringstream msg;
+                msg << "overlapping edits of source " << path << ": ["
+                    << edits[i - 1].start() << ", " << edits[i - 1].end() << ") and ["
+                    << edits[i].start() << ", " << edits[i].end() << ")";
+                throw std::runtime_error{msg.str()};
+            }
+
+            res.append(std::move(edits[i]));
+        }
+
+        smods[idx] = std::move(res);
+    });
+
+    multi_source_modifications res;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        res.add(sources[i].file, std::move(smods[i]));
+    }
+
+    return res;
+}
+
+
+/// Collects edits of binary script in format of serialized action result. Edits of
+/// sources listed several times under different spellings are collected together
+static std::vector<source_edits> binary_script_edits(std::string_view data) {
+    std::vector<source_edits> sources;
+    std::unordered_map<file_id, std::size_t> file_idxs;
+    for (auto && src : read_serialized_result(data).sources) {
+        auto file = source_path_table::global().intern(src.path);
+        auto [it, inserted] = file_idxs.try_emplace(file, sources.size());
+        if (inserted) {
+            sources.push_back(source_edits{file, std::move(src.mods)});
+        }
+        else {
+            auto & edits = sources[it->second].edits;
+            std::ranges::move(src.mods, std::back_inserter(edits));
+        }
+    }
+
+    return sources;
+}
+
+
+multi_source_modifications parse_edit_script(std::string_view data, thread_pool & pool) {
+    // binary scripts start with magic number of serialized action result,
+    // their edits are checked for overlapping in the same way as edits of JSON scripts
+    if (data.size() >= 4 && std::memcmp(data.data(), "CXR1", 4) == 0) {
+        return build_mods(binary_script_edits(data), pool);
+    }
+
+    return build_mods(json_script_parser{data}.parse(), pool);
+}
+
+
+multi_source_modifications read_edit_script(const fs::path & p, thread_pool & pool) {
+    if (fs::file_size(p) == 0) {
+        return multi_source_modifications{};
+    }
+
+    mapped_file file{p};
+    return parse_edit_script(file.text(), pool);
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file edit_script.hpp
+/// Contains declarations of functions for reading edit scripts.
+
+#pragma once
+
+#include "multi_source_modifications.hpp"
+#include "thread_pool.hpp"
+#include <filesystem>
+#include <string_view>
+
+
+/// Parses edit script produced by external tool into source modifications. Two formats
+/// are supported, format is detected by contents of script:
+///   - binary format documented at the write_action_result function, messages are
+///     ignored;
+///   - JSON format: array of edits or object with array of edits in the "edits" member.
+///     Each edit is object with members "path" (source path), "offset" (byte offset of
+///     replaced range), "length" (byte length of replaced range, default 0) and
+///     "replacement" (inserted text, default empty). Unknown members are ignored.
+/// Edits of each source are sorted by offsets in parallel using specified thread pool.
+/// Throws exception if script is malformed or edits of the same source overlap or start
+/// at the same offset
+multi_source_modifications parse_edit_script(std::string_view data,
+                                             thread_pool & pool = thread_pool::global());
+
+/// Reads and parses edit script from file located at specified path
+multi_source_modifications read_edit_script(const std::filesystem::path & p,
+                                            thread_pool & pool = thread_pool::global());
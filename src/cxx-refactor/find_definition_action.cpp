@@ -8,6 +8,8 @@
 /// Contains implementation of the find_definition_action class.
 
 #include "find_definition_action.hpp"
+#include "refactor_stats.hpp"
+#include "symbol_prefilter.hpp"
 #include <boost/program_options.hpp>
 
 
@@ -22,8 +24,24 @@ boost::program_options::options_description find_definition_action::opts() const
 }
 
 
-void find_definition_action::perform(const cm::src::source_code_model & cm,
-                                     const boost::program_options::variables_map & opts) const {
+std::optional<std::filesystem::path>
+find_definition_action::target_source(const boost::program_options::variables_map & opts) const {
+    auto pos_str = opts["position"].as<std::string>();
+    return cm::src::source_file_position_desc::from_string(pos_str).path();
+}
+
+
+std::optional<std::string>
+find_definition_action::target_spelling(const boost::program_options::variables_map & opts) const {
+    auto pos_str = opts["position"].as<std::string>();
+    auto pos_desc = cm::src::source_file_position_desc::from_string(pos_str);
+    return identifier_at(pos_desc.path(), pos_desc.pos());
+}
+
+
+action_result
+find_definition_action::extract(const cm::src::source_code_model & cm,
+                                const boost::program_options::variables_map & opts) const {
     // parsing source position
     auto pos_str = opts["position"].as<std::string>();
     auto pos_desc = cm::src::source_file_position_desc::from_string(pos_str);
@@ -33,13 +51,18 @@ void find_definition_action::perform(const cm::src::source_code_model & cm,
     if (src == nullptr) {
         std::ostringstream msg;
         msg << "can't find source file: '" << pos_desc.path() << "' in code model";
-        throw std::runtime_error{msg.str()};
+        throw source_not_found_error{msg.str()};
     }
 
     cm::src::source_file_position pos{src->cm_src(), pos_desc.pos()};
 
     // looking for AST node located at specified position
-    auto node = cm.find_node_at_pos(pos);
+    const cm::src::ast_node * node = nullptr;
+    {
+        stats_phase phase{"find-node"};
+        node = cm.find_node_at_pos(pos);
+    }
+
     if (!node) {
         std::ostringstream msg;
         msg << "can't find AST node located at source position " << pos;
@@ -87,5 +110,10 @@ void find_definition_action::perform(const cm::src::source_code_model & cm,
 
     auto named_ent = dynamic_cast<const cm::named_entity*>(ent);
     std::string symbol_name = named_ent ? named_ent->name() : "<unnamed>";
-    std::cout << "Symbol " << symbol_name << " is defined at: " << loc << std::endl;
+    std::ostringstream msg;
+    msg << "Symbol " << symbol_name << " is defined at: " << loc;
+
+    action_result res;
+    res.add_message(msg.str());
+    return res;
 }
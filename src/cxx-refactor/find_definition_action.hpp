@@ -25,7 +25,15 @@ public:
     /// Constructs and returns options description for this action
     boost::program_options::options_description opts() const override;
 
-    /// Performs action
-    void perform(const cm::src::source_code_model & cm,
-                 const boost::program_options::variables_map & opts) const override;
+    /// Returns source file of symbol position
+    std::optional<std::filesystem::path>
+    target_source(const boost::program_options::variables_map & opts) const override;
+
+    /// Returns spelling of identifier at symbol position
+    std::optional<std::string>
+    target_spelling(const boost::program_options::variables_map & opts) const override;
+
+    /// Extracts location of definition of symbol at specified position
+    action_result extract(const cm::src::source_code_model & cm,
+                          const boost::program_options::variables_map & opts) const override;
 };
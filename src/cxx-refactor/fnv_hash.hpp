@@ -0,0 +1,26 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file fnv_hash.hpp
+/// Contains definition of the fnv1a_hash function.
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+
+/// Returns 64-bit FNV-1a hash of data. Hash is stable between runs and hosts,
+/// so it may be stored in files
+inline std::uint64_t fnv1a_hash(std::string_view data) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (auto c : data) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
@@ -0,0 +1,112 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file in_place_writer.cpp
+/// Contains implementation of functions for applying modifications to source files in place.
+
+#include "pch.hpp"
+#include "in_place_writer.hpp"
+#include "mapped_file.hpp"
+#include "refactor_stats.hpp"
+#include "source_rewriter.hpp"
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace fs = std::filesystem;
+
+
+/// Returns true if each modification replaces text with the same text, so
+/// modifications can't change source
+static bool is_noop(const single_source_modifications & smods, std::string_view text) {
+    for (auto && mod : smods.mods()) {
+        if (mod.end() > text.size() ||
+            text.substr(mod.start(), mod.end() - mod.start()) != mod.insert_string()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/// Replaces contents of file with specified text. Text is written to temporary
+/// file, which is renamed over original file with permissions of original file
+static void replace_file(const fs::path & path, std::string_view text) {
+    auto tmp_path = path;
+    tmp_path += ".cxx-refactor.tmp";
+
+    {
+        std::ofstream ostr{tmp_path, std::ios::binary};
+        if (!ostr.is_open()) {
+            std::ostringstream msg;
+            msg << "can't open file " << tmp_path << " for writing";
+            throw std::runtime_error{msg.str()};
+        }
+
+        ostr.write(text.data(), static_cast<std::streamsize>(text.size()));
+        if (!ostr.flush()) {
+            std::ostringstream msg;
+            msg << "can't write file " << tmp_path;
+            throw std::runtime_error{msg.str()};
+        }
+    }
+
+    std::error_code ec;
+    fs::permissions(tmp_path, fs::status(path).permissions(), ec);
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        fs::remove(tmp_path);
+        std::ostringstream msg;
+        msg << "can't replace file " << path << ": " << ec.message();
+        throw std::runtime_error{msg.str()};
+    }
+}
+
+
+apply_summary apply_in_place(const multi_source_modifications & mods, thread_pool & pool) {
+    std::vector<file_id> files;
+    for (auto && [file, smods] : mods.mods()) {
+        files.push_back(file);
+    }
+
+    std::atomic<std::size_t> written{0};
+    std::atomic<std::size_t> unchanged{0};
+    pool.parallel_for(files.size(), [&](std::size_t idx) {
+        auto & path = multi_source_modifications::path(files[idx]);
+        auto & smods = mods.mods().at(files[idx]);
+
+        // original file stays mapped after it's replaced, renaming creates new file
+        mapped_file orig{path};
+        auto orig_text = orig.text();
+        if (is_noop(smods, orig_text)) {
+            ++unchanged;
+            return;
+        }
+
+        std::ostringstream ostr;
+        source_rewriter rw;
+        rw.rewrite(smods, orig_text, ostr);
+
+        auto text = ostr.view();
+        if (text == orig_text) {
+            ++unchanged;
+            return;
+        }
+
+        stats_phase phase{"write"};
+        replace_file(path, text);
+        ++written;
+    });
+
+    auto & stats = refactor_stats::global();
+    stats.add(stats_counter::files_written, written);
+    stats.add(stats_counter::writes_avoided, unchanged);
+
+    return apply_summary{written, unchanged};
+}
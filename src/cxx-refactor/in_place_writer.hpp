@@ -0,0 +1,30 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file in_place_writer.hpp
+/// Contains declaration of functions for applying modifications to source files in place.
+
+#pragma once
+
+#include "multi_source_modifications.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+
+
+/// Numbers of files processed when modifications are applied in place
+struct apply_summary {
+    std::size_t written = 0;                ///< Number of rewritten files
+    std::size_t unchanged = 0;              ///< Number of files left untouched
+};
+
+
+/// Applies modifications to source files in place. Sources are rewritten in memory
+/// and compared with original contents, files which content would not change are not
+/// written, so their modification times are preserved and build systems don't rebuild
+/// files depending on them. Changed files are written to temporary file in the same
+/// directory, which then replaces original file. Files are processed in parallel.
+apply_summary apply_in_place(const multi_source_modifications & mods,
+                             thread_pool & pool = thread_pool::global());
@@ -0,0 +1,460 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file include_graph.cpp
+/// Contains implementation of the include_graph class.
+
+#include "pch.hpp"
+#include "include_graph.hpp"
+#include "child_process.hpp"
+#include "refactor_stats.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <sys/wait.h>
+#include <unordered_set>
+
+
+// logging functions
+#define IG_WARNING REFACTOR_LOG_SCAT_WARNING(refactor, include-graph)
+
+
+namespace fs = std::filesystem;
+
+
+/// Header line of saved include graph file
+static constexpr std::string_view graph_file_header = "cxx-refactor-include-graph 2";
+
+/// Header line of include graph file saved by previous version, which is ignored
+static constexpr std::string_view old_graph_file_header = "cxx-refactor-include-graph 1";
+
+
+/// Returns canonical forms of directory paths
+static std::vector<fs::path> canonical_dirs(std::vector<fs::path> dirs) {
+    for (auto && dir : dirs) {
+        std::error_code ec;
+        auto canon = fs::weakly_canonical(dir, ec);
+        dir = ec ? fs::absolute(dir).lexically_normal() : canon;
+    }
+
+    return dirs;
+}
+
+
+include_graph::include_graph(std::vector<fs::path> include_dirs, std::vector<fs::path> system_dirs):
+include_dirs_{canonical_dirs(std::move(include_dirs))},
+system_dirs_{canonical_dirs(std::move(system_dirs))} {}
+
+
+std::vector<include_graph::include_directive> include_graph::scan_includes(std::string_view text) {
+    std::vector<include_directive> res;
+
+    auto skip_spaces = [&](std::size_t i) {
+        while (i < text.size() && (text[i] == ' ' || text[i] == '\t')) {
+            ++i;
+        }
+
+        return i;
+    };
+
+    auto is_ident_char = [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    };
+
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        auto line_end = text.find('\n', pos);
+        if (line_end == std::string_view::npos) {
+            line_end = text.size();
+        }
+
+        // matching '#', directive keyword and included path separated by optional spaces.
+        // Path which is not enclosed in quotes or angle brackets is computed by macro
+        auto i = skip_spaces(pos);
+        if (i < line_end && text[i] == '#') {
+            i = skip_spaces(i + 1);
+            auto kw_end = i;
+            while (kw_end < line_end && is_ident_char(text[kw_end])) {
+                ++kw_end;
+            }
+
+            auto kw = text.substr(i, kw_end - i);
+            if (kw == "include" || kw == "include_next" || kw == "import") {
+                i = skip_spaces(kw_end);
+                auto close_char = i < line_end && text[i] == '<' ? '>' : '"';
+                if (i < line_end && (text[i] == '"' || text[i] == '<')) {
+                    auto close = text.find(close_char, i + 1);
+                    if (close != std::string_view::npos && close < line_end && close > i + 1) {
+                        auto angled = text[i] == '<' || kw == "include_next";
+                        res.push_back(include_directive{text.substr(i + 1, close - i - 1), angled});
+                    }
+                } else if (i < line_end && is_ident_char(text[i])) {
+                    res.push_back(include_directive{{}, true});
+                }
+            }
+        }
+
+        pos = line_end + 1;
+    }
+
+    return res;
+}
+
+
+std::optional<fs::path> include_graph::resolve(const include_directive & inc,
+                                               const fs::path & dir) const {
+    if (inc.path.empty()) {
+        return std::nullopt;
+    }
+
+    auto exists = [](const fs::path & p) {
+        std::error_code ec;
+        return fs::is_regular_file(p, ec);
+    };
+
+    fs::path inc_path{inc.path};
+    if (inc_path.is_absolute()) {
+        return exists(inc_path) ? std::optional{inc_path} : std::nullopt;
+    }
+
+    if (!inc.angled && exists(dir / inc_path)) {
+        return dir / inc_path;
+    }
+
+    for (auto && inc_dir : include_dirs_) {
+        if (exists(inc_dir / inc_path)) {
+            return inc_dir / inc_path;
+        }
+    }
+
+    for (auto && sys_dir : system_dirs_) {
+        if (exists(sys_dir / inc_path)) {
+            return fs::path{};
+        }
+    }
+
+    return std::nullopt;
+}
+
+
+const include_graph::node & include_graph::scan(file_id file) {
+    auto & paths = source_path_table::global();
+    auto & p = paths.path(file);
+
+    node n;
+    n.stamp = file_stamp::of(p);
+
+    // dependencies of file which can't be read are unknown
+    std::ifstream istr{p.string(), std::ios::binary};
+    if (istr.is_open()) {
+        std::ostringstream text;
+        text << istr.rdbuf();
+
+        for (auto && inc : scan_includes(text.view())) {
+            auto inc_path = resolve(inc, p.parent_path());
+            if (!inc_path) {
+                n.unresolved = true;
+            } else if (!inc_path->empty()) {
+                n.includes.push_back(paths.intern(*inc_path));
+            }
+        }
+    } else {
+        n.unresolved = true;
+    }
+
+    ++scanned_count_;
+    auto & res = nodes_[file];
+    res = std::move(n);
+    return res;
+}
+
+
+void include_graph::update(const fs::path & tu) {
+    stats_phase phase{"include-graph"};
+    auto & paths = source_path_table::global();
+
+    // traversing include graph from translation unit, rescanning changed files
+    std::vector<file_id> stack{paths.intern(tu)};
+    std::unordered_set<file_id> visited{stack.back()};
+    while (!stack.empty()) {
+        auto file = stack.back();
+        stack.pop_back();
+
+        auto it = nodes_.find(file);
+        const node * n = nullptr;
+        if (it != nodes_.end() && it->second.stamp == file_stamp::of(paths.path(file))) {
+            n = &it->second;
+        } else {
+            n = &scan(file);
+        }
+
+        for (auto inc : n->includes) {
+            if (visited.insert(inc).second) {
+                stack.push_back(inc);
+            }
+        }
+    }
+}
+
+
+std::vector<file_id> include_graph::included_files(const fs::path & tu) const {
+    std::vector<file_id> res{source_path_table::global().intern(tu)};
+    std::unordered_set<file_id> visited{res.back()};
+    for (std::size_t i = 0; i < res.size(); ++i) {
+        auto it = nodes_.find(res[i]);
+        if (it == nodes_.end()) {
+            continue;
+        }
+
+        for (auto inc : it->second.includes) {
+            if (visited.insert(inc).second) {
+                res.push_back(inc);
+            }
+        }
+    }
+
+    return res;
+}
+
+
+bool include_graph::complete(const fs::path & tu) const {
+    std::vector<file_id> stack{source_path_table::global().intern(tu)};
+    std::unordered_set<file_id> visited{stack.back()};
+    while (!stack.empty()) {
+        auto it = nodes_.find(stack.back());
+        stack.pop_back();
+        if (it == nodes_.end() || it->second.unresolved) {
+            return false;
+        }
+
+        for (auto inc : it->second.includes) {
+            if (visited.insert(inc).second) {
+                stack.push_back(inc);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+/// Returns true if path ends with all components of specified suffix path
+static bool path_ends_with(const fs::path & p, const fs::path & suffix) {
+    auto p_it = p.end();
+    auto s_it = suffix.end();
+    while (s_it != suffix.begin()) {
+        if (p_it == p.begin() || *--p_it != *--s_it) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+std::vector<fs::path> include_graph::affected(const std::vector<fs::path> & tus,
+                                              const fs::path & target) const {
+    auto & paths = source_path_table::global();
+
+    // looking for files matching target path
+    std::unordered_set<file_id> reached;
+    auto norm_target = target.lexically_normal();
+    for (auto && [file, n] : nodes_) {
+        if (path_ends_with(paths.path(file), norm_target)) {
+            reached.insert(file);
+        }
+    }
+
+    if (reached.empty()) {
+        return tus;
+    }
+
+    // files with unresolved includes may include target
+    for (auto && [file, n] : nodes_) {
+        if (n.unresolved) {
+            reached.insert(file);
+        }
+    }
+
+    // building reverse edges and collecting all files which include targets
+    std::unordered_map<file_id, std::vector<file_id>> includers;
+    for (auto && [file, n] : nodes_) {
+        for (auto inc : n.includes) {
+            includers[inc].push_back(file);
+        }
+    }
+
+    std::vector<file_id> stack(reached.begin(), reached.end());
+    while (!stack.empty()) {
+        auto file = stack.back();
+        stack.pop_back();
+
+        auto it = includers.find(file);
+        if (it == includers.end()) {
+            continue;
+        }
+
+        for (auto inc : it->second) {
+            if (reached.insert(inc).second) {
+                stack.push_back(inc);
+            }
+        }
+    }
+
+    std::vector<fs::path> res;
+    for (auto && tu : tus) {
+        if (reached.contains(paths.intern(tu))) {
+            res.push_back(tu);
+        }
+    }
+
+    return res;
+}
+
+
+void include_graph::load(const fs::path & p) {
+    std::ifstream istr{p};
+    if (!istr.is_open()) {
+        return;
+    }
+
+    std::string line;
+    if (std::getline(istr, line) && line == old_graph_file_header) {
+        return;
+    }
+
+    if (!istr || line != graph_file_header) {
+        std::ostringstream msg;
+        msg << "invalid include graph file: " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    // reading include directories and file records, each record is followed by
+    // its includes
+    auto & paths = source_path_table::global();
+    std::vector<fs::path> include_dirs;
+    std::vector<fs::path> system_dirs;
+    std::unordered_map<file_id, node> nodes;
+    node * cur = nullptr;
+    while (std::getline(istr, line)) {
+        std::istringstream lstr{line};
+        std::string kind;
+        lstr >> kind;
+
+        auto rest = [&]() {
+            lstr.get();
+
+            std::string path;
+            std::getline(lstr, path);
+            return path;
+        };
+
+        if (kind == "dir" && nodes.empty()) {
+            include_dirs.emplace_back(rest());
+        } else if (kind == "sysdir" && nodes.empty()) {
+            system_dirs.emplace_back(rest());
+        } else if (kind == "file") {
+            node n;
+            lstr >> n.stamp.mtime >> n.stamp.size;
+            n.stamp.exists = true;
+            cur = &(nodes[paths.intern(rest())] = std::move(n));
+        } else if (kind == "inc" && cur != nullptr) {
+            cur->includes.push_back(paths.intern(rest()));
+        } else if (kind == "unresolved" && cur != nullptr) {
+            cur->unresolved = true;
+        } else {
+            std::ostringstream msg;
+            msg << "invalid line in include graph file " << p << ": " << line;
+            throw std::runtime_error{msg.str()};
+        }
+    }
+
+    // includes are resolved differently with other include directories
+    if (include_dirs != include_dirs_ || system_dirs != system_dirs_) {
+        return;
+    }
+
+    for (auto && [file, n] : nodes) {
+        nodes_[file] = std::move(n);
+    }
+}
+
+
+void include_graph::save(const fs::path & p) const {
+    std::ofstream ostr{p};
+    if (!ostr.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open include graph file for writing: " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    auto & paths = source_path_table::global();
+    ostr << graph_file_header << '\n';
+    for (auto && dir : include_dirs_) {
+        ostr << "dir " << dir.string() << '\n';
+    }
+
+    for (auto && dir : system_dirs_) {
+        ostr << "sysdir " << dir.string() << '\n';
+    }
+
+    for (auto && [file, n] : nodes_) {
+        ostr << "file " << n.stamp.mtime << ' ' << n.stamp.size << ' '
+             << paths.path(file).string() << '\n';
+        for (auto inc : n.includes) {
+            ostr << "inc " << paths.path(inc).string() << '\n';
+        }
+
+        if (n.unresolved) {
+            ostr << "unresolved\n";
+        }
+    }
+}
+
+
+std::vector<fs::path> include_graph::compiler_system_dirs(const std::string & compiler) {
+    // compiler lists search directories of angled includes on standard error
+    // between these lines
+    constexpr std::string_view list_start = "#include <...> search starts here:";
+    constexpr std::string_view list_end = "End of search list.";
+
+    process_result proc;
+    try {
+        proc = run_process({compiler, "-E", "-x", "c++", "-v", "/dev/null"}, process_stream::err);
+    }
+    catch (const std::exception & err) {
+        IG_WARNING << "can't get system include directories: " << err.what();
+        return {};
+    }
+
+    if (!WIFEXITED(proc.status) || WEXITSTATUS(proc.status) != 0) {
+        IG_WARNING << "can't get system include directories: compiler '" << compiler
+                   << "' failed";
+        return {};
+    }
+
+    std::vector<fs::path> res;
+    std::istringstream istr{proc.output};
+    std::string line;
+    bool in_list = false;
+    while (std::getline(istr, line)) {
+        if (line == list_start) {
+            in_list = true;
+        } else if (line == list_end) {
+            break;
+        } else if (in_list) {
+            // framework directories of macOS are not searched for plain paths
+            auto first = line.find_first_not_of(' ');
+            if (first != std::string::npos &&
+                line.find(" (framework directory)") == std::string::npos) {
+                res.emplace_back(line.substr(first));
+            }
+        }
+    }
+
+    return res;
+}
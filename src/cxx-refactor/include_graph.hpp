@@ -0,0 +1,113 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file include_graph.hpp
+/// Contains definition of the include_graph class.
+
+#pragma once
+
+#include "mapped_file.hpp"
+#include "source_path_table.hpp"
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+/// Graph of include dependencies between project source files. Includes of each file
+/// are found by scanning its text for #include directives, directives in all
+/// preprocessor branches are taken into account. Includes are resolved in the same order
+/// as compiler does: quoted includes relative to directory of including file and then in
+/// include directories, angled includes in include directories only. Include
+/// directories are searched before system include directories. Headers found in system
+/// include directories are not part of graph, they are assumed to not include project
+/// sources.
+///
+/// Files with includes which can't be resolved (headers missing in all directories, paths
+/// computed by macros) have unknown dependencies. Translation units reaching such files
+/// are always selected as affected, so selection over-approximates real dependencies as
+/// long as include directories of graph are the ones passed to parser.
+///
+/// Scanned files are remembered with modification time and size and are rescanned only
+/// when they change, graph may be saved to file and loaded in the next run. Saved graph
+/// is discarded if it was built with different include directories.
+class include_graph {
+public:
+    /// Include directive found in source text
+    struct include_directive {
+        std::string_view path;              ///< Included path, empty if computed by macro
+        bool angled = false;                ///< Path is enclosed in angle brackets
+    };
+
+    /// Constructs empty graph resolving includes in specified include directories, headers
+    /// found in them are scanned, and in system include directories
+    explicit include_graph(std::vector<std::filesystem::path> include_dirs = {},
+                           std::vector<std::filesystem::path> system_dirs = {});
+
+    /// Scans specified translation unit and all files it includes transitively.
+    /// Files which did not change since previous scan are not scanned again
+    void update(const std::filesystem::path & tu);
+
+    /// Returns translation units from specified list which are the target file or
+    /// include it transitively, or which include files with unresolved includes.
+    /// Target path may be a suffix of full path, like paths of source positions.
+    /// Returns all translation units if there are no known files matching target path
+    std::vector<std::filesystem::path> affected(const std::vector<std::filesystem::path> & tus,
+                                                const std::filesystem::path & target) const;
+
+    /// Returns identifiers of specified translation unit and all project files it includes
+    /// transitively. Graph must be updated for translation unit
+    std::vector<file_id> included_files(const std::filesystem::path & tu) const;
+
+    /// Returns true if all includes of specified translation unit and of files it includes
+    /// transitively are resolved, so included_files returns all its project files. Graph
+    /// must be updated for translation unit
+    bool complete(const std::filesystem::path & tu) const;
+
+    /// Loads graph from file saved by the save function. Does nothing if file doesn't
+    /// exist, was saved by previous version or with different include directories
+    void load(const std::filesystem::path & p);
+
+    /// Saves graph to file
+    void save(const std::filesystem::path & p) const;
+
+    /// Returns number of files in graph
+    std::size_t size() const { return nodes_.size(); }
+
+    /// Returns number of files scanned since graph was constructed
+    std::size_t scanned_count() const { return scanned_count_; }
+
+    /// Returns include directives found in specified source text
+    static std::vector<include_directive> scan_includes(std::string_view text);
+
+    /// Returns system include directories reported by specified compiler. Returns empty
+    /// list if compiler can't be run
+    static std::vector<std::filesystem::path> compiler_system_dirs(const std::string & compiler);
+
+private:
+    /// Scanned file
+    struct node {
+        file_stamp stamp;                   ///< File stamp at scan
+        std::vector<file_id> includes;      ///< Project files included by this file
+        bool unresolved = false;            ///< File has includes which can't be resolved
+    };
+
+    /// Scans single file and updates its node. Returns reference to node
+    const node & scan(file_id file);
+
+    /// Returns path of project header included by file located in specified directory,
+    /// empty path if header is found in system include directory, or nullopt if header
+    /// is not found
+    std::optional<std::filesystem::path> resolve(const include_directive & inc,
+                                                 const std::filesystem::path & dir) const;
+
+    std::vector<std::filesystem::path> include_dirs_;   ///< Include directories
+    std::vector<std::filesystem::path> system_dirs_;    ///< System include directories
+    std::unordered_map<file_id, node> nodes_;           ///< Scanned files
+    std::size_t scanned_count_ = 0;                     ///< Number of scanned files
+};
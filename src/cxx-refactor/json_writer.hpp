@@ -0,0 +1,150 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file json_writer.hpp
+/// Contains definition of the json_writer class.
+
+#pragma once
+
+#include <concepts>
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+
+/// Simple streaming JSON writer. Writes JSON values into output stream
+/// inserting separators between object members and array elements.
+class json_writer {
+public:
+    /// Constructs writer for specified output stream
+    explicit json_writer(std::ostream & ostr): ostr_{ostr} {}
+
+    /// Starts JSON object
+    json_writer & begin_object() {
+        begin_value();
+        ostr_ << '{';
+        first_.push_back(true);
+        return *this;
+    }
+
+    /// Finishes JSON object
+    json_writer & end_object() {
+        first_.pop_back();
+        ostr_ << '}';
+        return *this;
+    }
+
+    /// Starts JSON array
+    json_writer & begin_array() {
+        begin_value();
+        ostr_ << '[';
+        first_.push_back(true);
+        return *this;
+    }
+
+    /// Finishes JSON array
+    json_writer & end_array() {
+        first_.pop_back();
+        ostr_ << ']';
+        return *this;
+    }
+
+    /// Writes object member key. Must be followed by member value
+    json_writer & key(std::string_view k) {
+        begin_value();
+        write_string(k);
+        ostr_ << ':';
+        after_key_ = true;
+        return *this;
+    }
+
+    /// Writes string value
+    json_writer & value(std::string_view v) {
+        begin_value();
+        write_string(v);
+        return *this;
+    }
+
+    /// Writes string value
+    json_writer & value(const char * v) { return value(std::string_view{v}); }
+
+    /// Writes boolean value
+    json_writer & value(bool v) {
+        begin_value();
+        ostr_ << (v ? "true" : "false");
+        return *this;
+    }
+
+    /// Writes integer value
+    template <std::integral T>
+    json_writer & value(T v) {
+        begin_value();
+        ostr_ << v;
+        return *this;
+    }
+
+    /// Writes floating point value
+    template <std::floating_point T>
+    json_writer & value(T v) {
+        begin_value();
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.15g", static_cast<double>(v));
+        ostr_ << buf;
+        return *this;
+    }
+
+    /// Writes object member with specified key and value
+    template <typename T>
+    json_writer & member(std::string_view k, const T & v) {
+        key(k);
+        return value(v);
+    }
+
+private:
+    /// Writes separator before value if required
+    void begin_value() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
+        }
+
+        if (!first_.empty()) {
+            if (!first_.back()) {
+                ostr_ << ',';
+            }
+
+            first_.back() = false;
+        }
+    }
+
+    /// Writes escaped string
+    void write_string(std::string_view s) {
+        ostr_ << '"';
+        for (auto c : s) {
+            switch (c) {
+            case '"':  ostr_ << "\\\""; break;
+            case '\\': ostr_ << "\\\\"; break;
+            case '\n': ostr_ << "\\n"; break;
+            case '\r': ostr_ << "\\r"; break;
+            case '\t': ostr_ << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buf[8];
+                    std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                    ostr_ << buf;
+                } else {
+                    ostr_ << c;
+                }
+            }
+        }
+        ostr_ << '"';
+    }
+
+    std::ostream & ostr_;                   ///< Output stream
+    std::vector<bool> first_;               ///< First element flags for open objects and arrays
+    bool after_key_ = false;                ///< True if object member key was just written
+};
@@ -0,0 +1,71 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file line_index.cpp
+/// Contains implementation of the line_index class.
+
+#include "pch.hpp"
+#include "line_index.hpp"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+
+
+line_index::line_index(std::string_view text) {
+    if (text.size() > std::numeric_limits<source_offset>::max()) {
+        std::ostringstream msg;
+        msg << "source text of " << text.size() << " bytes is too large for 32-bit offsets";
+        throw std::runtime_error{msg.str()};
+    }
+
+    size_ = static_cast<source_offset>(text.size());
+
+    line_starts_.push_back(0);
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') {
+            line_starts_.push_back(static_cast<source_offset>(i + 1));
+        }
+    }
+}
+
+
+std::shared_ptr<const line_index> line_index::from_file(const std::filesystem::path & p) {
+    std::ifstream file{p.string(), std::ios::binary};
+    if (!file.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open input file " << p << " for reading";
+        throw std::runtime_error{msg.str()};
+    }
+
+    std::ostringstream text;
+    text << file.rdbuf();
+    return std::make_shared<const line_index>(text.view());
+}
+
+
+source_offset line_index::offset(const cm::src::source_position & pos) const {
+    if (pos.line() >= 1 && pos.line() <= line_starts_.size() && pos.column() >= 1) {
+        auto start = line_starts_[pos.line() - 1];
+
+        // position may point to line end character or to the end of the last line
+        auto last = pos.line() < line_starts_.size() ? line_starts_[pos.line()] - 1 : size_;
+        if (pos.column() - 1 <= last - start) {
+            return static_cast<source_offset>(start + pos.column() - 1);
+        }
+    }
+
+    std::ostringstream msg;
+    msg << "source position (" << pos.line() << ", " << pos.column()
+        << ") is outside of source text";
+    throw std::runtime_error{msg.str()};
+}
+
+
+cm::src::source_position line_index::position(source_offset off) const {
+    auto it = std::ranges::upper_bound(line_starts_, off);
+    auto line = static_cast<std::size_t>(std::distance(line_starts_.begin(), it));
+    return cm::src::source_position{line, off - *std::prev(it) + 1};
+}
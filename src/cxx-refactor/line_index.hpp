@@ -0,0 +1,50 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file line_index.hpp
+/// Contains definition of the line_index class.
+
+#pragma once
+
+#include <cm/src/cmsrc.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+
+/// Byte offset in source file
+using source_offset = std::uint32_t;
+
+
+/// Index of line start offsets in source file. Converts line/column source positions
+/// to byte offsets and back
+class line_index {
+public:
+    /// Builds index for specified source text
+    explicit line_index(std::string_view text);
+
+    /// Builds index for source file located at specified path
+    static std::shared_ptr<const line_index> from_file(const std::filesystem::path & p);
+
+    /// Returns byte offset of specified source position. Throws exception
+    /// if position is outside of source text
+    source_offset offset(const cm::src::source_position & pos) const;
+
+    /// Returns source position of specified byte offset
+    cm::src::source_position position(source_offset off) const;
+
+    /// Returns size of indexed source text in bytes
+    source_offset size() const { return size_; }
+
+    /// Returns number of lines in indexed source text
+    std::size_t lines_count() const { return line_starts_.size(); }
+
+private:
+    std::vector<source_offset> line_starts_;        ///< Offsets of line starts
+    source_offset size_ = 0;                        ///< Size of source text
+};
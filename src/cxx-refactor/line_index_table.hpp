@@ -0,0 +1,68 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file line_index_table.hpp
+/// Contains definition of the line_index_table class.
+
+#pragma once
+
+#include "line_index.hpp"
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+/// Cache of line indexes of source files. Index of each file is built once when
+/// it's requested for the first time. All member functions are thread safe.
+class line_index_table {
+public:
+    /// Constructs empty table
+    explicit line_index_table() = default;
+
+    /// Returns reference to process wide line index table
+    static line_index_table & global() {
+        static line_index_table table;
+        return table;
+    }
+
+    /// Returns line index of source file located at specified path. Builds index
+    /// if it's not cached yet
+    std::shared_ptr<const line_index> get(const std::filesystem::path & p) {
+        if (auto idx = find(p)) {
+            return idx;
+        }
+
+        // building index outside of lock, concurrent builds of the same index are harmless
+        auto idx = line_index::from_file(p);
+
+        std::unique_lock lock{mtx_};
+        return indexes_.emplace(p.native(), std::move(idx)).first->second;
+    }
+
+    /// Returns cached line index of source file located at specified path or nullptr
+    std::shared_ptr<const line_index> find(const std::filesystem::path & p) const {
+        std::shared_lock lock{mtx_};
+        auto it = indexes_.find(p.native());
+        return it != indexes_.end() ? it->second : nullptr;
+    }
+
+    /// Removes cached line index of source file located at specified path
+    void invalidate(const std::filesystem::path & p) {
+        std::unique_lock lock{mtx_};
+        indexes_.erase(p.native());
+    }
+
+    /// Removes all cached line indexes
+    void clear() {
+        std::unique_lock lock{mtx_};
+        indexes_.clear();
+    }
+
+private:
+    mutable std::shared_mutex mtx_;                             ///< Table mutex
+    std::unordered_map<std::filesystem::path::string_type,
+                       std::shared_ptr<const line_index>> indexes_;     ///< Cached indexes
+};
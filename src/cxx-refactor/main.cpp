@@ -8,15 +8,34 @@
 /// Main entry point to cxx-refactor utility
 
 #include "pch.hpp"
+#include "apply_edits_action.hpp"
+#include "cancellation.hpp"
 #include "find_definition_action.hpp"
+#include "in_place_writer.hpp"
+#include "include_graph.hpp"
+#include "memory_accounting.hpp"
 #include "refactor_action.hpp"
 #include "refactor_action_registry.hpp"
+#include "refactor_stats.hpp"
+#include "resident_model.hpp"
+#include "result_cache.hpp"
+#include "rewrite_verifier.hpp"
+#include "shard_executor.hpp"
+#include "pipeline_executor.hpp"
+#include "streaming_executor.hpp"
+#include "symbol_prefilter.hpp"
 #include "template_parameter_remove_action.hpp"
+#include "thread_pool.hpp"
+#include "trace_recorder.hpp"
 #include "log/log_init.hpp"
 #include <cm/src/cmsrc.hpp>
-#include <cm/src/cxx/clang/cmsrcclang.hpp>
+#include <algorithm>
+#include <atomic>
+#include <csignal>
 #include <iostream>
 #include <filesystem>
+#include <fstream>
+#include <unordered_set>
 #include <boost/program_options.hpp>
 
 
@@ -24,19 +43,389 @@ namespace fs = std::filesystem;
 namespace po = boost::program_options;
 
 
+/// Writes process wide statistics in JSON format to file with specified path.
+/// Writes statistics to standard error stream if path is '-'
+static void write_stats(const fs::path & path) {
+    if (path == "-") {
+        refactor_stats::global().write_json(std::cerr);
+        return;
+    }
+
+    std::ofstream ostr{path};
+    if (!ostr.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open statistics file for writing: " << path;
+        throw std::runtime_error{msg.str()};
+    }
+
+    refactor_stats::global().write_json(ostr);
+}
+
+
+/// Writes memory report in JSON format to file with specified path.
+/// Writes report to standard error stream if path is '-'
+static void write_memory_report(const fs::path & path) {
+    if (path == "-") {
+        memory_accounting::write_json(std::cerr);
+        return;
+    }
+
+    std::ofstream ostr{path};
+    if (!ostr.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open memory report file for writing: " << path;
+        throw std::runtime_error{msg.str()};
+    }
+
+    memory_accounting::write_json(ostr);
+}
+
+
+/// Returns list of input sources specified with --input and --input-list options
+static std::vector<fs::path> input_paths(const po::variables_map & var_map) {
+    std::vector<fs::path> res;
+    if (var_map.count("input") > 0) {
+        res = var_map["input"].as<std::vector<fs::path>>();
+    }
+
+    if (var_map.count("input-list") > 0) {
+        auto list_path = var_map["input-list"].as<fs::path>();
+        std::ifstream istr{list_path};
+        if (!istr.is_open()) {
+            std::ostringstream msg;
+            msg << "can't open input list file for reading: " << list_path;
+            throw std::runtime_error{msg.str()};
+        }
+
+        std::string line;
+        while (std::getline(istr, line)) {
+            if (!line.empty()) {
+                res.emplace_back(line);
+            }
+        }
+    }
+
+    if (res.empty()) {
+        throw std::runtime_error{"input sources are not specified, "
+                                 "please set the --input or --input-list option"};
+    }
+
+    return res;
+}
+
+
+/// Returns include directories specified with the --include-dir option
+static std::vector<fs::path> include_dirs(const po::variables_map & var_map) {
+    if (var_map.count("include-dir") == 0) {
+        return {};
+    }
+
+    return var_map["include-dir"].as<std::vector<fs::path>>();
+}
+
+
+/// Returns compiler arguments adding include directories specified with the
+/// --include-dir option to search paths
+static std::vector<std::string> include_args(const po::variables_map & var_map) {
+    std::vector<std::string> res;
+    for (auto && dir : include_dirs(var_map)) {
+        res.push_back("-I" + dir.string());
+    }
+
+    return res;
+}
+
+
+/// Returns empty include graph resolving includes in directories specified with the
+/// --include-dir option and in system include directories of compiler specified with
+/// the --compiler option
+static include_graph make_include_graph(const po::variables_map & var_map) {
+    return include_graph{include_dirs(var_map),
+                         include_graph::compiler_system_dirs(var_map["compiler"].as<std::string>())};
+}
+
+
+/// Returns translation units which need to be parsed for action. With the --include-graph
+/// option only translation units which include source file referenced by action arguments
+/// are selected, include graph is loaded from file, updated and saved back. With the
+/// --prefilter option translation units which don't mention spelling of target symbol
+/// in their text or included files are skipped, token bitmaps of files are kept next to
+/// include graph file if it's specified. Include graph is updated for all
+/// translation units if it's used for selection or required by the --pipeline
+/// or --verify options
+static std::vector<fs::path> select_tus(const refactor_action & action,
+                                        const std::vector<fs::path> & inputs,
+                                        const po::variables_map & var_map,
+                                        const po::variables_map & act_opts,
+                                        include_graph & graph) {
+    auto use_graph = var_map.count("include-graph") > 0;
+    auto use_prefilter = var_map.count("prefilter") > 0;
+    auto use_pipeline = var_map.count("pipeline") > 0 || var_map.count("verify") > 0;
+    if (!use_graph && !use_prefilter && !use_pipeline) {
+        return inputs;
+    }
+
+    if (use_graph) {
+        graph.load(var_map["include-graph"].as<fs::path>());
+    }
+
+    for (auto && tu : inputs) {
+        graph.update(tu);
+    }
+
+    auto res = inputs;
+    auto target = action.target_source(act_opts);
+    if (use_graph) {
+        graph.save(var_map["include-graph"].as<fs::path>());
+
+        if (target) {
+            res = graph.affected(res, *target);
+            refactor_stats::global().add(stats_counter::tus_skipped, inputs.size() - res.size());
+        }
+    }
+
+    if (res.empty()) {
+        std::ostringstream msg;
+        msg << "can't find source file: '" << target->string() << "' in any of translation units";
+        throw std::runtime_error{msg.str()};
+    }
+
+    if (use_prefilter) {
+        if (auto spelling = action.target_spelling(act_opts)) {
+            // bitmaps pay off only if they are reused in the next runs
+            symbol_prefilter prefilter{use_graph};
+            fs::path cache_path;
+            if (use_graph) {
+                cache_path = var_map["include-graph"].as<fs::path>();
+                cache_path += ".prefilter";
+                prefilter.load(cache_path);
+            }
+
+            res = prefilter.candidates(res, *spelling, graph);
+            if (use_graph && prefilter.scanned_count() != 0) {
+                prefilter.save(cache_path);
+            }
+
+            if (res.empty()) {
+                std::ostringstream msg;
+                msg << "symbol '" << *spelling << "' is not mentioned in any of translation units";
+                throw std::runtime_error{msg.str()};
+            }
+        }
+    }
+
+    return res;
+}
+
+
+/// Token cancelled by interrupt signal, set by interrupt_scope
+static std::atomic<cancellation_token *> interrupt_token{nullptr};
+
+
+/// Handler of interrupt signal. Cancels current operation, the next signal terminates
+/// process
+static void interrupt_handler(int) {
+    if (auto token = interrupt_token.load()) {
+        token->cancel();
+    }
+
+    std::signal(SIGINT, SIG_DFL);
+}
+
+
+/// Cancels token by interrupt signal for lifetime of scope. Must be destroyed before
+/// token, default disposition of interrupt signal is restored on destruction
+class interrupt_scope {
+public:
+    /// Installs handler of interrupt signal cancelling specified token
+    explicit interrupt_scope(cancellation_token & token) {
+        interrupt_token.store(&token);
+        std::signal(SIGINT, interrupt_handler);
+    }
+
+    /// Restores default disposition of interrupt signal and resets token
+    ~interrupt_scope() {
+        std::signal(SIGINT, SIG_DFL);
+        interrupt_token.store(nullptr);
+    }
+
+    interrupt_scope(const interrupt_scope &) = delete;
+    interrupt_scope & operator=(const interrupt_scope &) = delete;
+};
+
+
+/// Returns cancellation token with deadline specified by the --timeout option
+static cancellation_token make_cancellation_token(const po::variables_map & var_map) {
+    if (var_map.count("timeout") == 0) {
+        return cancellation_token{};
+    }
+
+    std::chrono::duration<double> timeout{var_map["timeout"].as<double>()};
+    return cancellation_token{cancellation_token::clock::now() +
+                              std::chrono::duration_cast<cancellation_token::clock::duration>(timeout)};
+}
+
+
+/// Returns description of reason of cancellation for user
+static const char * cancellation_reason(const cancellation_token & token) {
+    return token.deadline_exceeded() ? "deadline exceeded" : "operation cancelled";
+}
+
+
+/// Runs server mode. Translation units are parsed once and requests read from standard
+/// input are executed over resident code models, each request is a line with action
+/// name and action arguments. Response is followed by line '==> end <=='. Server stops
+/// at end of input or on 'quit' request
+static void run_server(const refactor_action_registry & actions,
+                       const std::vector<fs::path> & inputs,
+                       const po::variables_map & var_map) {
+    resident_model model{inputs, var_map.count("watch") > 0 ? make_include_graph(var_map)
+                                                             : include_graph{}};
+    model.load();
+
+    if (var_map.count("watch") > 0) {
+        model.watch(var_map["watch"].as<std::vector<fs::path>>(),
+                    std::chrono::milliseconds{var_map["watch-debounce"].as<unsigned>()});
+    }
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        auto args = po::split_unix(line);
+        if (args.empty()) {
+            continue;
+        }
+
+        if (args.front() == "quit") {
+            break;
+        }
+
+        try {
+            auto & action = actions.find_action(args.front());
+            args.erase(args.begin());
+
+            po::variables_map act_var_map;
+            po::store(po::command_line_parser(args).options(action.opts()).run(), act_var_map);
+            po::notify(act_var_map);
+
+            // each request has its own deadline
+            auto token = make_cancellation_token(var_map);
+            cancellation_scope cancel_scope{&token};
+            auto res = action.requires_code_model()
+                ? model.query(action, act_var_map, var_map.count("partial") > 0)
+                : action.extract(cm::src::source_code_model{}, act_var_map);
+            if (token.cancelled()) {
+                std::cout << "WARNING: " << cancellation_reason(token) << ", results are partial"
+                          << std::endl;
+            }
+
+            if (!res.empty()) {
+                action.output(res, act_var_map);
+            }
+        }
+        catch (std::exception & err) {
+            std::cout << "ERROR: " << err.what() << std::endl;
+        }
+
+        std::cout << "==> end <==" << std::endl;
+    }
+}
+
+
+/// Writes recorded trace events in Chrome trace event format to file with specified path
+static void write_trace(const fs::path & path) {
+    std::ofstream ostr{path};
+    if (!ostr.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open trace file for writing: " << path;
+        throw std::runtime_error{msg.str()};
+    }
+
+    trace_recorder::global().write_json(ostr);
+}
+
 
 int main(int argc, char * argv[]) {
     try {
         refactor_action_registry actions;
         actions.reg_action(std::make_unique<find_definition_action>());
         actions.reg_action(std::make_unique<template_parameter_remove_action>());
+        actions.reg_action(std::make_unique<apply_edits_action>());
 
         po::options_description global_opts{"Global arguments"};
         global_opts.add_options()
             ("help", "Produce help message and exit")
-            ("input,i", po::value<fs::path>()->required(), "path to input source to parse");
+            ("input,i", po::value<std::vector<fs::path>>()->composing(),
+                "path to input source to parse (may be specified multiple times)")
+            ("input-list", po::value<fs::path>(),
+                "path to file with list of input sources, one path per line")
+            ("tu-jobs", po::value<std::size_t>()->default_value(0),
+                "maximum number of translation units parsed and kept in memory concurrently, "
+                "limits memory usage (0 means number of worker threads)")
+            ("cost-hints", po::value<fs::path>(),
+                "path to file with processing times of translation units from previous runs, "
+                "the most expensive translation units are processed first (file is updated)")
+            ("include-dir,I", po::value<std::vector<fs::path>>()->composing(),
+                "directory searched for included headers when parsing, scanning includes "
+                "and verifying translation units (may be specified multiple times)")
+            ("compiler", po::value<std::string>()->default_value("clang++"),
+                "compiler reporting system include directories, headers found in them are "
+                "not scanned by include graph, and files read by translation units for "
+                "result cache")
+            ("include-graph", po::value<fs::path>(),
+                "path to include graph file, parse only translation units which include "
+                "source referenced by action (graph is updated incrementally and saved)")
+            ("prefilter", "parse only translation units which mention spelling of target "
+                "symbol in their text or included files (token bitmaps of files are kept "
+                "next to include graph file)")
+            ("arena", "experimental: allocate code model of each translation unit in memory "
+                "arena released at once after processing")
+            ("arena-huge-pages", "back memory arenas with transparent huge pages")
+            ("arena-reserve", po::value<std::size_t>()->default_value(4096),
+                "virtual memory reserved for each memory arena in megabytes")
+            ("pipeline", "run parsing, action, rewriting and writing of sources as concurrent "
+                "stages, sources are written as soon as all translation units including them "
+                "are processed (output order may differ from order of paths)")
+            ("pipeline-queue", po::value<std::size_t>()->default_value(2),
+                "capacity of queues between pipeline stages")
+            ("server", "keep code models of translation units in memory and execute requests "
+                "read from standard input, one line with action name and arguments per request")
+            ("watch", po::value<std::vector<fs::path>>()->composing(),
+                "in server mode watch directory for changes of sources and re-parse affected "
+                "translation units in background (may be specified multiple times)")
+            ("watch-debounce", po::value<unsigned>()->default_value(300),
+                "milliseconds without changes before re-parsing after change of sources")
+            ("in-place", "overwrite modified sources instead of printing them, sources which "
+                "content doesn't change are not written")
+            ("verify", "re-parse translation units including rewritten sources in memory "
+                "and report new compiler diagnostics")
+            ("verify-compiler", po::value<std::string>()->default_value("clang++"),
+                "compiler used for verification (must support -ivfsoverlay)")
+            ("verify-arg", po::value<std::vector<std::string>>()->composing(),
+                "additional compiler argument for verification (may be specified multiple times)")
+            ("result-cache", po::value<fs::path>(),
+                "directory of cache of action results, result is taken from cache without "
+                "parsing if action, arguments, inputs and contents of files read are the same")
+            ("result-cache-size", po::value<std::size_t>()->default_value(256),
+                "size limit of result cache in megabytes, least recently used results are evicted")
+            ("timeout", po::value<double>(),
+                "deadline of action in seconds (of each request in server mode), translation "
+                "units are not processed after deadline is exceeded")
+            ("partial", "output results of translation units processed before deadline is "
+                "exceeded or operation is interrupted, exit status is 3 if results are partial")
+            ("shards", po::value<std::size_t>(),
+                "distribute translation units between specified number of worker processes, "
+                "results of workers are merged (crash of worker loses only its translation units)")
+            ("jobs,j", po::value<unsigned>(),
+                "number of worker threads parsing translation units, executing actions and "
+                "rewriting sources (default: number of hardware threads)")
+            ("stats", po::value<fs::path>()->implicit_value("-"),
+                "write phase timings and counters in JSON format to file ('-' for stderr)")
+            ("trace-file", po::value<fs::path>(),
+                "write trace of execution phases in Chrome trace event format to file")
+            ("memory-report", po::value<fs::path>()->implicit_value("-"),
+                "write peak RSS and allocations per phase and subsystem in JSON format "
+                "to file ('-' for stderr)");
             // ("output,o", po::value<fs::path>(), "optional path to output source")
-            // ("in-place", "overwrite original input files with changes")
         
         global_opts.add(log_options());
 
@@ -61,7 +450,7 @@ int main(int argc, char * argv[]) {
         po::store(parsed_opts, var_map);
 
         // displaying help message if requested without action
-        if (var_map.count("action") == 0) {
+        if (var_map.count("action") == 0 && (var_map.count("server") == 0 || var_map.count("help") > 0)) {
             std::cout << "cxx-refactor tool" << std::endl
                       << "Usage: cxx-refactor [global arguments] action [action arguments]"
                       << std::endl << std::endl;
@@ -74,6 +463,22 @@ int main(int argc, char * argv[]) {
             return 1;
         }
 
+        // running server mode, actions are specified by requests
+        if (var_map.count("server") > 0) {
+            notify(var_map);
+
+            log_shutdown_guard log_guard;
+            log_init(var_map);
+
+            if (var_map.count("jobs") > 0) {
+                thread_pool::configure_global(var_map["jobs"].as<unsigned>());
+            }
+
+            set_parse_args(include_args(var_map));
+            run_server(actions, input_paths(var_map), var_map);
+            return 0;
+        }
+
         // searching for refactor action in actions registry
         auto & action = actions.find_action(var_map["action"].as<std::string>());
 
@@ -118,14 +523,273 @@ int main(int argc, char * argv[]) {
         // }
 
         // initializing log
+        log_shutdown_guard log_guard;
         log_init(var_map);
 
-        // constructing code model and parsing input source
-        cm::src::source_code_model code_mdl;
-        cm::src::clang::parse_source_file(code_mdl, var_map["input"].as<fs::path>(), {});
+        // enabling accounting of memory allocations
+        if (var_map.count("memory-report") > 0) {
+            memory_accounting::set_enabled(true);
+        }
+
+        // enabling recording of trace events
+        if (var_map.count("trace-file") > 0) {
+            trace_recorder::global().set_enabled(true);
+            trace_recorder::global().set_thread_name("main");
+        }
+
+        // configuring number of worker threads
+        if (var_map.count("jobs") > 0) {
+            thread_pool::configure_global(var_map["jobs"].as<unsigned>());
+        }
 
-        // performing action
-        action.perform(code_mdl, act_var_map);
+        // cancelling action on deadline or on interrupt signal
+        auto token = make_cancellation_token(var_map);
+        cancellation_scope cancel_scope{&token};
+        interrupt_scope interrupt_sc{token};
+
+        // parsing input sources one by one and extracting action results
+        arena_options arena_opts;
+        arena_opts.enabled = var_map.count("arena") > 0;
+        arena_opts.huge_pages = var_map.count("arena-huge-pages") > 0;
+        arena_opts.reserve_bytes = var_map["arena-reserve"].as<std::size_t>() << 20;
+
+        // passing include directories to parser
+        set_parse_args(include_args(var_map));
+
+        // input sources of actions which don't require code model are optional,
+        // they are used only for verification of rewritten sources
+        auto use_graph = var_map.count("include-graph") > 0 || var_map.count("prefilter") > 0 ||
+                         var_map.count("pipeline") > 0 || var_map.count("verify") > 0;
+        auto graph = use_graph ? make_include_graph(var_map) : include_graph{};
+        std::vector<fs::path> all_inputs;
+        std::vector<fs::path> inputs;
+        // looking up result in cache before parsing, cache is not used for actions
+        // which don't require code model
+        std::optional<result_cache> cache;
+        std::optional<std::string> cache_query;
+        std::optional<action_result> cached_res;
+        if (var_map.count("result-cache") > 0 && var_map.count("pipeline") > 0) {
+            throw std::runtime_error{"--result-cache option can't be used with --pipeline option"};
+        }
+
+        if (action.requires_code_model()) {
+            all_inputs = input_paths(var_map);
+
+            if (var_map.count("result-cache") > 0) {
+                cache.emplace(var_map["result-cache"].as<fs::path>(),
+                              var_map["result-cache-size"].as<std::size_t>() << 20);
+                cache_query = result_cache::make_query(action.name(), act_var_map, all_inputs,
+                                                       include_args(var_map));
+                if (cache_query) {
+                    cached_res = cache->find(*cache_query);
+                }
+            }
+
+            if (!cached_res) {
+                inputs = select_tus(action, all_inputs, var_map, act_var_map, graph);
+            }
+            else if (var_map.count("verify") > 0) {
+                for (auto && tu : all_inputs) {
+                    graph.update(tu);
+                }
+            }
+        }
+        else if (var_map.count("input") > 0 || var_map.count("input-list") > 0) {
+            all_inputs = input_paths(var_map);
+            if (var_map.count("verify") > 0) {
+                for (auto && tu : all_inputs) {
+                    graph.update(tu);
+                }
+            }
+        }
+
+        action_result res;
+        std::vector<std::string> shard_errors;
+        auto pipelined = var_map.count("pipeline") > 0 && action.requires_code_model();
+        if (pipelined && var_map.count("shards") > 0) {
+            throw std::runtime_error{"--shards option can't be used with --pipeline option"};
+        }
+
+        if (pipelined && var_map.count("verify") > 0) {
+            throw std::runtime_error{"--verify option can't be used with --pipeline option"};
+        }
+
+        if (pipelined && var_map.count("in-place") > 0) {
+            throw std::runtime_error{"--in-place option can't be used with --pipeline option"};
+        }
+
+        if (cached_res) {
+            res = std::move(*cached_res);
+        }
+        else if (!action.requires_code_model()) {
+            // executing action once without parsing input sources
+            stats_phase phase{"action"};
+            res = action.extract(cm::src::source_code_model{}, act_var_map);
+        }
+        else if (pipelined) {
+            // running pipelined execution, modified sources are written by pipeline
+            if (arena_opts.enabled) {
+                throw std::runtime_error{"--arena option can't be used with --pipeline option"};
+            }
+
+            pipeline_executor executor{var_map["tu-jobs"].as<std::size_t>(),
+                                       var_map["pipeline-queue"].as<std::size_t>()};
+            executor.set_partial(var_map.count("partial") > 0);
+            res = executor.run(action, inputs, graph, act_var_map, std::cout);
+        }
+        else if (var_map.count("shards") > 0) {
+            // running streaming execution in forked worker processes, workers are forked
+            // before any threads are started
+            if (var_map.count("log-async") > 0) {
+                throw std::runtime_error{"--log-async option can't be used with --shards option"};
+            }
+
+            auto tu_jobs = var_map["tu-jobs"].as<std::size_t>();
+            shard_executor executor{var_map["shards"].as<std::size_t>(),
+                                    [&](const std::vector<fs::path> & tus) {
+                streaming_executor tu_executor{tu_jobs, arena_opts};
+                tu_executor.set_partial(var_map.count("partial") > 0);
+                return tu_executor.run(action, tus, act_var_map);
+            }};
+
+            res = executor.run(inputs);
+            shard_errors = executor.errors();
+        }
+        else {
+            streaming_executor executor{var_map["tu-jobs"].as<std::size_t>(), arena_opts};
+            executor.set_partial(var_map.count("partial") > 0);
+
+            tu_cost_hints hints;
+            if (var_map.count("cost-hints") > 0) {
+                hints.load(var_map["cost-hints"].as<fs::path>());
+                executor.set_cost_hints(&hints);
+            }
+
+            res = executor.run(action, inputs, act_var_map);
+
+            if (var_map.count("cost-hints") > 0) {
+                hints.save(var_map["cost-hints"].as<fs::path>());
+            }
+        }
+
+        // storing complete result in cache with contents of all files read by parser,
+        // they are listed by compiler with the same arguments. Result is not stored if
+        // files of any translation unit can't be listed
+        auto partial = refactor_stats::global().get(stats_counter::tus_cancelled) != 0;
+        if (cache_query && !cached_res && !partial && shard_errors.empty()) {
+            auto compiler = var_map["compiler"].as<std::string>();
+            auto args = include_args(var_map);
+            std::vector<std::optional<std::vector<fs::path>>> deps(all_inputs.size());
+            thread_pool::global().parallel_for(all_inputs.size(), [&](std::size_t idx) {
+                deps[idx] = result_cache::compiler_dependencies(compiler, args, all_inputs[idx]);
+            });
+
+            if (std::ranges::all_of(deps, [](auto && tu_deps) { return tu_deps.has_value(); })) {
+                std::unordered_set<file_id> read_files;
+                for (auto && tu_deps : deps) {
+                    for (auto && p : *tu_deps) {
+                        read_files.insert(source_path_table::global().intern(p));
+                    }
+                }
+
+                std::vector<fs::path> read_paths;
+                for (auto file : read_files) {
+                    read_paths.push_back(source_path_table::global().path(file));
+                }
+
+                cache->store(*cache_query, read_paths, res);
+            }
+        }
+
+        // sources are not modified in place if result is incomplete: some shards failed
+        // or translation units were cancelled without the --partial option
+        auto in_place = var_map.count("in-place") > 0 && !res.mods().empty();
+        if (in_place && (!shard_errors.empty() || (partial && var_map.count("partial") == 0))) {
+            std::ostringstream msg;
+            msg << "result is incomplete, sources are not modified in place";
+            for (auto && err : shard_errors) {
+                msg << '\n' << err;
+            }
+
+            throw std::runtime_error{msg.str()};
+        }
+
+        // printing action results, pipeline leaves only messages in result. Partial
+        // result may be empty
+        if (in_place) {
+            action.refactor_action::output(res, act_var_map);
+        }
+        else if (!res.empty() || (!pipelined && !partial)) {
+            stats_phase phase{"output"};
+            action.output(res, act_var_map);
+        }
+
+        // verifying rewritten sources by re-parsing all translation units including them
+        if (var_map.count("verify") > 0 && !res.mods().empty()) {
+            stats_phase phase{"verify"};
+            auto verify_args = include_args(var_map);
+            if (var_map.count("verify-arg") > 0) {
+                auto extra_args = var_map["verify-arg"].as<std::vector<std::string>>();
+                verify_args.insert(verify_args.end(), extra_args.begin(), extra_args.end());
+            }
+
+            rewrite_verifier verifier{var_map["verify-compiler"].as<std::string>(), verify_args};
+            std::size_t new_count = 0;
+            for (auto && report : verifier.verify(all_inputs, res.mods(), graph)) {
+                for (auto && diag : report.new_diagnostics) {
+                    std::cerr << "verify: " << report.tu.string() << ": " << diag << std::endl;
+                    ++new_count;
+                }
+            }
+
+            if (new_count != 0) {
+                std::ostringstream msg;
+                msg << "verification of rewritten sources failed: " << new_count
+                    << " new diagnostics";
+                throw std::runtime_error{msg.str()};
+            }
+        }
+
+        // writing modified sources in place after verification, unchanged sources are
+        // not written to keep their modification times
+        if (in_place) {
+            auto summary = apply_in_place(res.mods());
+            std::cerr << "in-place: " << summary.written << " files written, "
+                      << summary.unchanged << " unchanged files skipped" << std::endl;
+        }
+
+        // reporting failed shards after results of other shards are printed
+        if (!shard_errors.empty()) {
+            std::ostringstream msg;
+            for (auto && err : shard_errors) {
+                msg << (msg.view().empty() ? "" : "\n") << err;
+            }
+
+            throw std::runtime_error{msg.str()};
+        }
+
+        // writing execution statistics
+        if (var_map.count("stats") > 0) {
+            write_stats(var_map["stats"].as<fs::path>());
+        }
+
+        // writing memory report
+        if (var_map.count("memory-report") > 0) {
+            write_memory_report(var_map["memory-report"].as<fs::path>());
+        }
+
+        // writing trace events
+        if (var_map.count("trace-file") > 0) {
+            trace_recorder::global().set_enabled(false);
+            write_trace(var_map["trace-file"].as<fs::path>());
+        }
+
+        if (partial) {
+            std::cerr << "WARNING: " << cancellation_reason(token) << ", results are partial: "
+                      << refactor_stats::global().get(stats_counter::tus_cancelled)
+                      << " translation units were not processed" << std::endl;
+            return 3;
+        }
     }
     catch (std::exception & err) {
         std::cerr << "ERROR: " << err.what() << std::endl;
@@ -0,0 +1,58 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file mapped_file.cpp
+/// Contains implementation of the mapped_file class.
+
+#include "mapped_file.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+mapped_file::mapped_file(const std::filesystem::path & p) {
+    auto fd = open(p.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::ostringstream msg;
+        msg << "can't open input file " << p << " for reading";
+        throw std::runtime_error{msg.str()};
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        std::ostringstream msg;
+        msg << "can't get size of file " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    // empty files can't be mapped, they are represented by empty text
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ != 0) {
+        auto addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            close(fd);
+            std::ostringstream msg;
+            msg << "can't map file " << p << " into memory";
+            throw std::runtime_error{msg.str()};
+        }
+
+        madvise(addr, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(addr);
+    }
+
+    close(fd);
+}
+
+
+mapped_file::~mapped_file() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char *>(data_), size_);
+    }
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file mapped_file.hpp
+/// Contains definition of the mapped_file class.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+
+/// Modification time and size of file, used for detecting file changes
+struct file_stamp {
+    bool exists = false;                    ///< File exists
+    std::int64_t mtime = 0;                 ///< Modification time in file clock ticks
+    std::uintmax_t size = 0;                ///< File size
+
+    /// Returns stamp of file located at specified path
+    static file_stamp of(const std::filesystem::path & p) {
+        std::error_code ec;
+        file_stamp res;
+        auto t = std::filesystem::last_write_time(p, ec);
+        if (ec) {
+            return res;
+        }
+
+        auto size = std::filesystem::file_size(p, ec);
+        if (ec) {
+            return res;
+        }
+
+        res.exists = true;
+        res.mtime = static_cast<std::int64_t>(t.time_since_epoch().count());
+        res.size = size;
+        return res;
+    }
+
+    /// Returns true if stamps are equal
+    bool operator==(const file_stamp &) const = default;
+};
+
+
+/// Read only memory mapping of whole file
+class mapped_file {
+public:
+    /// Maps file located at specified path into memory. Throws exception if file
+    /// can't be opened or mapped
+    explicit mapped_file(const std::filesystem::path & p);
+
+    /// Unmaps file
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file & operator=(const mapped_file &) = delete;
+
+    /// Returns contents of mapped file
+    std::string_view text() const { return {data_, size_}; }
+
+private:
+    const char * data_ = nullptr;           ///< Address of mapping
+    std::size_t size_ = 0;                  ///< Size of mapping
+};
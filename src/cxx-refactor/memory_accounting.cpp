@@ -0,0 +1,194 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file memory_accounting.cpp
+/// Contains implementation of the memory_accounting class.
+
+#include "memory_accounting.hpp"
+#include "json_writer.hpp"
+#include "memory_arena.hpp"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+
+const char * memory_subsystem_name(memory_subsystem s) {
+    switch (s) {
+    case memory_subsystem::other:           return "other";
+    case memory_subsystem::code_model:      return "code_model";
+    case memory_subsystem::modifications:   return "modifications";
+    case memory_subsystem::output:          return "output";
+    case memory_subsystem::count_:          break;
+    }
+
+    return "unknown";
+}
+
+
+memory_accounting::totals memory_accounting::subsystem_totals(memory_subsystem s) {
+    auto & cnt = counters_[static_cast<std::size_t>(s)];
+    totals res;
+    res.allocations = cnt.allocations.load(std::memory_order_relaxed);
+    res.allocated_bytes = cnt.allocated_bytes.load(std::memory_order_relaxed);
+    res.frees = cnt.frees.load(std::memory_order_relaxed);
+    res.freed_bytes = cnt.freed_bytes.load(std::memory_order_relaxed);
+    return res;
+}
+
+
+memory_accounting::totals memory_accounting::all_totals() {
+    totals res;
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+        auto t = subsystem_totals(static_cast<memory_subsystem>(i));
+        res.allocations += t.allocations;
+        res.allocated_bytes += t.allocated_bytes;
+        res.frees += t.frees;
+        res.freed_bytes += t.freed_bytes;
+    }
+
+    return res;
+}
+
+
+/// Returns peak resident set size since last reset of peak in kilobytes
+static std::uint64_t rss_high_water_kb() {
+    std::ifstream istr{"/proc/self/status"};
+    std::string key;
+    while (istr >> key) {
+        if (key == "VmHWM:") {
+            std::uint64_t kb = 0;
+            istr >> kb;
+            return kb;
+        }
+
+        istr.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    // falling back to peak of process lifetime
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+}
+
+
+std::uint64_t memory_accounting::peak_rss_kb() {
+    std::lock_guard lock{peak_mtx_};
+    return std::max(peak_before_reset_kb_, rss_high_water_kb());
+}
+
+
+void memory_accounting::begin_peak_rss() {
+    std::lock_guard lock{peak_mtx_};
+    if (peak_phases_++ != 0) {
+        return;
+    }
+
+    // writing "5" to clear_refs resets peak resident set size to current one,
+    // peak of process is remembered before reset
+    peak_before_reset_kb_ = std::max(peak_before_reset_kb_, rss_high_water_kb());
+    std::ofstream ostr{"/proc/self/clear_refs"};
+    ostr << "5";
+}
+
+
+std::uint64_t memory_accounting::end_peak_rss() {
+    std::lock_guard lock{peak_mtx_};
+    --peak_phases_;
+    return rss_high_water_kb();
+}
+
+
+std::uint64_t memory_accounting::current_rss_kb() {
+    std::ifstream istr{"/proc/self/statm"};
+    std::uint64_t size = 0;
+    std::uint64_t resident = 0;
+    if (!(istr >> size >> resident)) {
+        return 0;
+    }
+
+    return resident * static_cast<std::uint64_t>(sysconf(_SC_PAGESIZE)) / 1024;
+}
+
+
+void memory_accounting::add_phase(const std::string & name, const phase_usage & usage) {
+    arena_suspend no_arena;
+    std::lock_guard lock{phases_mtx_};
+    auto & ph = phases_[name];
+    ph.count += usage.count;
+    ph.allocations += usage.allocations;
+    ph.allocated_bytes += usage.allocated_bytes;
+    ph.peak_rss_kb = std::max(ph.peak_rss_kb, usage.peak_rss_kb);
+}
+
+
+/// Writes allocation totals as members of current JSON object
+static void write_totals(json_writer & wr, const memory_accounting::totals & t) {
+    wr.member("allocations", t.allocations);
+    wr.member("allocated_bytes", t.allocated_bytes);
+    wr.member("frees", t.frees);
+    wr.member("freed_bytes", t.freed_bytes);
+}
+
+
+void memory_accounting::write_json(std::ostream & ostr) {
+    json_writer wr{ostr};
+    wr.begin_object();
+    wr.member("peak_rss_kb", peak_rss_kb());
+    wr.member("current_rss_kb", current_rss_kb());
+
+    wr.key("total").begin_object();
+    write_totals(wr, all_totals());
+    wr.end_object();
+
+    wr.key("subsystems").begin_object();
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+        auto s = static_cast<memory_subsystem>(i);
+        wr.key(memory_subsystem_name(s)).begin_object();
+        write_totals(wr, subsystem_totals(s));
+        wr.end_object();
+    }
+    wr.end_object();
+
+    wr.key("phases").begin_object();
+    {
+        std::lock_guard lock{phases_mtx_};
+        for (auto && [name, usage] : phases_) {
+            wr.key(name).begin_object();
+            wr.member("count", usage.count);
+            wr.member("allocations", usage.allocations);
+            wr.member("allocated_bytes", usage.allocated_bytes);
+            wr.member("peak_rss_kb", usage.peak_rss_kb);
+            wr.end_object();
+        }
+    }
+    wr.end_object();
+
+    // arena allocation statistics
+    auto arena = memory_arena::all_totals();
+    wr.key("arena").begin_object();
+    wr.member("arenas", arena.arenas);
+    wr.member("allocations", arena.allocations);
+    wr.member("requested_bytes", arena.requested_bytes);
+    wr.member("used_bytes", arena.used_bytes);
+    wr.member("committed_bytes", arena.committed_bytes);
+
+    // fraction of committed memory not used by requested blocks
+    double fragmentation = arena.committed_bytes == 0 ? 0.0 :
+        1.0 - static_cast<double>(arena.requested_bytes) /
+              static_cast<double>(arena.committed_bytes);
+    wr.member("fragmentation", fragmentation);
+    wr.member("release_ms", static_cast<double>(arena.release_ns) / 1e6);
+    wr.end_object();
+
+    wr.end_object();
+    ostr << std::endl;
+}
@@ -0,0 +1,231 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file memory_accounting.hpp
+/// Contains definitions of the memory_accounting, memory_scope and memory_phase classes.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <malloc.h>
+
+
+/// Subsystems for which allocations are accounted separately
+enum class memory_subsystem: std::uint8_t {
+    other,                                  ///< Allocations not attributed to any subsystem
+    code_model,                             ///< Code model construction
+    modifications,                          ///< Source modifications collection
+    output,                                 ///< Output buffers
+    count_                                  ///< Number of subsystems
+};
+
+
+/// Returns name of memory subsystem
+const char * memory_subsystem_name(memory_subsystem s);
+
+
+/// Allocation counters of single memory subsystem
+struct memory_counters {
+    std::atomic<std::uint64_t> allocations{0};          ///< Number of allocations
+    std::atomic<std::uint64_t> allocated_bytes{0};      ///< Number of allocated bytes
+    std::atomic<std::uint64_t> frees{0};                ///< Number of deallocations
+    std::atomic<std::uint64_t> freed_bytes{0};          ///< Number of freed bytes
+};
+
+
+/// Accounting of dynamic memory allocations. Allocations are counted by global
+/// operator new/delete replacements (see memory_hooks.cpp) when accounting is enabled.
+/// Accounting is disabled by default, disabled hooks cost a single relaxed load.
+class memory_accounting {
+public:
+    /// Allocation totals
+    struct totals {
+        std::uint64_t allocations = 0;      ///< Number of allocations
+        std::uint64_t allocated_bytes = 0;  ///< Number of allocated bytes
+        std::uint64_t frees = 0;            ///< Number of deallocations
+        std::uint64_t freed_bytes = 0;      ///< Number of freed bytes
+    };
+
+    /// Memory usage of execution phase
+    struct phase_usage {
+        std::uint64_t count = 0;            ///< Number of times phase was executed
+        std::uint64_t allocations = 0;      ///< Number of allocations in phase
+        std::uint64_t allocated_bytes = 0;  ///< Number of bytes allocated in phase
+        std::uint64_t peak_rss_kb = 0;      ///< Peak resident set size during phase
+    };
+
+    /// Enables or disables accounting
+    static void set_enabled(bool en) { enabled_.store(en, std::memory_order_relaxed); }
+
+    /// Returns true if accounting is enabled
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    /// Accounts allocation of memory block
+    static void on_alloc(void * p) noexcept {
+        if (enabled() && p != nullptr) {
+            on_alloc_bytes(malloc_usable_size(p));
+        }
+    }
+
+    /// Accounts allocation of memory block with specified size
+    static void on_alloc_bytes(std::size_t sz) noexcept {
+        if (enabled()) {
+            auto & cnt = counters_[static_cast<std::size_t>(current_)];
+            cnt.allocations.fetch_add(1, std::memory_order_relaxed);
+            cnt.allocated_bytes.fetch_add(sz, std::memory_order_relaxed);
+
+            if (auto ph = current_phase_) {
+                ph->allocations.fetch_add(1, std::memory_order_relaxed);
+                ph->allocated_bytes.fetch_add(sz, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Accounts deallocation of memory block
+    static void on_free(void * p) noexcept {
+        if (enabled() && p != nullptr) {
+            auto & cnt = counters_[static_cast<std::size_t>(current_)];
+            cnt.frees.fetch_add(1, std::memory_order_relaxed);
+            cnt.freed_bytes.fetch_add(malloc_usable_size(p), std::memory_order_relaxed);
+        }
+    }
+
+    /// Returns subsystem to which allocations of current thread are attributed
+    static memory_subsystem current_subsystem() { return current_; }
+
+    /// Sets subsystem to which allocations of current thread are attributed
+    static void set_current_subsystem(memory_subsystem s) { current_ = s; }
+
+    /// Returns counters of phase to which allocations of current thread are attributed
+    /// or nullptr if current thread doesn't execute any phase
+    static memory_counters * current_phase() { return current_phase_; }
+
+    /// Sets counters of phase to which allocations of current thread are attributed
+    static void set_current_phase(memory_counters * ph) { current_phase_ = ph; }
+
+    /// Returns allocation totals of subsystem
+    static totals subsystem_totals(memory_subsystem s);
+
+    /// Returns allocation totals of all subsystems
+    static totals all_totals();
+
+    /// Returns peak resident set size of process in kilobytes
+    static std::uint64_t peak_rss_kb();
+
+    /// Starts measurement of peak resident set size of phase. Peak of process is reset
+    /// if no other phase is measured, so peak of phase includes only phases which
+    /// overlap with it in time
+    static void begin_peak_rss();
+
+    /// Finishes measurement of peak resident set size of phase and returns peak
+    /// in kilobytes
+    static std::uint64_t end_peak_rss();
+
+    /// Returns current resident set size of process in kilobytes
+    static std::uint64_t current_rss_kb();
+
+    /// Adds memory usage of execution phase with specified name
+    static void add_phase(const std::string & name, const phase_usage & usage);
+
+    /// Writes memory report in JSON format to output stream
+    static void write_json(std::ostream & ostr);
+
+private:
+    static inline constinit std::atomic<bool> enabled_{false};
+    static inline constinit thread_local memory_subsystem current_{memory_subsystem::other};
+    static inline constinit thread_local memory_counters * current_phase_{nullptr};
+    static inline std::mutex peak_mtx_;
+    static inline std::size_t peak_phases_{0};
+    static inline std::uint64_t peak_before_reset_kb_{0};
+    static inline std::array<memory_counters,
+                             static_cast<std::size_t>(memory_subsystem::count_)> counters_;
+    static inline std::mutex phases_mtx_;
+    static inline std::map<std::string, phase_usage> phases_;
+};
+
+
+/// Scoped attribution of allocations of current thread to memory subsystem
+class memory_scope {
+public:
+    /// Attributes allocations to specified subsystem
+    explicit memory_scope(memory_subsystem s):
+    prev_{memory_accounting::current_subsystem()},
+    prev_phase_{memory_accounting::current_phase()} {
+        memory_accounting::set_current_subsystem(s);
+    }
+
+    /// Attributes allocations to specified subsystem and phase counters, used by tasks
+    /// executed on behalf of another thread
+    explicit memory_scope(memory_subsystem s, memory_counters * phase):
+    memory_scope{s} {
+        memory_accounting::set_current_phase(phase);
+    }
+
+    /// Restores previous subsystem and phase
+    ~memory_scope() {
+        memory_accounting::set_current_subsystem(prev_);
+        memory_accounting::set_current_phase(prev_phase_);
+    }
+
+    memory_scope(const memory_scope &) = delete;
+    memory_scope & operator=(const memory_scope &) = delete;
+
+private:
+    memory_subsystem prev_;                 ///< Previous subsystem
+    memory_counters * prev_phase_;          ///< Previous phase counters
+};
+
+
+/// Scoped memory usage measurement of execution phase. Does nothing if accounting
+/// is disabled. Phase counts allocations of current thread and of tasks it runs in
+/// thread pool while phase is active, so phases executed concurrently by other threads
+/// are not counted. Allocations of nested phases are counted by enclosing phase too
+class memory_phase {
+public:
+    /// Starts measurement of phase with specified name (must be string literal)
+    explicit memory_phase(const char * name):
+    name_{memory_accounting::enabled() ? name : nullptr} {
+        if (name_) {
+            parent_ = memory_accounting::current_phase();
+            memory_accounting::set_current_phase(&counters_);
+            memory_accounting::begin_peak_rss();
+        }
+    }
+
+    /// Finishes measurement and adds phase usage to report
+    ~memory_phase() {
+        if (name_) {
+            memory_accounting::set_current_phase(parent_);
+
+            memory_accounting::phase_usage usage;
+            usage.count = 1;
+            usage.allocations = counters_.allocations.load(std::memory_order_relaxed);
+            usage.allocated_bytes = counters_.allocated_bytes.load(std::memory_order_relaxed);
+            usage.peak_rss_kb = memory_accounting::end_peak_rss();
+            memory_accounting::add_phase(name_, usage);
+
+            if (parent_) {
+                parent_->allocations.fetch_add(usage.allocations, std::memory_order_relaxed);
+                parent_->allocated_bytes.fetch_add(usage.allocated_bytes,
+                                                   std::memory_order_relaxed);
+            }
+        }
+    }
+
+    memory_phase(const memory_phase &) = delete;
+    memory_phase & operator=(const memory_phase &) = delete;
+
+private:
+    const char * name_;                     ///< Phase name or nullptr if accounting is disabled
+    memory_counters counters_;              ///< Allocations of phase
+    memory_counters * parent_ = nullptr;    ///< Counters of enclosing phase
+};
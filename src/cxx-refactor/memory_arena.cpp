@@ -0,0 +1,114 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file memory_arena.cpp
+/// Contains implementation of the memory_arena class.
+
+#include "memory_arena.hpp"
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+
+
+/// Indices of aggregated statistics
+enum totals_idx {
+    arenas_idx,
+    allocations_idx,
+    requested_idx,
+    used_idx,
+    committed_idx,
+    release_ns_idx
+};
+
+
+memory_arena::memory_arena(const arena_options & opts) {
+    auto addr = mmap(nullptr, opts.reserve_bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (addr == MAP_FAILED) {
+        std::ostringstream msg;
+        msg << "can't reserve " << opts.reserve_bytes << " bytes for memory arena (with "
+            << "strict overcommit accounting reservation must be reduced with --arena-reserve)";
+        throw std::runtime_error{msg.str()};
+    }
+
+#ifdef MADV_HUGEPAGE
+    if (opts.huge_pages) {
+        madvise(addr, opts.reserve_bytes, MADV_HUGEPAGE);
+    }
+#endif
+
+    begin_ = reinterpret_cast<std::uintptr_t>(addr);
+    cur_ = begin_;
+    end_ = begin_ + opts.reserve_bytes;
+
+    // registering region in the first free slot: slot is reserved first,
+    // then region bounds are published
+    for (auto && reg : regions_) {
+        std::uintptr_t expected = 0;
+        if (reg.begin.compare_exchange_strong(expected, reserved_region,
+                                              std::memory_order_acquire)) {
+            reg.end.store(end_, std::memory_order_relaxed);
+            reg.begin.store(begin_, std::memory_order_release);
+            region_ = &reg;
+            break;
+        }
+    }
+
+    if (region_ == nullptr) {
+        munmap(addr, opts.reserve_bytes);
+        throw std::runtime_error{"too many live memory arenas"};
+    }
+
+    live_count_.fetch_add(1, std::memory_order_release);
+}
+
+
+memory_arena::~memory_arena() {
+    release();
+}
+
+
+void memory_arena::release() noexcept {
+    if (region_ == nullptr) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto page = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto committed = (cur_ - begin_ + page - 1) / page * page;
+
+    region_->begin.store(0, std::memory_order_release);
+    live_count_.fetch_sub(1, std::memory_order_release);
+    region_ = nullptr;
+    munmap(reinterpret_cast<void*>(begin_), end_ - begin_);
+
+    auto end = std::chrono::steady_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    totals_[arenas_idx].fetch_add(1, std::memory_order_relaxed);
+    totals_[allocations_idx].fetch_add(allocations_, std::memory_order_relaxed);
+    totals_[requested_idx].fetch_add(requested_bytes_, std::memory_order_relaxed);
+    totals_[used_idx].fetch_add(cur_ - begin_, std::memory_order_relaxed);
+    totals_[committed_idx].fetch_add(committed, std::memory_order_relaxed);
+    totals_[release_ns_idx].fetch_add(static_cast<std::uint64_t>(ns), std::memory_order_relaxed);
+
+    begin_ = cur_ = end_ = 0;
+}
+
+
+memory_arena::totals memory_arena::all_totals() {
+    totals res;
+    res.arenas = totals_[arenas_idx].load(std::memory_order_relaxed);
+    res.allocations = totals_[allocations_idx].load(std::memory_order_relaxed);
+    res.requested_bytes = totals_[requested_idx].load(std::memory_order_relaxed);
+    res.used_bytes = totals_[used_idx].load(std::memory_order_relaxed);
+    res.committed_bytes = totals_[committed_idx].load(std::memory_order_relaxed);
+    res.release_ns = totals_[release_ns_idx].load(std::memory_order_relaxed);
+    return res;
+}
@@ -0,0 +1,177 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file memory_arena.hpp
+/// Contains definition of the memory_arena class.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+
+/// Options of arena allocation mode
+struct arena_options {
+    bool enabled = false;                   ///< Allocate code models in arenas
+    bool huge_pages = false;                ///< Back arenas with transparent huge pages
+    std::size_t reserve_bytes = std::size_t{4} << 30;   ///< Reserved size of each arena
+};
+
+
+/// Registered region of live memory arena
+struct memory_arena_region {
+    std::atomic<std::uintptr_t> begin{0};   ///< Region start, 0 if slot is free
+    std::atomic<std::uintptr_t> end{0};     ///< Region end
+};
+
+
+/// Monotonic memory arena in reserved region of virtual memory. Blocks are allocated
+/// by bumping pointer and are never freed individually, whole arena is released in
+/// one step. While arena is current for a thread, global operator new of that thread
+/// allocates from arena (see memory_hooks.cpp) and operator delete of any thread
+/// ignores blocks located in live arenas. Objects allocated in arena must not be
+/// accessed after arena is released.
+///
+/// Arena mode is experimental: every allocation of thread is redirected, so any object
+/// outliving arena which is first allocated while arena is current (lazily created
+/// statics of libraries, growing long-lived containers) is left dangling. Arena scopes
+/// must be kept as narrow as possible, and tool-owned long-lived state must be updated
+/// under arena_suspend.
+class memory_arena {
+public:
+    /// Aggregated statistics of all arenas
+    struct totals {
+        std::uint64_t arenas = 0;           ///< Number of released arenas
+        std::uint64_t allocations = 0;      ///< Number of allocated blocks
+        std::uint64_t requested_bytes = 0;  ///< Number of requested bytes
+        std::uint64_t used_bytes = 0;       ///< Number of used bytes including alignment
+        std::uint64_t committed_bytes = 0;  ///< Number of bytes in touched pages
+        std::uint64_t release_ns = 0;       ///< Time spent releasing arenas
+    };
+
+    /// Reserves arena region with specified options
+    explicit memory_arena(const arena_options & opts = {});
+
+    /// Releases arena if it is not released yet
+    ~memory_arena();
+
+    memory_arena(const memory_arena &) = delete;
+    memory_arena & operator=(const memory_arena &) = delete;
+
+    /// Allocates block with specified size and alignment. Returns nullptr if arena
+    /// is exhausted or released. Must be called only by thread owning arena
+    void * allocate(std::size_t sz, std::size_t align) noexcept {
+        auto p = (cur_ + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1);
+        if (p + sz > end_ || p < cur_) {
+            return nullptr;
+        }
+
+        cur_ = p + sz;
+        ++allocations_;
+        requested_bytes_ += sz;
+        return reinterpret_cast<void*>(p);
+    }
+
+    /// Releases all memory of arena at once
+    void release() noexcept;
+
+    /// Returns number of allocated blocks
+    std::uint64_t allocations() const { return allocations_; }
+
+    /// Returns number of requested bytes
+    std::uint64_t requested_bytes() const { return requested_bytes_; }
+
+    /// Returns number of used bytes including alignment padding
+    std::uint64_t used_bytes() const { return cur_ - begin_; }
+
+    /// Returns true if pointer is located in any live arena
+    static bool owns(const void * p) noexcept {
+        if (live_count_.load(std::memory_order_acquire) == 0) {
+            return false;
+        }
+
+        auto addr = reinterpret_cast<std::uintptr_t>(p);
+        for (auto && reg : regions_) {
+            auto begin = reg.begin.load(std::memory_order_acquire);
+            if (begin > reserved_region && addr >= begin &&
+                addr < reg.end.load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /// Returns arena current for calling thread or nullptr
+    static memory_arena * current() noexcept { return current_; }
+
+    /// Sets arena current for calling thread
+    static void set_current(memory_arena * arena) noexcept { current_ = arena; }
+
+    /// Returns aggregated statistics of released arenas
+    static totals all_totals();
+
+private:
+    /// Maximal number of simultaneously live arenas
+    static constexpr std::size_t max_arenas = 64;
+
+    /// Value of region start marking slot reserved by arena being registered
+    static constexpr std::uintptr_t reserved_region = 1;
+
+    std::uintptr_t begin_ = 0;              ///< Start of reserved region
+    std::uintptr_t cur_ = 0;                ///< Current allocation pointer
+    std::uintptr_t end_ = 0;                ///< End of reserved region
+    memory_arena_region * region_ = nullptr;             ///< Registry slot of arena
+    std::uint64_t allocations_ = 0;         ///< Number of allocated blocks
+    std::uint64_t requested_bytes_ = 0;     ///< Number of requested bytes
+
+    static inline constinit thread_local memory_arena * current_ = nullptr;
+    static inline constinit std::atomic<std::size_t> live_count_{0};
+    static inline constinit std::array<memory_arena_region, max_arenas> regions_{};
+    static inline constinit std::array<std::atomic<std::uint64_t>, 6> totals_{};
+};
+
+
+/// Scoped redirection of allocations of calling thread to arena
+class arena_scope {
+public:
+    /// Makes arena current for calling thread
+    explicit arena_scope(memory_arena & arena): prev_{memory_arena::current()} {
+        memory_arena::set_current(&arena);
+    }
+
+    /// Restores previous arena
+    ~arena_scope() { memory_arena::set_current(prev_); }
+
+    arena_scope(const arena_scope &) = delete;
+    arena_scope & operator=(const arena_scope &) = delete;
+
+private:
+    memory_arena * prev_;                   ///< Previous current arena
+};
+
+
+/// Scoped suspension of arena of calling thread. Allocations of long-lived objects
+/// owned by tool (trace buffers, statistics, task queues) are made under this scope,
+/// so they are allocated in regular heap even if they happen inside arena scope
+class arena_suspend {
+public:
+    /// Suspends current arena
+    explicit arena_suspend(): prev_{memory_arena::current()} {
+        memory_arena::set_current(nullptr);
+    }
+
+    /// Restores suspended arena
+    ~arena_suspend() { memory_arena::set_current(prev_); }
+
+    arena_suspend(const arena_suspend &) = delete;
+    arena_suspend & operator=(const arena_suspend &) = delete;
+
+private:
+    memory_arena * prev_;                   ///< Suspended arena
+};
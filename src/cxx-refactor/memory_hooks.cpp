@@ -0,0 +1,129 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file memory_hooks.cpp
+/// Contains replacements of global operators new and delete which account
+/// allocations in memory_accounting and allocate from current memory arena of thread.
+/// Must be linked into executables directly.
+
+#include "memory_accounting.hpp"
+#include "memory_arena.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+
+/// Allocates memory block from current arena of thread. Returns nullptr if there is
+/// no current arena or arena is exhausted
+static void * arena_alloc(std::size_t sz, std::size_t align) noexcept {
+    if (auto arena = memory_arena::current()) {
+        if (auto p = arena->allocate(std::max<std::size_t>(sz, 1), align)) {
+            memory_accounting::on_alloc_bytes(sz);
+            return p;
+        }
+    }
+
+    return nullptr;
+}
+
+
+/// Allocates memory block and accounts allocation. Returns nullptr on failure
+static void * hooked_alloc(std::size_t sz) noexcept {
+    if (auto p = arena_alloc(sz, __STDCPP_DEFAULT_NEW_ALIGNMENT__)) {
+        return p;
+    }
+
+    auto p = std::malloc(sz != 0 ? sz : 1);
+    memory_accounting::on_alloc(p);
+    return p;
+}
+
+
+/// Allocates aligned memory block and accounts allocation. Returns nullptr on failure
+static void * hooked_aligned_alloc(std::size_t sz, std::align_val_t al) noexcept {
+    auto align = static_cast<std::size_t>(al);
+    if (auto p = arena_alloc(sz, align)) {
+        return p;
+    }
+
+    auto p = std::aligned_alloc(align, (std::max<std::size_t>(sz, 1) + align - 1) / align * align);
+    memory_accounting::on_alloc(p);
+    return p;
+}
+
+
+/// Accounts deallocation and frees memory block. Blocks located in arenas
+/// are released together with arena
+static void hooked_free(void * p) noexcept {
+    if (memory_arena::owns(p)) {
+        return;
+    }
+
+    memory_accounting::on_free(p);
+    std::free(p);
+}
+
+
+void * operator new(std::size_t sz) {
+    if (auto p = hooked_alloc(sz)) {
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void * operator new[](std::size_t sz) {
+    if (auto p = hooked_alloc(sz)) {
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void * operator new(std::size_t sz, std::align_val_t al) {
+    if (auto p = hooked_aligned_alloc(sz, al)) {
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void * operator new[](std::size_t sz, std::align_val_t al) {
+    if (auto p = hooked_aligned_alloc(sz, al)) {
+        return p;
+    }
+
+    throw std::bad_alloc{};
+}
+
+
+void * operator new(std::size_t sz, const std::nothrow_t &) noexcept { return hooked_alloc(sz); }
+void * operator new[](std::size_t sz, const std::nothrow_t &) noexcept { return hooked_alloc(sz); }
+
+void * operator new(std::size_t sz, std::align_val_t al, const std::nothrow_t &) noexcept {
+    return hooked_aligned_alloc(sz, al);
+}
+
+void * operator new[](std::size_t sz, std::align_val_t al, const std::nothrow_t &) noexcept {
+    return hooked_aligned_alloc(sz, al);
+}
+
+
+void operator delete(void * p) noexcept { hooked_free(p); }
+void operator delete[](void * p) noexcept { hooked_free(p); }
+void operator delete(void * p, std::size_t) noexcept { hooked_free(p); }
+void operator delete[](void * p, std::size_t) noexcept { hooked_free(p); }
+void operator delete(void * p, std::align_val_t) noexcept { hooked_free(p); }
+void operator delete[](void * p, std::align_val_t) noexcept { hooked_free(p); }
+void operator delete(void * p, std::size_t, std::align_val_t) noexcept { hooked_free(p); }
+void operator delete[](void * p, std::size_t, std::align_val_t) noexcept { hooked_free(p); }
+void operator delete(void * p, const std::nothrow_t &) noexcept { hooked_free(p); }
+void operator delete[](void * p, const std::nothrow_t &) noexcept { hooked_free(p); }
+void operator delete(void * p, std::align_val_t, const std::nothrow_t &) noexcept { hooked_free(p); }
+void operator delete[](void * p, std::align_val_t, const std::nothrow_t &) noexcept { hooked_free(p); }
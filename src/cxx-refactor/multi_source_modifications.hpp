@@ -9,25 +9,95 @@
 
 #pragma once
 
+#include "line_index_table.hpp"
 #include "single_source_modifications.hpp"
+#include "source_path_table.hpp"
 #include <filesystem>
+#include <optional>
 
 
-/// Modifications in multiple source files
+/// Modifications in multiple source files. Source files are identified by
+/// identifiers of canonical paths interned in global source path table, so
+/// different spellings of the same file share one list of modifications
 class multi_source_modifications {
 public:
     /// Constructs object
     explicit multi_source_modifications() = default;
 
-    /// Adds modification for specified source file
-    void add(const std::filesystem::path & src_path, const source_modification & mod) {
-        mods_[src_path].add(mod);
+    /// Adds line/column modification for source file with specified identifier.
+    /// Modification is converted to offsets with line index of source file from
+    /// global index table
+    void add(file_id file, const source_modification & mod) {
+        auto it = mods_.find(file);
+        if (it == mods_.end()) {
+            auto idx = line_index_table::global().get(path(file));
+            it = mods_.emplace(file, single_source_modifications{std::move(idx)}).first;
+        }
+
+        it->second.add(mod);
+    }
+
+    /// Adds modification for source file with specified identifier
+    void add(file_id file, const compact_modification & mod) {
+        mods_[file].add(mod);
+    }
+
+    /// Adds all modifications for source file with specified identifier
+    void add(file_id file, single_source_modifications && smods) {
+        auto [it, inserted] = mods_.try_emplace(file, std::move(smods));
+        if (!inserted) {
+            for (auto && mod : smods.mods()) {
+                it->second.add(mod);
+            }
+        }
+    }
+
+    /// Adds modification or modifications for source file with specified path
+    template <typename Mods>
+    void add(const std::filesystem::path & src_path, Mods && mods) {
+        add(source_path_table::global().intern(src_path), std::forward<Mods>(mods));
+    }
+
+    /// Merges modifications from another set. Identical modifications of the same
+    /// source are merged into one
+    void merge(multi_source_modifications && other) {
+        for (auto && [file, smods] : other.mods_) {
+            auto [it, inserted] = mods_.try_emplace(file, std::move(smods));
+            if (!inserted) {
+                it->second.merge(smods);
+            }
+        }
     }
 
-    /// Returns const reference to map of all modifications
+    /// Returns true if there are no modifications
+    bool empty() const { return mods_.empty(); }
+
+    /// Returns const reference to map of all modifications keyed by file identifiers
     auto & mods() const { return mods_; }
 
+    /// Returns modifications of source file with specified path or nullptr
+    const single_source_modifications * find(const std::filesystem::path & src_path) const {
+        auto it = mods_.find(source_path_table::global().intern(src_path));
+        return it != mods_.end() ? &it->second : nullptr;
+    }
+
+    /// Removes modifications of source file with specified identifier and returns them.
+    /// Returns nullopt if there are no modifications of source file
+    std::optional<single_source_modifications> take(file_id file) {
+        auto node = mods_.extract(file);
+        if (node.empty()) {
+            return std::nullopt;
+        }
+
+        return std::move(node.mapped());
+    }
+
+    /// Returns canonical path of source file with specified identifier
+    static const std::filesystem::path & path(file_id file) {
+        return source_path_table::global().path(file);
+    }
+
 private:
     /// Map of modifications for all source files
-    std::map<std::filesystem::path, single_source_modifications> mods_;
+    std::map<file_id, single_source_modifications> mods_;
 };
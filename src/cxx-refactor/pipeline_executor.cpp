@@ -0,0 +1,311 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file pipeline_executor.cpp
+/// Contains implementation of the pipeline_executor class.
+
+#include "pch.hpp"
+#include "pipeline_executor.hpp"
+#include "bounded_queue.hpp"
+#include "cancellation.hpp"
+#include "refactor_stats.hpp"
+#include "source_rewriter.hpp"
+#include "streaming_executor.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace fs = std::filesystem;
+
+
+/// Translation unit passed from parse stage to analyze stage
+struct parsed_tu {
+    std::size_t idx;                                        ///< Index of input
+    std::unique_ptr<cm::src::source_code_model> cm;         ///< Code model
+};
+
+
+/// Source passed from analyze stage to rewrite stage
+struct modified_source {
+    file_id file;                                           ///< Source file identifier
+    single_source_modifications mods;                       ///< Source modifications
+};
+
+
+/// Rewritten source passed from rewrite stage to write stage
+struct rewritten_source {
+    file_id file;                                           ///< Source file identifier
+    std::string text;                                       ///< Rewritten text
+};
+
+
+pipeline_executor::pipeline_executor(std::size_t parse_jobs, std::size_t queue_capacity):
+parse_jobs_{parse_jobs == 0 ? thread_pool::global().size() : parse_jobs},
+queue_capacity_{queue_capacity} {}
+
+
+action_result pipeline_executor::run(const refactor_action & action,
+                                     const std::vector<fs::path> & inputs,
+                                     const include_graph & graph,
+                                     const boost::program_options::variables_map & opts,
+                                     std::ostream & ostr) const {
+    bounded_queue<parsed_tu> parsed{queue_capacity_};
+    bounded_queue<modified_source> modified{queue_capacity_};
+    bounded_queue<rewritten_source> rewritten{queue_capacity_};
+
+    // first error of any stage, queues are closed on error to stop all stages
+    std::mutex err_mtx;
+    std::exception_ptr err;
+    auto fail = [&](std::exception_ptr e) {
+        {
+            std::lock_guard lock{err_mtx};
+            if (!err) {
+                err = e;
+            }
+        }
+
+        parsed.close();
+        modified.close();
+        rewritten.close();
+    };
+
+    // write stage: header with source path is written before each source if
+    // multiple sources are modified, so the first source is held until the second one
+    std::jthread writer{[&]() {
+        try {
+            std::optional<rewritten_source> first;
+            std::size_t count = 0;
+            auto write = [&](const rewritten_source & src) {
+                ostr << "==> " << multi_source_modifications::path(src.file).string()
+                     << " <==" << std::endl;
+                ostr << src.text;
+            };
+
+            while (auto src = rewritten.pop()) {
+                stats_phase phase{"write"};
+                if (++count == 1) {
+                    first = std::move(src);
+                    continue;
+                }
+
+                if (count == 2) {
+                    write(*first);
+                }
+
+                write(*src);
+            }
+
+            if (count == 1) {
+                ostr << first->text;
+            }
+
+            ostr.flush();
+        }
+        catch (...) {
+            fail(std::current_exception());
+        }
+    }};
+
+    // rewrite stage
+    std::jthread rewriter{[&]() {
+        try {
+            source_rewriter rw;
+            while (auto src = modified.pop()) {
+                std::ostringstream text;
+                rw.rewrite(src->mods, multi_source_modifications::path(src->file), text);
+                if (!rewritten.push(rewritten_source{src->file, std::move(text).str()})) {
+                    break;
+                }
+            }
+        }
+        catch (...) {
+            fail(std::current_exception());
+        }
+
+        rewritten.close();
+    }};
+
+    // parse stage, parsers stop taking translation units on cancellation
+    auto token = cancellation_token::current();
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> parsers_left{parse_jobs_};
+    std::vector<std::jthread> parsers;
+    for (std::size_t i = 0; i < parse_jobs_; ++i) {
+        parsers.emplace_back([&, token]() {
+            cancellation_scope cancel_scope{token};
+            try {
+                for (auto idx = next++; idx < inputs.size() && !cancellation_requested(); idx = next++) {
+                    if (!parsed.push(parsed_tu{idx, parse_tu(inputs[idx])})) {
+                        break;
+                    }
+                }
+            }
+            catch (...) {
+                fail(std::current_exception());
+            }
+
+            if (--parsers_left == 0) {
+                parsed.close();
+            }
+        });
+    }
+
+    // analyze stage in calling thread. Number of translation units which are not
+    // merged yet is counted for each file, file is complete when counter drops to zero.
+    // Translation units with unresolved includes may modify any file, so complete files
+    // are held until all such translation units are merged
+    std::vector<std::vector<file_id>> tu_files(inputs.size());
+    std::vector<bool> tu_open(inputs.size());
+    std::unordered_map<file_id, std::size_t> pending_tus;
+    std::size_t open_count = 0;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        tu_files[i] = graph.included_files(inputs[i]);
+        for (auto file : tu_files[i]) {
+            ++pending_tus[file];
+        }
+
+        tu_open[i] = !graph.complete(inputs[i]);
+        if (tu_open[i]) {
+            ++open_count;
+        }
+    }
+
+    std::vector<file_id> complete_files;
+
+    action_result res;
+    std::vector<std::optional<action_result>> pending(inputs.size());
+    std::size_t next_merge = 0;
+    std::size_t found_count = 0;
+    std::size_t merged_count = 0;
+    std::exception_ptr not_found_err;
+    std::unordered_set<file_id> written;
+
+    auto emit = [&](file_id file) {
+        if (auto smods = res.mods().take(file)) {
+            written.insert(file);
+            modified.push(modified_source{file, std::move(*smods)});
+        }
+    };
+
+    // merges result of translation unit with specified index
+    auto merge = [&](std::size_t idx) {
+        for (auto && [file, smods] : pending[idx]->mods().mods()) {
+            if (written.contains(file)) {
+                std::ostringstream msg;
+                msg << "source " << multi_source_modifications::path(file)
+                    << " is modified by translation unit " << inputs[idx]
+                    << " after it was written, it's not found in include graph";
+                throw std::runtime_error{msg.str()};
+            }
+        }
+
+        res.merge(std::move(*pending[idx]));
+        pending[idx].reset();
+        ++merged_count;
+    };
+
+    try {
+        while (auto tu = parsed.pop()) {
+            std::optional<action_result> tu_res;
+            try {
+                stats_phase phase{"action"};
+                tu_res.emplace(action.extract(*tu->cm, opts));
+                ++found_count;
+            }
+            catch (const source_not_found_error &) {
+                if (!not_found_err) {
+                    not_found_err = std::current_exception();
+                }
+
+                tu_res.emplace();
+            }
+            catch (const cancelled_error &) {
+                tu_res.reset();
+            }
+
+            release_tu(std::move(tu->cm));
+            refactor_stats::global().add(stats_counter::tus_processed, 1);
+
+            // merging results in order of inputs and passing complete sources to rewriter.
+            // Translation units interrupted by cancellation produce no result
+            pending[tu->idx] = std::move(tu_res);
+            while (next_merge < pending.size() && pending[next_merge]) {
+                merge(next_merge);
+                if (tu_open[next_merge]) {
+                    --open_count;
+                }
+
+                for (auto file : tu_files[next_merge]) {
+                    if (--pending_tus[file] == 0) {
+                        complete_files.push_back(file);
+                    }
+                }
+
+                if (open_count == 0) {
+                    for (auto file : complete_files) {
+                        emit(file);
+                    }
+
+                    complete_files.clear();
+                }
+
+                ++next_merge;
+            }
+        }
+
+        // merging results of translation units completed before cancellation
+        if (next_merge != inputs.size()) {
+            refactor_stats::global().add(stats_counter::tus_cancelled, inputs.size() - merged_count);
+            if (!partial_) {
+                check_cancelled();
+            }
+
+            for (auto idx = next_merge; idx < inputs.size(); ++idx) {
+                if (pending[idx]) {
+                    merge(idx);
+                }
+            }
+        }
+
+        // passing rest of sources to rewriter in order of paths
+        std::vector<file_id> rest;
+        for (auto && [file, smods] : res.mods().mods()) {
+            rest.push_back(file);
+        }
+
+        std::ranges::sort(rest, [](auto x, auto y) {
+            return multi_source_modifications::path(x) < multi_source_modifications::path(y);
+        });
+
+        for (auto file : rest) {
+            emit(file);
+        }
+    }
+    catch (...) {
+        fail(std::current_exception());
+    }
+
+    modified.close();
+    parsers.clear();
+    rewriter.join();
+    writer.join();
+
+    if (err) {
+        std::rethrow_exception(err);
+    }
+
+    if (found_count == 0 && not_found_err && merged_count == inputs.size()) {
+        std::rethrow_exception(not_found_err);
+    }
+
+    return res;
+}
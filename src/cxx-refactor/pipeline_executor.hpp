@@ -0,0 +1,61 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file pipeline_executor.hpp
+/// Contains definition of the pipeline_executor class.
+
+#pragma once
+
+#include "action_result.hpp"
+#include "include_graph.hpp"
+#include "refactor_action.hpp"
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+
+/// Executes refactor action over multiple translation units in pipelined mode.
+/// Stages are connected by bounded queues and run concurrently:
+///   - parse: parser threads parse translation units into code models;
+///   - analyze: action results are extracted from code models, code models are
+///     released and results are merged in order of inputs;
+///   - rewrite: modified sources are rewritten into memory;
+///   - write: rewritten sources are written to output stream.
+/// Source is passed to rewrite stage as soon as all translation units which include
+/// it according to include graph and all translation units with unresolved includes
+/// are merged, so rewriting and writing overlap with parsing of remaining translation
+/// units. Full queues block preceding stages, which bounds number of code models and
+/// rewritten sources kept in memory.
+///
+/// Parsers stop taking translation units after cancellation token of calling thread
+/// is cancelled. Results of completed translation units are written in partial mode,
+/// otherwise cancelled_error is thrown.
+class pipeline_executor {
+public:
+    /// Constructs executor with specified number of parser threads and capacity
+    /// of queues between stages. Zero number of parser threads means number of
+    /// threads of global thread pool
+    explicit pipeline_executor(std::size_t parse_jobs = 0, std::size_t queue_capacity = 2);
+
+    /// Sets partial mode, in which results completed before cancellation are written
+    void set_partial(bool partial) { partial_ = partial; }
+
+    /// Runs action over translation units and writes modified sources to output stream.
+    /// Include graph must be updated for all translation units. Returns result with
+    /// messages of action, modifications are removed from result when they are written.
+    /// Translation units which do not contain source referenced by action arguments
+    /// are skipped, error is reported only if all translation units are skipped
+    action_result run(const refactor_action & action,
+                      const std::vector<std::filesystem::path> & inputs,
+                      const include_graph & graph,
+                      const boost::program_options::variables_map & opts,
+                      std::ostream & ostr) const;
+
+private:
+    std::size_t parse_jobs_;                ///< Number of parser threads
+    std::size_t queue_capacity_;            ///< Capacity of queues between stages
+    bool partial_ = false;                  ///< Write partial results on cancellation
+};
@@ -9,11 +9,24 @@
 
 #pragma once
 
+#include "action_result.hpp"
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <cm/src/cmsrc.hpp>
 #include <boost/program_options.hpp>
 
 
+/// Exception thrown when source file referenced by action arguments is not
+/// a part of code model
+class source_not_found_error: public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+
 class refactor_action {
 public:
     /// Virtual destructor
@@ -25,7 +38,41 @@ public:
     /// Constructs and returns options description for this action
     virtual boost::program_options::options_description opts() const = 0;
 
-    /// Performs action
-    virtual void perform(const cm::src::source_code_model & cm,
-                         const boost::program_options::variables_map & opts) const = 0;
+    /// Returns true if action extracts result from code model. Actions which don't need
+    /// code model are executed once with empty code model without parsing inputs
+    virtual bool requires_code_model() const { return true; }
+
+    /// Returns path of source file which must be a part of code model for action to
+    /// produce result, if action arguments reference such file. Path may be a suffix
+    /// of full source path. Used for skipping translation units which can't see it
+    virtual std::optional<std::filesystem::path>
+    target_source([[maybe_unused]] const boost::program_options::variables_map & opts) const {
+        return std::nullopt;
+    }
+
+    /// Returns spelling of symbol which must occur in text of translation unit or its
+    /// headers for action to produce result, if it can be found without parsing
+    virtual std::optional<std::string>
+    target_spelling([[maybe_unused]] const boost::program_options::variables_map & opts) const {
+        return std::nullopt;
+    }
+
+    /// Extracts action result from code model. Result must not reference code model
+    virtual action_result extract(const cm::src::source_code_model & cm,
+                                  const boost::program_options::variables_map & opts) const = 0;
+
+    /// Outputs action result merged from all processed code models. Prints messages
+    /// to standard output by default
+    virtual void output(const action_result & res,
+                        [[maybe_unused]] const boost::program_options::variables_map & opts) const {
+        for (auto && msg : res.messages()) {
+            std::cout << msg << std::endl;
+        }
+    }
+
+    /// Performs action on single code model: extracts result and outputs it
+    void perform(const cm::src::source_code_model & cm,
+                 const boost::program_options::variables_map & opts) const {
+        output(extract(cm, opts), opts);
+    }
 };
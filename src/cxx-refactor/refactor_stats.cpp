@@ -0,0 +1,109 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file refactor_stats.cpp
+/// Contains implementation of the refactor_stats class.
+
+#include "refactor_stats.hpp"
+#include "json_writer.hpp"
+
+
+const char * stats_counter_name(stats_counter c) {
+    switch (c) {
+    case stats_counter::nodes_visited:      return "nodes_visited";
+    case stats_counter::uses_scanned:       return "uses_scanned";
+    case stats_counter::casts_attempted:    return "casts_attempted";
+    case stats_counter::edits_produced:     return "edits_produced";
+    case stats_counter::bytes_read:         return "bytes_read";
+    case stats_counter::bytes_written:      return "bytes_written";
+    case stats_counter::tus_processed:      return "tus_processed";
+    case stats_counter::tus_skipped:        return "tus_skipped";
+    case stats_counter::tus_prefiltered:    return "tus_prefiltered";
+    case stats_counter::tus_cancelled:      return "tus_cancelled";
+    case stats_counter::files_written:      return "files_written";
+    case stats_counter::writes_avoided:     return "writes_avoided";
+    case stats_counter::cache_hits:         return "cache_hits";
+    case stats_counter::cache_misses:       return "cache_misses";
+    case stats_counter::pool_busy_us:       return "pool_busy_us";
+    case stats_counter::pool_capacity_us:   return "pool_capacity_us";
+    case stats_counter::count_:             break;
+    }
+
+    return "unknown";
+}
+
+
+refactor_stats::refactor_stats():
+start_{std::chrono::steady_clock::now()} {
+    for (auto && c : counters_) {
+        c.store(0);
+    }
+}
+
+
+refactor_stats & refactor_stats::global() {
+    static refactor_stats stats;
+    return stats;
+}
+
+
+void refactor_stats::add_phase_time(const std::string & phase, std::chrono::nanoseconds t) {
+    arena_suspend no_arena;
+    std::lock_guard lock{phases_mtx_};
+    auto & timing = phases_[phase];
+    timing.total += t;
+    ++timing.count;
+}
+
+
+std::map<std::string, refactor_stats::phase_timing> refactor_stats::phases() const {
+    std::lock_guard lock{phases_mtx_};
+    return phases_;
+}
+
+
+/// Converts duration to floating point number of milliseconds
+static double to_ms(std::chrono::nanoseconds t) {
+    return std::chrono::duration<double, std::milli>(t).count();
+}
+
+
+void refactor_stats::write_json(std::ostream & ostr) const {
+    json_writer wr{ostr};
+    wr.begin_object();
+    wr.member("wall_ms", to_ms(std::chrono::steady_clock::now() - start_));
+
+    wr.key("phases").begin_object();
+    for (auto && [name, timing] : phases()) {
+        wr.key(name).begin_object();
+        wr.member("count", timing.count);
+        wr.member("total_ms", to_ms(timing.total));
+        wr.end_object();
+    }
+    wr.end_object();
+
+    wr.key("counters").begin_object();
+    for (std::size_t i = 0; i < counters_.size(); ++i) {
+        auto c = static_cast<stats_counter>(i);
+        wr.member(stats_counter_name(c), get(c));
+    }
+    wr.end_object();
+
+    // fraction of translation units which were not parsed thanks to include graph
+    // and textual pre-filter
+    auto avoided = get(stats_counter::tus_skipped) + get(stats_counter::tus_prefiltered);
+    auto considered = avoided + get(stats_counter::tus_processed);
+    wr.member("parse_avoidance_ratio",
+              considered != 0 ? static_cast<double>(avoided) / considered : 0.0);
+
+    // fraction of available thread time spent executing tasks
+    auto capacity = get(stats_counter::pool_capacity_us);
+    wr.member("core_utilization",
+              capacity != 0 ? static_cast<double>(get(stats_counter::pool_busy_us)) / capacity : 0.0);
+
+    wr.end_object();
+    ostr << std::endl;
+}
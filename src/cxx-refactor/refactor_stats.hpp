@@ -0,0 +1,117 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file refactor_stats.hpp
+/// Contains definitions of the refactor_stats and stats_phase classes.
+
+#pragma once
+
+#include "memory_accounting.hpp"
+#include "trace_recorder.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+
+/// Counters of refactor statistics
+enum class stats_counter {
+    nodes_visited,                          ///< Number of AST nodes visited by actions
+    uses_scanned,                           ///< Number of entity uses scanned by actions
+    casts_attempted,                        ///< Number of dynamic casts of uses and nodes
+    edits_produced,                         ///< Number of source modifications produced
+    bytes_read,                             ///< Number of source bytes read by rewriter
+    bytes_written,                          ///< Number of bytes written by rewriter
+    tus_processed,                          ///< Number of processed translation units
+    tus_skipped,                            ///< Number of translation units skipped by include graph
+    tus_prefiltered,                        ///< Number of translation units skipped by textual pre-filter
+    tus_cancelled,                          ///< Number of translation units not processed due to cancellation
+    files_written,                          ///< Number of source files written in place
+    writes_avoided,                         ///< Number of unchanged source files not written in place
+    cache_hits,                             ///< Number of action results taken from result cache
+    cache_misses,                           ///< Number of action results not found in result cache
+    pool_busy_us,                           ///< Time threads of pool spent executing tasks
+    pool_capacity_us,                       ///< Wall time of runs multiplied by number of pool threads
+    count_                                  ///< Number of counters
+};
+
+
+/// Returns name of statistics counter
+const char * stats_counter_name(stats_counter c);
+
+
+/// Statistics of refactor tool execution: accumulated time of execution phases
+/// and counters. All member functions are thread safe.
+class refactor_stats {
+public:
+    /// Accumulated timing of execution phase
+    struct phase_timing {
+        std::chrono::nanoseconds total{0};  ///< Total time spent in phase
+        std::uint64_t count = 0;            ///< Number of times phase was executed
+    };
+
+    /// Constructs empty statistics
+    explicit refactor_stats();
+
+    /// Returns reference to process wide statistics
+    static refactor_stats & global();
+
+    /// Increases value of counter
+    void add(stats_counter c, std::uint64_t n = 1) {
+        counters_[static_cast<std::size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /// Returns value of counter
+    std::uint64_t get(stats_counter c) const {
+        return counters_[static_cast<std::size_t>(c)].load(std::memory_order_relaxed);
+    }
+
+    /// Adds time spent in execution phase with specified name
+    void add_phase_time(const std::string & phase, std::chrono::nanoseconds t);
+
+    /// Returns copy of phases timings
+    std::map<std::string, phase_timing> phases() const;
+
+    /// Writes statistics in JSON format to output stream
+    void write_json(std::ostream & ostr) const;
+
+private:
+    /// Counters values
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(stats_counter::count_)> counters_;
+
+    mutable std::mutex phases_mtx_;                     ///< Mutex for phases map
+    std::map<std::string, phase_timing> phases_;        ///< Timings of phases
+    std::chrono::steady_clock::time_point start_;       ///< Statistics creation time
+};
+
+
+/// Scoped execution phase timer. Adds time between construction and destruction
+/// of object to process wide statistics, records phase in trace and measures
+/// memory usage of phase
+class stats_phase {
+public:
+    /// Starts phase with specified name (must be string literal)
+    explicit stats_phase(const char * name):
+    name_{name}, start_{std::chrono::steady_clock::now()}, trace_{name}, memory_{name} {}
+
+    /// Finishes phase
+    ~stats_phase() {
+        refactor_stats::global().add_phase_time(name_, std::chrono::steady_clock::now() - start_);
+    }
+
+    stats_phase(const stats_phase &) = delete;
+    stats_phase & operator=(const stats_phase &) = delete;
+
+private:
+    const char * name_;                                 ///< Phase name
+    std::chrono::steady_clock::time_point start_;       ///< Phase start time
+    trace_scope trace_;                                 ///< Phase trace event
+    memory_phase memory_;                               ///< Phase memory usage measurement
+};
@@ -0,0 +1,221 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file resident_model.cpp
+/// Contains implementation of the resident_model class.
+
+#include "pch.hpp"
+#include "resident_model.hpp"
+#include "cancellation.hpp"
+#include "line_index_table.hpp"
+#include "refactor_stats.hpp"
+#include "source_watcher.hpp"
+#include "streaming_executor.hpp"
+#include "thread_pool.hpp"
+#include "log/log.hpp"
+#include <optional>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <unordered_set>
+
+
+// logging functions
+#define RM_INFO REFACTOR_LOG_SCAT_INFO(refactor, resident-model)
+#define RM_ERROR REFACTOR_LOG_SCAT_ERROR(refactor, resident-model)
+
+
+namespace fs = std::filesystem;
+
+
+resident_model::resident_model(std::vector<fs::path> tus, include_graph graph):
+tus_{std::move(tus)}, graph_{std::move(graph)}, snapshot_{std::make_shared<model_snapshot>()} {}
+
+
+void resident_model::load() {
+    for (auto && tu : tus_) {
+        graph_.update(tu);
+    }
+
+    auto snap = std::make_shared<model_snapshot>();
+    snap->models.resize(tus_.size());
+    thread_pool::global().parallel_for(tus_.size(), [&](std::size_t idx) {
+        snap->models[idx] = parse_tu(tus_[idx]);
+    });
+
+    std::lock_guard lock{mtx_};
+    snap->version = snapshot_->version + 1;
+    snapshot_ = std::move(snap);
+}
+
+
+std::shared_ptr<const model_snapshot> resident_model::snapshot() const {
+    std::lock_guard lock{mtx_};
+    return snapshot_;
+}
+
+
+std::size_t resident_model::update(const std::vector<fs::path> & changed) {
+    // cached line indexes of changed files are stale
+    auto & paths = source_path_table::global();
+    std::unordered_set<file_id> changed_ids;
+    for (auto && p : changed) {
+        changed_ids.insert(paths.intern(p));
+        line_index_table::global().invalidate(paths.path(paths.intern(p)));
+    }
+
+    // rescanning changed files in include graph and selecting affected translation units,
+    // translation units with unresolved includes may include any of changed files
+    std::vector<std::size_t> affected;
+    for (std::size_t i = 0; i < tus_.size(); ++i) {
+        graph_.update(tus_[i]);
+        auto files = graph_.included_files(tus_[i]);
+        if (!graph_.complete(tus_[i]) ||
+            std::ranges::any_of(files, [&](auto file) { return changed_ids.contains(file); })) {
+            affected.push_back(i);
+        }
+    }
+
+    return reparse(affected);
+}
+
+
+std::size_t resident_model::reload() {
+    line_index_table::global().clear();
+
+    std::vector<std::size_t> all(tus_.size());
+    for (std::size_t i = 0; i < tus_.size(); ++i) {
+        graph_.update(tus_[i]);
+        all[i] = i;
+    }
+
+    return reparse(all);
+}
+
+
+std::size_t resident_model::reparse(const std::vector<std::size_t> & idxs) {
+    if (idxs.empty()) {
+        return 0;
+    }
+
+    auto snap = std::make_shared<model_snapshot>(*snapshot());
+    std::exception_ptr err;
+    for (auto idx : idxs) {
+        try {
+            snap->models[idx] = parse_tu(tus_[idx]);
+        }
+        catch (...) {
+            if (!err) {
+                err = std::current_exception();
+            }
+        }
+    }
+
+    {
+        std::lock_guard lock{mtx_};
+        snap->version = snapshot_->version + 1;
+        snapshot_ = std::move(snap);
+    }
+
+    refactor_stats::global().add(stats_counter::tus_processed, idxs.size());
+
+    if (err) {
+        std::rethrow_exception(err);
+    }
+
+    return idxs.size();
+}
+
+
+action_result resident_model::query(const refactor_action & action,
+                                    const boost::program_options::variables_map & opts,
+                                    bool partial) const {
+    auto snap = snapshot();
+
+    std::vector<std::optional<action_result>> results(snap->models.size());
+    std::atomic<std::size_t> found_count{0};
+    std::atomic<std::size_t> cancelled_count{0};
+    std::exception_ptr not_found_err;
+    std::mutex err_mtx;
+    thread_pool::global().parallel_for(snap->models.size(), [&](std::size_t idx) {
+        if (!snap->models[idx]) {
+            return;
+        }
+
+        if (cancellation_requested()) {
+            ++cancelled_count;
+            return;
+        }
+
+        try {
+            results[idx].emplace(action.extract(*snap->models[idx], opts));
+            ++found_count;
+        }
+        catch (const cancelled_error &) {
+            ++cancelled_count;
+        }
+        catch (const source_not_found_error &) {
+            std::lock_guard lock{err_mtx};
+            if (!not_found_err) {
+                not_found_err = std::current_exception();
+            }
+        }
+    });
+
+    if (cancelled_count != 0) {
+        refactor_stats::global().add(stats_counter::tus_cancelled, cancelled_count);
+        if (!partial) {
+            check_cancelled();
+        }
+    }
+    else if (found_count == 0 && not_found_err) {
+        std::rethrow_exception(not_found_err);
+    }
+
+    action_result res;
+    for (auto && tu_res : results) {
+        if (tu_res) {
+            res.merge(std::move(*tu_res));
+        }
+    }
+
+    return res;
+}
+
+
+/// Lowers scheduling priority of calling thread, so background work doesn't
+/// compete with requests
+static void lower_thread_priority() {
+    ::setpriority(PRIO_PROCESS, static_cast<id_t>(::syscall(SYS_gettid)), 19);
+}
+
+
+void resident_model::watch(const std::vector<fs::path> & dirs, std::chrono::milliseconds debounce) {
+    auto watcher = std::make_shared<source_watcher>(dirs);
+    watch_thread_ = std::jthread{[this, watcher, debounce](std::stop_token stop) {
+        lower_thread_priority();
+        while (!stop.stop_requested()) {
+            try {
+                auto changes = watcher->wait_changes(debounce, stop);
+                if (changes.overflow) {
+                    auto count = reload();
+                    RM_INFO << "re-parsed all " << count << " translation units after "
+                            << "loss of file change events";
+                }
+                else if (!changes.empty()) {
+                    auto count = update(changes.files);
+                    if (count != 0) {
+                        RM_INFO << "re-parsed " << count << " translation units after change of "
+                                << changes.files.size() << " files";
+                    }
+                }
+            }
+            catch (const std::exception & err) {
+                RM_ERROR << "can't update code model: " << err.what();
+            }
+        }
+    }};
+}
@@ -0,0 +1,90 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file resident_model.hpp
+/// Contains definition of the resident_model class.
+
+#pragma once
+
+#include "action_result.hpp"
+#include "include_graph.hpp"
+#include "refactor_action.hpp"
+#include <chrono>
+#include <cm/src/cmsrc.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/// Immutable set of code models of all translation units
+struct model_snapshot {
+    std::uint64_t version = 0;              ///< Version, incremented on each update
+    std::vector<std::shared_ptr<const cm::src::source_code_model>> models;  ///< Code models
+                                                                            ///< in order of TUs
+};
+
+
+/// Code models of translation units kept in memory between requests of server mode.
+/// Requests are executed over current snapshot of models. When sources change, only
+/// translation units which include changed files are re-parsed, new snapshot shares
+/// models of unaffected translation units with the old one and replaces it atomically.
+/// Requests started before replacement keep using the old snapshot until they finish.
+class resident_model {
+public:
+    /// Constructs model for specified translation units with include graph resolving
+    /// their includes. Models are not parsed
+    explicit resident_model(std::vector<std::filesystem::path> tus,
+                            include_graph graph = include_graph{});
+
+    /// Parses all translation units in parallel with global thread pool
+    void load();
+
+    /// Returns current snapshot
+    std::shared_ptr<const model_snapshot> snapshot() const;
+
+    /// Re-parses translation units which include any of changed files or have unresolved
+    /// includes and replaces snapshot. Models of translation units which can't be parsed
+    /// are kept from the old snapshot, the first error is reported after snapshot is
+    /// replaced. Returns number of re-parsed translation units. Must not be called
+    /// concurrently
+    std::size_t update(const std::vector<std::filesystem::path> & changed);
+
+    /// Re-parses all translation units and replaces snapshot, used when changed files
+    /// are unknown. Errors are reported as by the update function
+    std::size_t reload();
+
+    /// Executes action over current snapshot. Translation units which do not contain
+    /// source referenced by action arguments are skipped, error is reported only if
+    /// all translation units are skipped. Translation units are not processed after
+    /// cancellation token of calling thread is cancelled, results of processed ones
+    /// are returned in partial mode, otherwise cancelled_error is thrown
+    action_result query(const refactor_action & action,
+                        const boost::program_options::variables_map & opts,
+                        bool partial = false) const;
+
+    /// Starts background thread with low priority, which watches specified directories
+    /// and updates model when sources change. All translation units are re-parsed if
+    /// watcher loses events. Errors of watching and parsing are logged and don't stop
+    /// thread. Must be called after model is loaded,
+    /// thread is stopped when model is destroyed
+    void watch(const std::vector<std::filesystem::path> & dirs, std::chrono::milliseconds debounce);
+
+    /// Returns paths of translation units
+    const auto & tus() const { return tus_; }
+
+private:
+    /// Re-parses translation units with specified indices and replaces snapshot
+    std::size_t reparse(const std::vector<std::size_t> & idxs);
+
+    std::vector<std::filesystem::path> tus_;            ///< Translation units
+    include_graph graph_;                               ///< Include graph, used by updates only
+    mutable std::mutex mtx_;                            ///< Mutex for current snapshot
+    std::shared_ptr<const model_snapshot> snapshot_;    ///< Current snapshot
+    std::jthread watch_thread_;                         ///< Background watching thread
+};
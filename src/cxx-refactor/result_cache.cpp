@@ -0,0 +1,433 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file result_cache.cpp
+/// Contains implementation of the result_cache class.
+
+#include "pch.hpp"
+#include "result_cache.hpp"
+#include "child_process.hpp"
+#include "fnv_hash.hpp"
+#include "mapped_file.hpp"
+#include "refactor_stats.hpp"
+#include "result_serialization.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+#define RC_DEBUG REFACTOR_LOG_SCAT_DEBUG(refactor, result-cache)
+#define RC_WARNING REFACTOR_LOG_SCAT_WARNING(refactor, result-cache)
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+/// Magic number at start of cache entry
+static constexpr std::uint32_t entry_magic = 0x31435843;    // "CXC1"
+
+/// Header line of cache queries, changed when format of queries or entries changes
+static constexpr std::string_view query_header = "cxx-refactor-result-cache 2";
+
+
+/// File read by action recorded in cache entry
+struct cached_file {
+    std::string path;                       ///< Canonical file path
+    file_stamp stamp;                       ///< File stamp when entry was stored
+    std::uint64_t hash = 0;                 ///< Hash of file contents
+};
+
+
+/// Writes unsigned integer to stream
+template <typename T>
+static void write_uint(std::ostream & ostr, T val) {
+    ostr.write(reinterpret_cast<const char *>(&val), sizeof(val));
+}
+
+
+/// Writes string prefixed with its length to stream
+static void write_string(std::ostream & ostr, std::string_view str) {
+    write_uint(ostr, static_cast<std::uint32_t>(str.size()));
+    ostr.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+
+/// Reads unsigned integer from data and advances data past it
+template <typename T>
+static T read_uint(std::string_view & data) {
+    T val = 0;
+    if (data.size() < sizeof(val)) {
+        throw std::runtime_error{"truncated result cache entry"};
+    }
+
+    std::memcpy(&val, data.data(), sizeof(val));
+    data.remove_prefix(sizeof(val));
+    return val;
+}
+
+
+/// Reads string prefixed with its length from data and advances data past it
+static std::string_view read_string(std::string_view & data) {
+    auto size = read_uint<std::uint32_t>(data);
+    if (data.size() < size) {
+        throw std::runtime_error{"truncated result cache entry"};
+    }
+
+    auto str = data.substr(0, size);
+    data.remove_prefix(size);
+    return str;
+}
+
+
+/// Appends value of action argument to query. Returns false if value has
+/// unsupported type
+static bool append_value(std::ostringstream & ostr, const std::string & name,
+                         const po::variable_value & val) {
+    auto & v = val.value();
+    auto arg = [&]() -> std::ostream & { return ostr << "arg " << name << '='; };
+
+    if (v.empty()) {
+        arg() << '\n';
+    }
+    else if (auto str = boost::any_cast<std::string>(&v)) {
+        arg() << *str << '\n';
+    }
+    else if (auto path = boost::any_cast<fs::path>(&v)) {
+        arg() << path->string() << '\n';
+    }
+    else if (auto strs = boost::any_cast<std::vector<std::string>>(&v)) {
+        for (auto && s : *strs) {
+            arg() << s << '\n';
+        }
+    }
+    else if (auto paths = boost::any_cast<std::vector<fs::path>>(&v)) {
+        for (auto && p : *paths) {
+            arg() << p.string() << '\n';
+        }
+    }
+    else if (auto i = boost::any_cast<int>(&v)) {
+        arg() << *i << '\n';
+    }
+    else if (auto u = boost::any_cast<unsigned>(&v)) {
+        arg() << *u << '\n';
+    }
+    else if (auto sz = boost::any_cast<std::size_t>(&v)) {
+        arg() << *sz << '\n';
+    }
+    else if (auto d = boost::any_cast<double>(&v)) {
+        arg() << std::setprecision(17) << *d << '\n';
+    }
+    else if (auto b = boost::any_cast<bool>(&v)) {
+        arg() << *b << '\n';
+    }
+    else {
+        return false;
+    }
+
+    return true;
+}
+
+
+/// Returns hash of file contents
+static std::uint64_t hash_file(const fs::path & p) {
+    mapped_file file{p};
+    return fnv1a_hash(file.text());
+}
+
+
+result_cache::result_cache(const fs::path & dir, std::uintmax_t max_size):
+dir_{dir}, max_size_{max_size} {}
+
+
+std::optional<std::string>
+result_cache::make_query(std::string_view action, const po::variables_map & opts,
+                         const std::vector<fs::path> & inputs,
+                         const std::vector<std::string> & parse_args) {
+    // relative paths in arguments are resolved against working directory
+    std::ostringstream ostr;
+    ostr << query_header << '\n'
+         << "action " << action << '\n'
+         << "cwd " << fs::current_path().string() << '\n';
+
+    // arguments are ordered by names in variables map
+    for (auto && [name, val] : opts) {
+        if (!append_value(ostr, name, val)) {
+            RC_WARNING << "action argument '" << name << "' has unsupported type, "
+                       << "result is not cached";
+            return std::nullopt;
+        }
+    }
+
+    for (auto && input : inputs) {
+        ostr << "input " << fs::absolute(input).lexically_normal().string() << '\n';
+    }
+
+    for (auto && arg : parse_args) {
+        ostr << "parse-arg " << arg << '\n';
+    }
+
+    return std::move(ostr).str();
+}
+
+
+std::optional<std::vector<fs::path>>
+result_cache::compiler_dependencies(const std::string & compiler,
+                                    const std::vector<std::string> & args,
+                                    const fs::path & tu) {
+    std::vector<std::string> cmd{compiler};
+    cmd.insert(cmd.end(), args.begin(), args.end());
+    cmd.insert(cmd.end(), {"-M", "-MT", "x", tu.string()});
+
+    process_result proc;
+    try {
+        proc = run_process(cmd, process_stream::out);
+    }
+    catch (const std::exception & err) {
+        RC_WARNING << "can't list dependencies of " << tu << ": " << err.what();
+        return std::nullopt;
+    }
+
+    if (!WIFEXITED(proc.status) || WEXITSTATUS(proc.status) != 0) {
+        RC_WARNING << "can't list dependencies of " << tu << ": compiler '" << compiler
+                   << "' failed";
+        return std::nullopt;
+    }
+
+    // make rule 'x: dep dep \<newline> dep', spaces in paths are escaped with
+    // backslashes and dollar signs are doubled
+    std::string_view out = proc.output;
+    auto colon = out.find(':');
+    if (colon == std::string_view::npos) {
+        return std::nullopt;
+    }
+
+    std::vector<fs::path> res;
+    std::string cur;
+    for (auto i = colon + 1; i <= out.size(); ++i) {
+        auto c = i < out.size() ? out[i] : '\n';
+        if (c == '\\' && i + 1 < out.size() && out[i + 1] != '\n') {
+            cur += out[++i];
+        } else if (c == '$' && i + 1 < out.size() && out[i + 1] == '$') {
+            cur += out[++i];
+        } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\\') {
+            if (!cur.empty()) {
+                res.emplace_back(std::move(cur));
+                cur.clear();
+            }
+        } else {
+            cur += c;
+        }
+    }
+
+    return res;
+}
+
+
+std::optional<action_result> result_cache::find(const std::string & query,
+                                                thread_pool & pool) const {
+    auto & stats = refactor_stats::global();
+    auto path = entry_path(query);
+    if (!fs::exists(path)) {
+        RC_DEBUG << "no cache entry " << path;
+        stats.add(stats_counter::cache_misses);
+        return std::nullopt;
+    }
+
+    try {
+        stats_phase phase{"cache-lookup"};
+        mapped_file file{path};
+        auto data = file.text();
+        if (read_uint<std::uint32_t>(data) != entry_magic) {
+            throw std::runtime_error{"invalid result cache entry"};
+        }
+
+        // entries of different queries with the same hash replace each other
+        if (read_string(data) != query) {
+            RC_DEBUG << "cache entry " << path << " belongs to another query";
+            stats.add(stats_counter::cache_misses);
+            return std::nullopt;
+        }
+
+        // each file record takes at least 28 bytes
+        auto files_count = read_uint<std::uint32_t>(data);
+        if (files_count > data.size() / 28) {
+            throw std::runtime_error{"truncated result cache entry"};
+        }
+
+        std::vector<cached_file> files(files_count);
+        for (auto && f : files) {
+            f.path = read_string(data);
+            f.stamp.exists = true;
+            f.stamp.mtime = static_cast<std::int64_t>(read_uint<std::uint64_t>(data));
+            f.stamp.size = read_uint<std::uint64_t>(data);
+            f.hash = read_uint<std::uint64_t>(data);
+        }
+
+        // checking files in parallel, contents are hashed only if stamps differ
+        std::atomic<bool> changed{false};
+        pool.parallel_for(files.size(), [&](std::size_t idx) {
+            if (changed) {
+                return;
+            }
+
+            auto & f = files[idx];
+            auto stamp = file_stamp::of(f.path);
+            if (stamp == f.stamp) {
+                return;
+            }
+
+            if (!stamp.exists || stamp.size != f.stamp.size || hash_file(f.path) != f.hash) {
+                RC_DEBUG << "file " << f.path << " changed since cache entry was stored";
+                changed = true;
+            }
+        });
+
+        if (changed) {
+            stats.add(stats_counter::cache_misses);
+            return std::nullopt;
+        }
+
+        auto res = read_action_result(data);
+
+        // modification time of entry is used for least recently used eviction
+        std::error_code ec;
+        fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+
+        RC_DEBUG << "action result taken from cache entry " << path;
+        stats.add(stats_counter::cache_hits);
+        return res;
+    }
+    catch (const std::exception & err) {
+        RC_WARNING << "removing invalid cache entry " << path << ": " << err.what();
+        std::error_code ec;
+        fs::remove(path, ec);
+        stats.add(stats_counter::cache_misses);
+        return std::nullopt;
+    }
+}
+
+
+void result_cache::store(const std::string & query, const std::vector<fs::path> & files,
+                         const action_result & res, thread_pool & pool) const {
+    stats_phase phase{"cache-store"};
+
+    // hashing files read by action, result is not stored if any of them is missing
+    std::vector<cached_file> cfiles(files.size());
+    std::atomic<bool> missing{false};
+    pool.parallel_for(files.size(), [&](std::size_t idx) {
+        auto & f = cfiles[idx];
+        f.path = fs::absolute(files[idx]).lexically_normal().string();
+        f.stamp = file_stamp::of(f.path);
+        if (!f.stamp.exists) {
+            missing = true;
+            return;
+        }
+
+        f.hash = hash_file(f.path);
+    });
+
+    if (missing) {
+        RC_WARNING << "file read by action doesn't exist, result is not cached";
+        return;
+    }
+
+    std::ostringstream ostr;
+    write_uint(ostr, entry_magic);
+    write_string(ostr, query);
+    write_uint(ostr, static_cast<std::uint32_t>(cfiles.size()));
+    for (auto && f : cfiles) {
+        write_string(ostr, f.path);
+        write_uint(ostr, static_cast<std::uint64_t>(f.stamp.mtime));
+        write_uint(ostr, static_cast<std::uint64_t>(f.stamp.size));
+        write_uint(ostr, f.hash);
+    }
+
+    write_action_result(ostr, res);
+
+    // entry is written to temporary file and renamed, so concurrent runs sharing
+    // cache never read partially written entries
+    fs::create_directories(dir_);
+    auto path = entry_path(query);
+    auto tmp_path = path;
+    tmp_path += ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream file{tmp_path, std::ios::binary};
+        file << ostr.view();
+        if (!file.flush()) {
+            std::ostringstream msg;
+            msg << "can't write result cache entry " << tmp_path;
+            throw std::runtime_error{msg.str()};
+        }
+    }
+
+    fs::rename(tmp_path, path);
+    RC_DEBUG << "action result stored in cache entry " << path;
+
+    evict();
+}
+
+
+std::uintmax_t result_cache::size() const {
+    std::uintmax_t res = 0;
+    std::error_code ec;
+    for (auto && entry : fs::directory_iterator{dir_, ec}) {
+        if (entry.path().extension() == ".entry") {
+            res += entry.file_size(ec);
+        }
+    }
+
+    return res;
+}
+
+
+fs::path result_cache::entry_path(const std::string & query) const {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << fnv1a_hash(query) << ".entry";
+    return dir_ / name.str();
+}
+
+
+void result_cache::evict() const {
+    struct entry_info {
+        fs::file_time_type mtime;           ///< Time of last use
+        std::uintmax_t size;                ///< Entry size
+        fs::path path;                      ///< Entry path
+    };
+
+    std::vector<entry_info> entries;
+    std::uintmax_t total = 0;
+    std::error_code ec;
+    for (auto && entry : fs::directory_iterator{dir_, ec}) {
+        if (entry.path().extension() != ".entry") {
+            continue;
+        }
+
+        entry_info info{entry.last_write_time(ec), entry.file_size(ec), entry.path()};
+        if (!ec) {
+            total += info.size;
+            entries.push_back(std::move(info));
+        }
+    }
+
+    std::ranges::sort(entries, {}, &entry_info::mtime);
+    for (auto && entry : entries) {
+        if (total <= max_size_) {
+            break;
+        }
+
+        RC_DEBUG << "evicting cache entry " << entry.path;
+        fs::remove(entry.path, ec);
+        total -= entry.size;
+    }
+}
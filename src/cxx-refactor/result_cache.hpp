@@ -0,0 +1,72 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file result_cache.hpp
+/// Contains definition of the result_cache class.
+
+#pragma once
+
+#include "action_result.hpp"
+#include "thread_pool.hpp"
+#include <boost/program_options.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// On-disk cache of action results shared between runs. Entry is addressed by query:
+/// action name, normalized action arguments, working directory, input translation
+/// units and parser arguments. Entry stores content hashes of all files read by action
+/// together with result, and it's used only if all files still have the same contents.
+/// Files are hashed only if their modification time or size differ from recorded ones.
+/// Entries are evicted in least recently used order when total size of cache exceeds
+/// size limit.
+class result_cache {
+public:
+    /// Constructs cache stored in specified directory with specified size limit in bytes
+    explicit result_cache(const std::filesystem::path & dir, std::uintmax_t max_size);
+
+    /// Returns normalized query of action with specified arguments over specified
+    /// translation units parsed with specified compiler arguments. Returns nullopt if
+    /// action has arguments of types which can't be normalized, such actions are not cached
+    static std::optional<std::string>
+    make_query(std::string_view action, const boost::program_options::variables_map & opts,
+               const std::vector<std::filesystem::path> & inputs,
+               const std::vector<std::string> & parse_args = {});
+
+    /// Returns files read when specified translation unit is preprocessed with compiler
+    /// arguments, as listed by dependency output (-M) of specified compiler. Returns
+    /// nullopt if compiler can't be run or fails
+    static std::optional<std::vector<std::filesystem::path>>
+    compiler_dependencies(const std::string & compiler, const std::vector<std::string> & args,
+                          const std::filesystem::path & tu);
+
+    /// Returns result stored for query if contents of all files read by action didn't
+    /// change. Entry becomes the most recently used one
+    std::optional<action_result> find(const std::string & query,
+                                      thread_pool & pool = thread_pool::global()) const;
+
+    /// Stores result of query with hashes of specified files read by action, replaces
+    /// existing entry. Evicts least recently used entries exceeding size limit
+    void store(const std::string & query, const std::vector<std::filesystem::path> & files,
+               const action_result & res, thread_pool & pool = thread_pool::global()) const;
+
+    /// Returns total size of cache entries
+    std::uintmax_t size() const;
+
+private:
+    /// Returns path of entry file for query
+    std::filesystem::path entry_path(const std::string & query) const;
+
+    /// Removes least recently used entries until total size fits size limit
+    void evict() const;
+
+    std::filesystem::path dir_;             ///< Cache directory
+    std::uintmax_t max_size_;               ///< Size limit in bytes
+};
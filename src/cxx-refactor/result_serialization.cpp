@@ -0,0 +1,159 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file result_serialization.cpp
+/// Contains implementation of functions for serializing action results.
+
+#include "pch.hpp"
+#include "result_serialization.hpp"
+#include <cstdint>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+
+/// Magic number at start of serialized result, bytes "CXR1" in little-endian order
+static constexpr std::uint32_t result_magic = 0x31525843;
+
+
+/// Writes unsigned integer to stream in little-endian byte order
+static void write_u32(std::ostream & ostr, std::uint32_t val) {
+    char bytes[4];
+    for (std::size_t i = 0; i < sizeof(bytes); ++i) {
+        bytes[i] = static_cast<char>((val >> (i * 8)) & 0xff);
+    }
+
+    ostr.write(bytes, sizeof(bytes));
+}
+
+
+/// Writes string prefixed with its length to stream
+static void write_string(std::ostream & ostr, std::string_view str) {
+    write_u32(ostr, static_cast<std::uint32_t>(str.size()));
+    ostr.write(str.data(), static_cast<std::streamsize>(str.size()));
+}
+
+
+/// Reads unsigned integer in little-endian byte order from data and advances data past it
+static std::uint32_t read_u32(std::string_view & data) {
+    std::uint32_t val = 0;
+    if (data.size() < sizeof(val)) {
+        throw std::runtime_error{"truncated serialized action result"};
+    }
+
+    for (std::size_t i = 0; i < sizeof(val); ++i) {
+        val |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[i])) << (i * 8);
+    }
+
+    data.remove_prefix(sizeof(val));
+    return val;
+}
+
+
+/// Reads string prefixed with its length from data and advances data past it
+static std::string_view read_string(std::string_view & data) {
+    auto size = read_u32(data);
+    if (data.size() < size) {
+        throw std::runtime_error{"truncated serialized action result"};
+    }
+
+    auto str = data.substr(0, size);
+    data.remove_prefix(size);
+    return str;
+}
+
+
+void write_action_result(std::ostream & ostr, const action_result & res) {
+    write_u32(ostr, result_magic);
+
+    write_u32(ostr, static_cast<std::uint32_t>(res.messages().size()));
+    for (auto && msg : res.messages()) {
+        write_string(ostr, msg);
+    }
+
+    write_u32(ostr, static_cast<std::uint32_t>(res.mods().mods().size()));
+    for (auto && [file, smods] : res.mods().mods()) {
+        write_string(ostr, multi_source_modifications::path(file).native());
+        write_u32(ostr, static_cast<std::uint32_t>(smods.size()));
+        for (auto && mod : smods.mods()) {
+            write_u32(ostr, mod.start());
+            write_u32(ostr, mod.end());
+            write_string(ostr, mod.insert_string());
+        }
+    }
+}
+
+
+serialized_result read_serialized_result(std::string_view data) {
+    if (read_u32(data) != result_magic) {
+        throw std::runtime_error{"invalid serialized action result"};
+    }
+
+    serialized_result res;
+    auto msgs_count = read_u32(data);
+    for (std::uint32_t i = 0; i < msgs_count; ++i) {
+        res.messages.emplace_back(read_string(data));
+    }
+
+    auto files_count = read_u32(data);
+    for (std::uint32_t i = 0; i < files_count; ++i) {
+        auto & src = res.sources.emplace_back();
+        src.path = read_string(data);
+
+        auto mods_count = read_u32(data);
+        for (std::uint32_t j = 0; j < mods_count; ++j) {
+            auto start = read_u32(data);
+            auto end = read_u32(data);
+            auto insert_str = read_string(data);
+            if (end < start) {
+                std::ostringstream msg;
+                msg << "invalid modification range [" << start << ", " << end << ") of source "
+                    << src.path << " in serialized action result";
+                throw std::runtime_error{msg.str()};
+            }
+
+            src.mods.emplace_back(start, end, std::string{insert_str});
+        }
+    }
+
+    return res;
+}
+
+
+action_result read_action_result(std::string_view data) {
+    auto sres = read_serialized_result(data);
+
+    action_result res;
+    for (auto && msg : sres.messages) {
+        res.add_message(msg);
+    }
+
+    // line index of source is taken only if it's already built, it's used only for
+    // reporting positions of modifications in errors
+    for (auto && src : sres.sources) {
+        single_source_modifications smods{line_index_table::global().find(src.path)};
+        for (auto && mod : src.mods) {
+            // modifications are usually written in order of offsets
+            if (!smods.empty() && mod.start() > smods.mods().back().start()) {
+                smods.append(std::move(mod));
+            }
+            else {
+                smods.add(mod);
+            }
+        }
+
+        res.mods().add(src.path, std::move(smods));
+    }
+
+    return res;
+}
+
+
+action_result read_action_result(std::istream & istr) {
+    std::string data{std::istreambuf_iterator<char>{istr}, std::istreambuf_iterator<char>{}};
+    return read_action_result(std::string_view{data});
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file result_serialization.hpp
+/// Contains declarations of functions for serializing action results.
+
+#pragma once
+
+#include "action_result.hpp"
+#include <istream>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// Writes action result to stream in compact binary format. Sources are written
+/// by paths, because file identifiers are local to process. Format is used for passing
+/// results between processes, for result cache entries and for edit scripts of external
+/// tools. All integers are 32-bit unsigned in little-endian byte order, strings are
+/// prefixed with their byte length:
+///   - magic bytes "CXR1";
+///   - number of messages, then each message as string;
+///   - number of sources, then for each source: path as string, number of modifications,
+///     then for each modification: start offset, end offset (replaced byte range
+///     [start, end) of original source) and inserted text as string.
+void write_action_result(std::ostream & ostr, const action_result & res);
+
+/// Modifications of single source read from serialized action result
+struct serialized_source {
+    std::filesystem::path path;                     ///< Path of source
+    std::vector<compact_modification> mods;         ///< Modifications in order of data
+};
+
+
+/// Action result read from serialized data before modifications are checked for overlapping
+struct serialized_result {
+    std::vector<std::string> messages;              ///< Messages for user
+    std::vector<serialized_source> sources;         ///< Sources in order of data
+};
+
+
+/// Reads action result written by the write_action_result function from memory buffer
+/// without checking modifications for overlapping. Throws exception if buffer contains
+/// invalid or truncated data
+serialized_result read_serialized_result(std::string_view data);
+
+/// Reads action result written by the write_action_result function. Throws exception
+/// if stream contains invalid or truncated data or overlapping modifications
+action_result read_action_result(std::istream & istr);
+
+/// Reads action result written by the write_action_result function from memory buffer.
+/// Throws exception if buffer contains invalid or truncated data or overlapping modifications
+action_result read_action_result(std::string_view data);
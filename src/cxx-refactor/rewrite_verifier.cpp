@@ -0,0 +1,232 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file rewrite_verifier.cpp
+/// Contains implementation of the rewrite_verifier class.
+
+#include "pch.hpp"
+#include "rewrite_verifier.hpp"
+#include "child_process.hpp"
+#include "json_writer.hpp"
+#include "source_rewriter.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace fs = std::filesystem;
+
+
+/// Throws exception with description of last system error
+[[noreturn]] static void throw_errno(std::string_view what) {
+    std::ostringstream msg;
+    msg << what << ": " << std::strerror(errno);
+    throw std::runtime_error{msg.str()};
+}
+
+
+/// Anonymous file in memory, inherited by compiler processes and opened by them
+/// through /proc/self/fd
+class memory_file {
+public:
+    /// Creates file with specified name and contents
+    explicit memory_file(const std::string & name, std::string_view contents) {
+        fd_ = ::memfd_create(name.c_str(), 0);
+        if (fd_ < 0) {
+            throw_errno("can't create memory file");
+        }
+
+        while (!contents.empty()) {
+            auto written = ::write(fd_, contents.data(), contents.size());
+            if (written < 0 && errno != EINTR) {
+                ::close(fd_);
+                throw_errno("can't write memory file");
+            }
+
+            contents.remove_prefix(written < 0 ? 0 : static_cast<std::size_t>(written));
+        }
+    }
+
+    /// Closes file
+    ~memory_file() { ::close(fd_); }
+
+    memory_file(const memory_file &) = delete;
+    memory_file & operator=(const memory_file &) = delete;
+
+    /// Returns path of file valid in current process and processes inheriting it
+    std::string path() const { return "/proc/self/fd/" + std::to_string(fd_); }
+
+private:
+    int fd_ = -1;                           ///< File descriptor
+};
+
+
+rewrite_verifier::rewrite_verifier(std::string compiler, std::vector<std::string> args):
+compiler_{std::move(compiler)}, args_{std::move(args)} {}
+
+
+std::vector<rewrite_verifier::tu_report>
+rewrite_verifier::verify(const std::vector<fs::path> & tus,
+                         const multi_source_modifications & mods,
+                         const include_graph & graph,
+                         thread_pool & pool) const {
+    // selecting translation units including modified sources, translation units with
+    // unresolved includes may include any of them
+    std::vector<fs::path> affected;
+    for (auto && tu : tus) {
+        auto files = graph.included_files(tu);
+        if (!graph.complete(tu) ||
+            std::ranges::any_of(files, [&](auto file) { return mods.mods().contains(file); })) {
+            affected.push_back(tu);
+        }
+    }
+
+    if (affected.empty()) {
+        return {};
+    }
+
+    // rewriting modified sources into memory files and creating overlay mapping
+    // original paths to them
+    std::vector<std::unique_ptr<memory_file>> files;
+    std::ostringstream overlay_str;
+    json_writer json{overlay_str};
+    json.begin_object()
+        .member("version", 0)
+        .member("use-external-names", false)
+        .key("roots").begin_array();
+
+    source_rewriter rw;
+    for (auto && [file, smods] : mods.mods()) {
+        auto & path = multi_source_modifications::path(file);
+        std::ostringstream text;
+        rw.rewrite(smods, path, text);
+        files.push_back(std::make_unique<memory_file>(path.filename().string(), text.view()));
+
+        json.begin_object()
+            .member("type", "file")
+            .member("name", path.string())
+            .member("external-contents", files.back()->path())
+            .end_object();
+    }
+
+    json.end_array().end_object();
+    memory_file overlay{"overlay.json", overlay_str.view()};
+
+    // checking translation units with original and rewritten sources
+    std::vector<tu_report> res(affected.size());
+    pool.parallel_for(affected.size(), [&](std::size_t idx) {
+        auto before = parse_diagnostics(run_compiler(affected[idx], {}));
+        auto after = parse_diagnostics(run_compiler(affected[idx], overlay.path()));
+        res[idx] = tu_report{affected[idx], new_diagnostics(before, after)};
+    });
+
+    return res;
+}
+
+
+std::string rewrite_verifier::run_compiler(const fs::path & tu, const std::string & overlay) const {
+    std::vector<std::string> args{compiler_};
+    args.insert(args.end(), args_.begin(), args_.end());
+    args.insert(args.end(), {"-fsyntax-only", "-fno-color-diagnostics", "-fno-caret-diagnostics"});
+    if (!overlay.empty()) {
+        args.insert(args.end(), {"-ivfsoverlay", overlay});
+    }
+
+    // overlay entries are canonical paths, so translation unit is passed by canonical
+    // path too and its includes are resolved to paths matching overlay
+    std::error_code ec;
+    auto tu_path = fs::canonical(tu, ec);
+    args.push_back(ec ? tu.string() : tu_path.string());
+
+    auto proc = run_process(args, process_stream::err);
+
+    // compiler exits with status 1 if there are errors in sources, other statuses and
+    // signals mean that compiler failed and its diagnostics are incomplete
+    auto status = proc.status;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) > 1) {
+        std::ostringstream msg;
+        msg << "compiler '" << compiler_ << "' failed verifying " << tu << ": ";
+        if (WIFSIGNALED(status)) {
+            msg << "killed by signal " << WTERMSIG(status);
+        } else {
+            msg << "exit status " << WEXITSTATUS(status);
+        }
+
+        throw std::runtime_error{msg.str()};
+    }
+
+    return std::move(proc.output);
+}
+
+
+std::vector<std::string> rewrite_verifier::parse_diagnostics(std::string_view output) {
+    std::vector<std::string> res;
+    while (!output.empty()) {
+        auto eol = output.find('\n');
+        auto line = output.substr(0, eol);
+        output.remove_prefix(eol == std::string_view::npos ? output.size() : eol + 1);
+
+        if (line.find(": error: ") != std::string_view::npos ||
+            line.find(": fatal error: ") != std::string_view::npos ||
+            line.find(": warning: ") != std::string_view::npos) {
+            res.emplace_back(line);
+        }
+    }
+
+    return res;
+}
+
+
+/// Returns diagnostic without line and column numbers: 'path:line:col: msg'
+/// is converted to 'path: msg'
+static std::string diagnostic_key(std::string_view diag) {
+    auto sev_pos = diag.find(": ");
+    if (sev_pos == std::string_view::npos) {
+        return std::string{diag};
+    }
+
+    // skipping numeric components before severity
+    auto loc = diag.substr(0, sev_pos);
+    for (int i = 0; i < 2; ++i) {
+        auto colon = loc.rfind(':');
+        if (colon == std::string_view::npos ||
+            !std::ranges::all_of(loc.substr(colon + 1), [](char c) { return c >= '0' && c <= '9'; })) {
+            break;
+        }
+
+        loc = loc.substr(0, colon);
+    }
+
+    return std::string{loc} + std::string{diag.substr(sev_pos)};
+}
+
+
+std::vector<std::string> rewrite_verifier::new_diagnostics(const std::vector<std::string> & before,
+                                                           const std::vector<std::string> & after) {
+    std::map<std::string, std::size_t> counts;
+    for (auto && diag : before) {
+        ++counts[diagnostic_key(diag)];
+    }
+
+    std::vector<std::string> res;
+    for (auto && diag : after) {
+        auto it = counts.find(diagnostic_key(diag));
+        if (it != counts.end() && it->second != 0) {
+            --it->second;
+            continue;
+        }
+
+        res.push_back(diag);
+    }
+
+    return res;
+}
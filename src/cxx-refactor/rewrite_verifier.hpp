@@ -0,0 +1,64 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file rewrite_verifier.hpp
+/// Contains definition of the rewrite_verifier class.
+
+#pragma once
+
+#include "include_graph.hpp"
+#include "multi_source_modifications.hpp"
+#include "thread_pool.hpp"
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/// Verifies rewritten sources by re-parsing translation units which include them
+/// before sources are written. Rewritten sources are kept in anonymous memory files
+/// and passed to compiler with virtual file system overlay, so files on disk are not
+/// touched. Each affected translation unit is checked by compiler in syntax only mode
+/// with original and rewritten sources, diagnostics which are reported only for
+/// rewritten sources are reported as new. Translation units are verified in parallel.
+/// Verification fails with exception if compiler terminates abnormally.
+class rewrite_verifier {
+public:
+    /// Result of verification of translation unit
+    struct tu_report {
+        std::filesystem::path tu;                   ///< Translation unit
+        std::vector<std::string> new_diagnostics;   ///< Diagnostics caused by rewriting
+    };
+
+    /// Constructs verifier running specified compiler with additional arguments.
+    /// Compiler must support clang virtual file system overlays
+    explicit rewrite_verifier(std::string compiler = "clang++", std::vector<std::string> args = {});
+
+    /// Verifies translation units which include any of modified sources. Include graph
+    /// must be updated for all translation units. Returns reports of verified translation
+    /// units in order of inputs
+    std::vector<tu_report> verify(const std::vector<std::filesystem::path> & tus,
+                                  const multi_source_modifications & mods,
+                                  const include_graph & graph,
+                                  thread_pool & pool = thread_pool::global()) const;
+
+    /// Returns error and warning lines of compiler output
+    static std::vector<std::string> parse_diagnostics(std::string_view output);
+
+    /// Returns diagnostics which are present only in second list. Diagnostics are
+    /// compared without line and column numbers, which are shifted by rewriting
+    static std::vector<std::string> new_diagnostics(const std::vector<std::string> & before,
+                                                    const std::vector<std::string> & after);
+
+private:
+    /// Runs compiler in syntax only mode for translation unit with optional overlay
+    /// and returns its diagnostics output. Throws exception if compiler crashes or
+    /// exits with status other than 0 and 1
+    std::string run_compiler(const std::filesystem::path & tu, const std::string & overlay) const;
+
+    std::string compiler_;                  ///< Compiler executable
+    std::vector<std::string> args_;         ///< Additional compiler arguments
+};
@@ -0,0 +1,261 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file shard_executor.cpp
+/// Contains implementation of the shard_executor class.
+
+#include "pch.hpp"
+#include "shard_executor.hpp"
+#include "refactor_action.hpp"
+#include "refactor_stats.hpp"
+#include "result_serialization.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace fs = std::filesystem;
+
+
+/// Status of shard written by worker process before result
+enum class shard_status: char {
+    ok,                                     ///< Result follows
+    source_not_found,                       ///< Error message of source_not_found_error follows
+    error                                   ///< Error message follows
+};
+
+
+/// Throws exception with description of last system error
+[[noreturn]] static void throw_errno(std::string_view what) {
+    std::ostringstream msg;
+    msg << what << ": " << std::strerror(errno);
+    throw std::runtime_error{msg.str()};
+}
+
+
+/// Writes all data to file descriptor. Returns false on error
+static bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        auto written = ::write(fd, data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+
+    return true;
+}
+
+
+/// Reads all data from file descriptor until end of file
+static std::string read_all(int fd) {
+    std::string res;
+    char buf[65536];
+    for (;;) {
+        auto count = ::read(fd, buf, sizeof(buf));
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            throw_errno("can't read result of shard worker");
+        }
+
+        if (count == 0) {
+            return res;
+        }
+
+        res.append(buf, static_cast<std::size_t>(count));
+    }
+}
+
+
+/// Processes shard in worker process, writes status and result to pipe and exits
+/// without running destructors of objects inherited from parent process
+[[noreturn]] static void run_worker(int fd, const shard_executor::shard_function & fn,
+                                   const std::vector<fs::path> & tus) {
+    std::ostringstream ostr;
+    try {
+        auto res = fn(tus);
+        ostr.put(static_cast<char>(shard_status::ok));
+        write_action_result(ostr, res);
+    }
+    catch (const source_not_found_error & err) {
+        ostr.put(static_cast<char>(shard_status::source_not_found));
+        ostr << err.what();
+    }
+    catch (const std::exception & err) {
+        ostr.put(static_cast<char>(shard_status::error));
+        ostr << err.what();
+    }
+    catch (...) {
+        ostr.put(static_cast<char>(shard_status::error));
+        ostr << "unknown error";
+    }
+
+    std::cerr.flush();
+    auto ok = write_all(fd, ostr.view());
+    ::close(fd);
+    ::_exit(ok ? 0 : 1);
+}
+
+
+/// Forked worker process. Closes read end of pipe and waits for process on destruction,
+/// so workers are not left running when parent fails
+struct worker_process {
+    pid_t pid = -1;                         ///< Process identifier
+    int fd = -1;                            ///< Read end of result pipe
+
+    /// Closes pipe and waits for process, returns status of process
+    int wait() {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+
+        int status = 0;
+        if (pid > 0) {
+            while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+            pid = -1;
+        }
+
+        return status;
+    }
+
+    ~worker_process() { wait(); }
+};
+
+
+shard_executor::shard_executor(std::size_t shards, shard_function fn):
+shards_{std::max<std::size_t>(shards, 1)}, fn_{std::move(fn)} {}
+
+
+action_result shard_executor::run(const std::vector<fs::path> & inputs) {
+    errors_.clear();
+
+    auto shards_count = std::min(shards_, inputs.size());
+    if (shards_count == 0) {
+        return action_result{};
+    }
+
+    std::vector<std::vector<fs::path>> shards(shards_count);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        shards[i % shards_count].push_back(inputs[i]);
+    }
+
+    // buffered output is flushed, otherwise it would be written by workers again
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    std::deque<worker_process> workers;
+    for (auto && tus : shards) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            throw_errno("can't create pipe for shard worker");
+        }
+
+        auto pid = ::fork();
+        if (pid < 0) {
+            ::close(fds[0]);
+            ::close(fds[1]);
+            throw_errno("can't fork shard worker");
+        }
+
+        if (pid == 0) {
+            ::close(fds[0]);
+            for (auto && w : workers) {
+                ::close(w.fd);
+            }
+
+            run_worker(fds[1], fn_, tus);
+        }
+
+        ::close(fds[1]);
+        workers.emplace_back(pid, fds[0]);
+    }
+
+    // reading results of shards in order, workers wait for reader only when pipe is full
+    action_result res;
+    std::size_t found_count = 0;
+    std::string not_found_msg;
+    for (std::size_t s = 0; s < shards_count; ++s) {
+        auto data = read_all(workers[s].fd);
+        auto status = workers[s].wait();
+
+        std::ostringstream err;
+        if (WIFSIGNALED(status)) {
+            err << "worker terminated by signal " << WTERMSIG(status);
+        }
+        else if (WEXITSTATUS(status) != 0 || data.empty()) {
+            err << "worker exited with status " << WEXITSTATUS(status);
+        }
+        else {
+            std::string_view payload{data};
+            payload.remove_prefix(1);
+            switch (static_cast<shard_status>(data.front())) {
+            case shard_status::ok:
+                try {
+                    res.merge(read_action_result(payload));
+                    refactor_stats::global().add(stats_counter::tus_processed, shards[s].size());
+                    ++found_count;
+                }
+                catch (const std::exception & e) {
+                    err << e.what();
+                }
+
+                break;
+
+            case shard_status::source_not_found:
+                not_found_msg = payload;
+                break;
+
+            default:
+                err << payload;
+                break;
+            }
+        }
+
+        if (!err.view().empty()) {
+            std::ostringstream msg;
+            msg << "shard " << s + 1 << " failed: " << err.view() << " (translation units:";
+            for (auto && tu : shards[s]) {
+                msg << ' ' << tu.string();
+            }
+
+            msg << ')';
+            errors_.push_back(msg.str());
+        }
+    }
+
+    if (found_count == 0) {
+        if (errors_.empty()) {
+            throw source_not_found_error{not_found_msg};
+        }
+
+        std::ostringstream msg;
+        msg << "all shards failed or skipped:";
+        for (auto && err : errors_) {
+            msg << '\n' << err;
+        }
+
+        throw std::runtime_error{msg.str()};
+    }
+
+    return res;
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file shard_executor.hpp
+/// Contains definition of the shard_executor class.
+
+#pragma once
+
+#include "action_result.hpp"
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+/// Executes refactor action over translation units in multiple worker processes.
+/// Translation units are distributed between shards, each shard is processed by
+/// forked process, which sends serialized result back to parent over pipe. Results
+/// of shards are merged in parent. Each process has its own heap, so memory of
+/// parsers is not limited by single address space and allocator is not shared
+/// between shards. Crash of worker process loses only results of its shard.
+///
+/// Worker processes are forked from calling process, so executor must be run before
+/// any threads are started (thread pools, asynchronous log writers).
+class shard_executor {
+public:
+    /// Function processing translation units of shard in worker process
+    using shard_function = std::function<action_result(const std::vector<std::filesystem::path> &)>;
+
+    /// Constructs executor with specified number of shards and function processing shard
+    explicit shard_executor(std::size_t shards, shard_function fn);
+
+    /// Runs function over shards of translation units and returns merged results of shards.
+    /// Translation units are distributed between shards round robin. Throws exception if
+    /// all shards failed or none of shards found source referenced by action arguments
+    action_result run(const std::vector<std::filesystem::path> & inputs);
+
+    /// Returns descriptions of errors of failed shards in the last run
+    const auto & errors() const { return errors_; }
+
+private:
+    std::size_t shards_;                    ///< Number of shards
+    shard_function fn_;                     ///< Function processing shard
+    std::vector<std::string> errors_;       ///< Errors of failed shards
+};
@@ -9,38 +9,106 @@
 
 #pragma once
 
-#include "source_modification.hpp"
+#include "compact_modification.hpp"
 #include <map>
 
 
-/// Represents list of modifications in a single source file
+/// Represents list of modifications in a single source file. Modifications are
+/// ordered by byte offsets of their start positions. Line/column modifications
+/// are converted to offsets with line index of source file
 class single_source_modifications {
 public:
-    /// Constructs empty list of modifications
-    explicit single_source_modifications() = default;
+    /// Constructs empty list of modifications for source file with specified line index
+    explicit single_source_modifications(std::shared_ptr<const line_index> idx = nullptr):
+        index_{std::move(idx)} {}
 
-    /// Adds modification. Checks for overlapping with existing modifications
-    void add(const source_modification & mod) {
-        auto it = mods_.lower_bound(mod.range().start());
+    /// Adds modification. Checks for overlapping with existing modifications and
+    /// for existing modification starting at the same offset
+    void add(const compact_modification & mod) {
+        auto it = mods_.lower_bound(mod.start());
         if (it != mods_.end()) {
             // checking for modification range intersection
-            if (mod.range().end() > it->first) {
-                std::ostringstream msg;
-                msg << "intersecting modifications are not supported";
-                throw std::runtime_error{msg.str()};
+            if (mod.end() > it->first || it->first == mod.start()) {
+                throw_intersecting();
+            }
+        }
+
+        if (it != mods_.begin()) {
+            // checking for intersection with previous modification
+            if (std::prev(it)->second.end() > mod.start()) {
+                throw_intersecting();
             }
         }
 
-        mods_.emplace(mod.range().start(), mod);
+        mods_.emplace_hint(it, mod.start(), mod);
+    }
+
+    /// Appends modification which starts after all existing modifications. Faster than
+    /// add for modifications sorted by start offsets, they are inserted at end of list
+    void append(compact_modification && mod) {
+        if (!mods_.empty()) {
+            auto & last = mods_.rbegin()->second;
+            if (last.end() > mod.start() || last.start() >= mod.start()) {
+                throw_intersecting();
+            }
+        }
+
+        auto start = mod.start();
+        mods_.emplace_hint(mods_.end(), start, std::move(mod));
+    }
+
+    /// Adds line/column modification. Requires line index of source file
+    void add(const source_modification & mod) {
+        if (index_ == nullptr) {
+            std::ostringstream msg;
+            msg << "can't add modification at (" << mod.range().start().line() << ", "
+                << mod.range().start().column() << ") without line index of source file";
+            throw std::runtime_error{msg.str()};
+        }
+
+        add(compact_modification{mod, *index_});
     }
 
-    /// Returns range of source modifications ordered by start positions
+    /// Adds all modifications from another list. Modifications identical to existing
+    /// ones are skipped, other overlapping modifications are reported as errors
+    void merge(const single_source_modifications & other) {
+        if (index_ == nullptr) {
+            index_ = other.index_;
+        }
+
+        for (auto && [start, mod] : other.mods_) {
+            auto it = mods_.find(start);
+            if (it != mods_.end() && it->second == mod) {
+                continue;
+            }
+
+            add(mod);
+        }
+    }
+
+    /// Returns line index of source file, may be nullptr
+    const auto & index() const { return index_; }
+
+    /// Returns number of modifications
+    std::size_t size() const { return mods_.size(); }
+
+    /// Returns true if there are no modifications
+    bool empty() const { return mods_.empty(); }
+
+    /// Returns range of source modifications ordered by start offsets
     auto mods() const {
-        auto fn = [](const auto & pair) -> const source_modification & { return pair.second; };
+        auto fn = [](const auto & pair) -> const compact_modification & { return pair.second; };
         return mods_ | std::ranges::views::transform(fn);
     }
 
 private:
-    /// Map of modifications
-    std::map<cm::src::source_position, source_modification> mods_;
+    /// Throws exception about intersecting modifications
+    [[noreturn]] static void throw_intersecting() {
+        std::ostringstream msg;
+        msg << "intersecting modifications are not supported";
+        throw std::runtime_error{msg.str()};
+    }
+
+    std::shared_ptr<const line_index> index_;                   ///< Line index of source file
+    std::map<source_offset, compact_modification> mods_;        ///< Map of modifications
 };
@@ -32,6 +32,13 @@ public:
     /// Sets insert string for modification
     void set_insert_string(const std::string & s) { insert_str_ = s; }
 
+    /// Returns true if modifications have the same range and insert string
+    bool operator==(const source_modification & other) const {
+        return range_.start() == other.range_.start() &&
+               range_.end() == other.range_.end() &&
+               insert_str_ == other.insert_str_;
+    }
+
 private:
     cm::src::source_range range_;           ///< Modification range
     std::string insert_str_;                ///< Insert string for modification
@@ -8,8 +8,11 @@
 /// Contains implementation of the source_modification_action class.
 
 #include "source_modification_action.hpp"
+#include "refactor_stats.hpp"
+#include "symbol_prefilter.hpp"
 #include "source_rewriter.hpp"
-#include <fstream>
+#include <algorithm>
+#include <iostream>
 
 
 namespace po = boost::program_options;
@@ -23,8 +26,25 @@ boost::program_options::options_description source_modification_action::opts() c
 }
 
 
-void source_modification_action::perform(const cm::src::source_code_model & cm,
-                                         const boost::program_options::variables_map & opts) const {
+std::optional<std::filesystem::path>
+source_modification_action::target_source(const boost::program_options::variables_map & opts) const {
+    auto pos_str = opts["position"].as<std::string>();
+    return cm::src::source_file_position_desc::from_string(pos_str).path();
+}
+
+
+std::optional<std::string>
+source_modification_action::target_spelling(const boost::program_options::variables_map & opts) const {
+    auto pos_str = opts["position"].as<std::string>();
+    auto pos_desc = cm::src::source_file_position_desc::from_string(pos_str);
+    return identifier_at(pos_desc.path(), pos_desc.pos());
+}
+
+
+multi_source_modifications
+source_modification_action::collect_mods(const cm::src::source_code_model & cm,
+                                         const boost::program_options::variables_map & opts,
+                                         thread_pool & pool) const {
     // parsing source position
     auto pos_str = opts["position"].as<std::string>();
     auto pos_desc = cm::src::source_file_position_desc::from_string(pos_str);
@@ -34,28 +54,62 @@ void source_modification_action::perform(const cm::src::source_code_model & cm,
     if (src == nullptr) {
         std::ostringstream msg;
         msg << "can't find source file: '" << pos_desc.path() << "' in code model";
-        throw std::runtime_error{msg.str()};
+        throw source_not_found_error{msg.str()};
     }
 
     cm::src::source_file_position pos{src->cm_src(), pos_desc.pos()};
 
     // performing modification refactor action
-    auto mods = perform_mod(cm, src, pos.pos());
-    assert(!mods.mods().empty() && "refactor action returned empty set of modifications");
+    stats_phase phase{"collect-mods"};
+    memory_scope mem_scope{memory_subsystem::modifications};
+    auto mods = perform_mod(cm, src, pos.pos(), pool);
 
-    // printing output source
+    for (auto && [path, smods] : mods.mods()) {
+        refactor_stats::global().add(stats_counter::edits_produced, smods.size());
+    }
 
-    assert(mods.mods().size() == 1 && "multi source modifications are not supported yet");
-    auto & src_mods = mods.mods().begin()->second;
+    return mods;
+}
 
-    auto src_path_str = src->cm_src()->path().string();
-    std::ifstream istr{src_path_str};
-    if (!istr.is_open()) {
-        std::ostringstream msg;
-        msg << "can't open input source file for reading: " << src_path_str;
-        throw std::runtime_error(msg.str());
+
+action_result
+source_modification_action::extract(const cm::src::source_code_model & cm,
+                                    const boost::program_options::variables_map & opts) const {
+    return action_result{collect_mods(cm, opts, thread_pool::global())};
+}
+
+
+void source_modification_action::output(const action_result & res,
+                                        const boost::program_options::variables_map &) const {
+    assert(!res.mods().empty() && "refactor action returned empty set of modifications");
+    write_sources(res.mods(), std::cout);
+}
+
+
+void source_modification_action::write_sources(const multi_source_modifications & mods,
+                                               std::ostream & ostr) {
+    // printing output sources ordered by paths, identifiers depend on interning order
+    std::vector<std::pair<const std::filesystem::path *, const single_source_modifications *>> srcs;
+    for (auto && [file, src_mods] : mods.mods()) {
+        srcs.emplace_back(&multi_source_modifications::path(file), &src_mods);
     }
 
-    source_rewriter rw;
-    rw.rewrite(src_mods, istr, std::cout);
+    std::ranges::sort(srcs, [](auto && x, auto && y) { return *x.first < *y.first; });
+
+    // rewriting sources in parallel, output is printed in order of paths
+    std::vector<std::string> outputs(srcs.size());
+    thread_pool::global().parallel_for(srcs.size(), [&](std::size_t idx) {
+        std::ostringstream src_ostr;
+        source_rewriter rw;
+        rw.rewrite(*srcs[idx].second, *srcs[idx].first, src_ostr);
+        outputs[idx] = std::move(src_ostr).str();
+    });
+
+    for (std::size_t i = 0; i < srcs.size(); ++i) {
+        if (srcs.size() > 1) {
+            ostr << "==> " << srcs[i].first->string() << " <==" << std::endl;
+        }
+
+        ostr << outputs[i];
+    }
 }
@@ -11,6 +11,8 @@
 
 #include "multi_source_modifications.hpp"
 #include "refactor_action.hpp"
+#include "thread_pool.hpp"
+#include <ostream>
 
 
 /// Source modification refactor action
@@ -19,14 +21,40 @@ public:
     /// Constructs and returns options description for this action
     boost::program_options::options_description opts() const override;
 
-    /// Performs action
-    void perform(const cm::src::source_code_model & cm,
-                 const boost::program_options::variables_map & opts) const override;
+    /// Returns source file of symbol position
+    std::optional<std::filesystem::path>
+    target_source(const boost::program_options::variables_map & opts) const override;
+
+    /// Returns spelling of identifier at symbol position
+    std::optional<std::string>
+    target_spelling(const boost::program_options::variables_map & opts) const override;
+
+    /// Extracts source modifications
+    action_result extract(const cm::src::source_code_model & cm,
+                          const boost::program_options::variables_map & opts) const override;
+
+    /// Prints modified sources to standard output. Each source is preceded by
+    /// header with source path if multiple sources are modified
+    void output(const action_result & res,
+                const boost::program_options::variables_map & opts) const override;
+
+    /// Rewrites modified sources in parallel and writes them to output stream in order
+    /// of paths. Each source is preceded by header with source path if multiple sources
+    /// are modified
+    static void write_sources(const multi_source_modifications & mods, std::ostream & ostr);
+
+    /// Resolves source position from options and collects source modifications
+    /// using specified thread pool
+    multi_source_modifications
+    collect_mods(const cm::src::source_code_model & cm,
+                 const boost::program_options::variables_map & opts,
+                 thread_pool & pool) const;
 
 private:
     /// Performs action. Returns sources modifications
     virtual multi_source_modifications
     perform_mod(const cm::src::source_code_model & cm,
                 const cm::src::source_file * src_file,
-                const cm::src::source_position & pos) const = 0;
+                const cm::src::source_position & pos,
+                thread_pool & pool) const = 0;
 };
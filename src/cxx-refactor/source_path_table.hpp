@@ -0,0 +1,97 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file source_path_table.hpp
+/// Contains definition of the source_path_table class.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <shared_mutex>
+#include <system_error>
+#include <unordered_map>
+
+
+/// Identifier of interned source file path
+using file_id = std::uint32_t;
+
+
+/// Table of interned source file paths. Maps paths to small integer identifiers
+/// and back. Paths are canonicalized when they are interned for the first time
+/// (relative paths are made absolute, symbolic links and dot components are
+/// resolved), so different spellings of the same file get the same identifier.
+/// All member functions are thread safe.
+class source_path_table {
+public:
+    /// Constructs empty table
+    explicit source_path_table() = default;
+
+    /// Returns reference to process wide path table
+    static source_path_table & global() {
+        static source_path_table table;
+        return table;
+    }
+
+    /// Returns identifier of specified path. Adds canonical path to table if it's not
+    /// interned yet
+    file_id intern(const std::filesystem::path & p) {
+        auto key = p.native();
+
+        {
+            std::shared_lock lock{mtx_};
+            auto it = ids_.find(key);
+            if (it != ids_.end()) {
+                return it->second;
+            }
+        }
+
+        // canonicalizing outside of lock, it may access file system
+        auto canon = canonical(p);
+
+        std::unique_lock lock{mtx_};
+        auto [canon_it, inserted] = ids_.emplace(canon.native(), static_cast<file_id>(paths_.size()));
+        if (inserted) {
+            paths_.push_back(canon);
+        }
+
+        auto id = canon_it->second;
+        ids_.emplace(std::move(key), id);
+        return id;
+    }
+
+    /// Returns canonical path for specified identifier
+    const std::filesystem::path & path(file_id id) const {
+        std::shared_lock lock{mtx_};
+        return paths_.at(id);
+    }
+
+    /// Returns number of interned paths
+    std::size_t size() const {
+        std::shared_lock lock{mtx_};
+        return paths_.size();
+    }
+
+private:
+    /// Returns canonical form of specified path. Nonexistent trailing path components
+    /// are normalized lexically
+    static std::filesystem::path canonical(const std::filesystem::path & p) {
+        std::error_code ec;
+        auto res = std::filesystem::weakly_canonical(p, ec);
+        if (ec) {
+            return std::filesystem::absolute(p, ec).lexically_normal();
+        }
+
+        return res.is_absolute() ? res : std::filesystem::absolute(res, ec);
+    }
+
+    mutable std::shared_mutex mtx_;                             ///< Table mutex
+    std::unordered_map<std::filesystem::path::string_type,
+                       file_id> ids_;                           ///< Path spelling to identifier map
+    std::deque<std::filesystem::path> paths_;                   ///< Canonical paths (stable references)
+};
@@ -9,111 +9,82 @@
 
 #include "pch.hpp"
 #include "source_rewriter.hpp"
+#include "refactor_stats.hpp"
 #include <fstream>
 
 
-/// Input stream with position
-class istream_with_position {
-public:
-    explicit istream_with_position(std::istream & s):
-    str_{s}, ch_{0} {
-        pos_.set_line(1);
-        pos_.set_column(1);
-        str_.read(&ch_, 1);
+/// Throws exception about modification location missing in source code
+[[noreturn]] static void throw_missing_location(const char * what,
+                                                source_offset off,
+                                                const single_source_modifications & smods) {
+    std::ostringstream msg;
+    msg << "can't find modification " << what << " location in source code: ";
+    if (smods.index() != nullptr && off <= smods.index()->size()) {
+        auto pos = smods.index()->position(off);
+        msg << "(" << pos.line() << ", " << pos.column() << ")";
+    } else {
+        msg << "offset " << off;
     }
 
-    /// Reads next character from input stream and increases current position.
-    void read_next() {
-        if (ch_ == '\n') {
-            pos_.set_line(pos_.line() + 1);
-            pos_.set_column(1);
-        } else {
-            pos_.set_column(pos_.column() + 1);
-        }
+    throw std::runtime_error{msg.str()};
+}
 
-        str_.read(&ch_, 1);
-    }
 
-    /// Returns current character
-    char ch() const { return ch_; }
+/// Writes source text with applied modifications to output stream
+static void rewrite_text(const single_source_modifications & smods,
+                         std::string_view text,
+                         std::ostream & ostr) {
+    std::size_t bytes_written = 0;
+
+    // copying source segments between modifications and writing insert strings
+    std::size_t pos = 0;
+    for (auto && mod : smods.mods()) {
+        if (mod.start() > text.size()) {
+            throw_missing_location("start", mod.start(), smods);
+        }
+
+        if (mod.end() > text.size()) {
+            throw_missing_location("end", mod.end(), smods);
+        }
 
-    /// Returns current position
-    const auto & pos() { return pos_; }
+        ostr.write(text.data() + pos, mod.start() - pos);
+        ostr << mod.insert_string();
+        bytes_written += mod.start() - pos + mod.insert_string().size();
+        pos = mod.end();
+    }
 
-    /// Returns true if EOF is reached
-    bool eof() const { return str_ ? false : true; }
+    ostr.write(text.data() + pos, text.size() - pos);
+    bytes_written += text.size() - pos;
 
-private:
-    std::istream & str_;                    ///< Reference to input stream
-    char ch_;                               ///< Current character
-    cm::src::source_position pos_;          ///< Current position
-};
+    auto & stats = refactor_stats::global();
+    stats.add(stats_counter::bytes_read, text.size());
+    stats.add(stats_counter::bytes_written, bytes_written);
+}
 
 
 void source_rewriter::rewrite(const single_source_modifications & smods,
                               std::istream & str,
                               std::ostream & ostr) {
 
-    istream_with_position istr{str};
-
-    auto mods = smods.mods();
-    auto mod_it = std::ranges::begin(mods);
-
-    // processing all data from input source
-    while (!istr.eof()) {
-        while (mod_it != mods.end()) {
-            auto mod_start = (*mod_it).range().start();
-            auto mod_end = (*mod_it).range().end();
-
-            if (istr.pos() == mod_start) {
-                // skipping source characters until the end of modification range
-                while (istr.pos() != mod_end) {
-                    istr.read_next();
-
-                    // checking for missing modification end location in source code
-                    if (istr.eof() || istr.pos() > mod_end) {
-                        std::ostringstream msg;
-                        msg << "can't find modification end location in source code: ("
-                            << mod_end.line() << ", " << mod_end.column() << ")";
-                        throw std::runtime_error{msg.str()};
-                    }
-                }
-
-                // writing modification string to output
-                ostr << (*mod_it).insert_string();
-
-                // moving to the next modification
-                ++mod_it;
-            } else {
-                // checking for misssing modification start location in source code
-                if (istr.pos() > mod_start) {
-                    std::ostringstream msg;
-                    msg << "can't find modification start location in source code: ("
-                        << mod_start.line() << ", " << mod_start.column() << ")";
-                    throw std::runtime_error{msg.str()};
-                }
-
-                // exiting from modifications loop to write current character
-                break;
-            }
-        }
-
-        // writing current character to output stream
-        auto c = istr.ch();
-        ostr.write(&c, 1);
+    stats_phase phase{"rewrite"};
+    memory_scope mem_scope{memory_subsystem::output};
 
-        // reading next character
-        istr.read_next();
+    // reading whole input source
+    std::ostringstream text_str;
+    if (str.peek() != std::istream::traits_type::eof()) {
+        text_str << str.rdbuf();
     }
 
-    // checking that we found all modification locations
-    if (mod_it != std::ranges::end(mods)) {
-        std::ostringstream msg;
-        msg << "can't find modification start location in source code: ("
-            << (*mod_it).range().start().line() << ", "
-            << (*mod_it).range().start().column() << ")";
-        throw std::runtime_error{msg.str()};
-    }
+    rewrite_text(smods, text_str.view(), ostr);
+}
+
+
+void source_rewriter::rewrite(const single_source_modifications & smods,
+                              std::string_view text,
+                              std::ostream & ostr) {
+    stats_phase phase{"rewrite"};
+    memory_scope mem_scope{memory_subsystem::output};
+    rewrite_text(smods, text, ostr);
 }
 
 
@@ -128,7 +99,5 @@ void source_rewriter::rewrite(const single_source_modifications & smods,
         throw std::runtime_error{msg.str()};
     }
 
-    file.unsetf(std::ios::skipws);
-
     rewrite(smods, file, ostr);
 }
@@ -13,6 +13,7 @@
 #include "source_modification.hpp"
 #include <filesystem>
 #include <map>
+#include <string_view>
 
 
 /// Source rewriter
@@ -25,6 +26,11 @@ public:
                  std::istream & istr,
                  std::ostream & ostr);
 
+    /// Rewrites single source from text in memory to output stream
+    void rewrite(const single_source_modifications & mods,
+                 std::string_view text,
+                 std::ostream & ostr);
+
     /// Rewrites single source from file located at specified path to output stream
     void rewrite(const single_source_modifications & mods,
                  const std::filesystem::path & input,
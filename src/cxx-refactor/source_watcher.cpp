@@ -0,0 +1,169 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file source_watcher.cpp
+/// Contains implementation of the source_watcher class.
+
+#include "pch.hpp"
+#include "source_watcher.hpp"
+#include "log/log.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+
+// logging functions
+#define SW_WARNING REFACTOR_LOG_SCAT_WARNING(refactor, source-watcher)
+
+
+namespace fs = std::filesystem;
+
+
+/// Events of files and directories reported by watcher
+static constexpr std::uint32_t watch_events =
+    IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+
+
+/// Interval of checking for stop request while waiting for the first event
+static constexpr std::chrono::milliseconds stop_check_interval{200};
+
+
+source_watcher::source_watcher(const std::vector<fs::path> & dirs) {
+    fd_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd_ < 0) {
+        std::ostringstream msg;
+        msg << "can't create inotify instance: " << std::strerror(errno);
+        throw std::runtime_error{msg.str()};
+    }
+
+    try {
+        for (auto && dir : dirs) {
+            add_watch(dir, true);
+        }
+    }
+    catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+
+source_watcher::~source_watcher() {
+    ::close(fd_);
+}
+
+
+void source_watcher::add_watch(const fs::path & dir, bool required) {
+    auto wd = ::inotify_add_watch(fd_, dir.c_str(), watch_events | IN_ONLYDIR);
+    if (wd < 0) {
+        std::ostringstream msg;
+        msg << "can't watch directory " << dir << ": " << std::strerror(errno);
+        if (required) {
+            throw std::runtime_error{msg.str()};
+        }
+
+        // directories removed after they were found are skipped silently
+        if (errno != ENOENT && errno != ENOTDIR) {
+            SW_WARNING << msg.str();
+        }
+
+        return;
+    }
+
+    dirs_[wd] = dir;
+
+    std::error_code ec;
+    for (auto && entry : fs::directory_iterator{dir, ec}) {
+        if (entry.is_directory(ec) && !entry.is_symlink(ec)) {
+            add_watch(entry.path(), false);
+        }
+    }
+}
+
+
+bool source_watcher::read_events(std::chrono::milliseconds timeout, source_changes & changes) {
+    pollfd pfd{fd_, POLLIN, 0};
+    auto ready = ::poll(&pfd, 1, static_cast<int>(timeout.count()));
+    if (ready <= 0) {
+        return false;
+    }
+
+    alignas(inotify_event) char buf[16384];
+    for (;;) {
+        auto len = ::read(fd_, buf, sizeof(buf));
+        if (len <= 0) {
+            break;
+        }
+
+        for (char * ptr = buf; ptr < buf + len;) {
+            auto ev = reinterpret_cast<const inotify_event *>(ptr);
+            ptr += sizeof(inotify_event) + ev->len;
+
+            // events were dropped by kernel, changed files are unknown
+            if ((ev->mask & IN_Q_OVERFLOW) != 0) {
+                SW_WARNING << "inotify event queue overflow, changes of files are lost";
+                changes.overflow = true;
+                continue;
+            }
+
+            // watch is removed by kernel when directory is deleted
+            if ((ev->mask & IN_IGNORED) != 0) {
+                dirs_.erase(ev->wd);
+                continue;
+            }
+
+            auto dir_it = dirs_.find(ev->wd);
+            if (dir_it == dirs_.end() || ev->len == 0) {
+                continue;
+            }
+
+            auto path = dir_it->second / ev->name;
+            if ((ev->mask & IN_ISDIR) != 0) {
+                // new directories are watched, files created in them before watch is
+                // added are not reported
+                if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+                    std::error_code ec;
+                    if (fs::is_directory(path, ec)) {
+                        add_watch(path, false);
+                    }
+                }
+
+                continue;
+            }
+
+            changes.files.push_back(std::move(path));
+        }
+    }
+
+    return true;
+}
+
+
+source_changes source_watcher::wait_changes(std::chrono::milliseconds debounce,
+                                            std::stop_token stop) {
+    source_changes changes;
+    while (changes.empty()) {
+        if (stop.stop_requested()) {
+            return {};
+        }
+
+        read_events(stop_check_interval, changes);
+    }
+
+    // collecting events until there are no new events during debounce interval
+    while (!stop.stop_requested() && read_events(debounce, changes)) {}
+
+    auto & files = changes.files;
+    std::ranges::sort(files);
+    auto dups = std::ranges::unique(files);
+    files.erase(dups.begin(), dups.end());
+    return changes;
+}
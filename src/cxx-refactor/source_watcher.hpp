@@ -0,0 +1,63 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file source_watcher.hpp
+/// Contains definition of the source_watcher class.
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <stop_token>
+#include <unordered_map>
+#include <vector>
+
+
+/// Changes of sources reported by watcher
+struct source_changes {
+    std::vector<std::filesystem::path> files;   ///< Sorted paths of changed files
+    bool overflow = false;                      ///< Events were lost, any file may be changed
+
+    /// Returns true if there are no changes
+    bool empty() const { return files.empty() && !overflow; }
+};
+
+
+/// Watches source directories for changes of files with inotify. Directories are
+/// watched recursively, subdirectories created later are watched too. Changes are
+/// debounced: bursts of events (editors saving via temporary files, checkouts) are
+/// collected into one set of changed files.
+class source_watcher {
+public:
+    /// Constructs watcher for specified directories. Throws exception if inotify
+    /// instance can't be created or directory can't be watched
+    explicit source_watcher(const std::vector<std::filesystem::path> & dirs);
+
+    /// Closes inotify instance
+    ~source_watcher();
+
+    source_watcher(const source_watcher &) = delete;
+    source_watcher & operator=(const source_watcher &) = delete;
+
+    /// Waits for changes and returns paths of changed files. After the first event
+    /// waits until there are no new events during debounce interval. Overflow of event
+    /// queue is reported as change of unknown files. Returns empty changes if stop
+    /// is requested
+    source_changes wait_changes(std::chrono::milliseconds debounce, std::stop_token stop);
+
+private:
+    /// Adds watch for directory and all its subdirectories. Throws exception if
+    /// directory can't be watched and it's required, otherwise logs warning and skips
+    /// it. Subdirectories are never required, they may be removed while they are added
+    void add_watch(const std::filesystem::path & dir, bool required);
+
+    /// Reads available events and adds them to changes. Waits for events for
+    /// specified time. Returns false if there were no events
+    bool read_events(std::chrono::milliseconds timeout, source_changes & changes);
+
+    int fd_ = -1;                                               ///< Inotify instance
+    std::unordered_map<int, std::filesystem::path> dirs_;       ///< Watched directories
+};
@@ -0,0 +1,249 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file streaming_executor.cpp
+/// Contains implementation of the streaming_executor class.
+
+#include "pch.hpp"
+#include "streaming_executor.hpp"
+#include "cancellation.hpp"
+#include "concurrent_source_modifications.hpp"
+#include "memory_accounting.hpp"
+#include "refactor_stats.hpp"
+#include <cm/src/cxx/clang/cmsrcclang.hpp>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <sstream>
+
+
+namespace fs = std::filesystem;
+
+
+/// Compiler arguments passed to parser
+static std::vector<std::string> parse_args;
+
+
+void set_parse_args(std::vector<std::string> args) {
+    parse_args = std::move(args);
+}
+
+
+/// Rethrows exception thrown while arena was current as exception of the same kind
+/// with message copied to regular heap, so it can be reported after arena is released.
+/// Original exception is destroyed while arena is still alive
+[[noreturn]] static void rethrow_out_of_arena(const fs::path & input) {
+    arena_suspend no_arena;
+    try {
+        throw;
+    }
+    catch (const cancelled_error & err) {
+        throw cancelled_error{err.what()};
+    }
+    catch (const std::exception & err) {
+        throw std::runtime_error{err.what()};
+    }
+    catch (...) {
+        std::ostringstream msg;
+        msg << "unknown error while parsing " << input;
+        throw std::runtime_error{msg.str()};
+    }
+}
+
+
+std::unique_ptr<cm::src::source_code_model> parse_tu(const fs::path & input, memory_arena * arena) {
+    stats_phase phase{"parse"};
+    memory_scope mem_scope{memory_subsystem::code_model};
+
+    // arena is current only while code model is built, allocations of statistics
+    // and trace events of phase are made outside of it
+    std::optional<arena_scope> arena_sc;
+    if (arena) {
+        arena_sc.emplace(*arena);
+    }
+
+    auto cm = std::make_unique<cm::src::source_code_model>();
+    try {
+        cm::src::clang::parse_source_file(*cm, input, parse_args);
+    }
+    catch (...) {
+        // message of parse error is allocated in arena
+        if (arena) {
+            rethrow_out_of_arena(input);
+        }
+
+        throw;
+    }
+
+    return cm;
+}
+
+
+void release_tu(std::unique_ptr<cm::src::source_code_model> cm, memory_arena * arena) {
+    stats_phase phase{"release"};
+    memory_scope mem_scope{memory_subsystem::code_model};
+    cm.reset();
+    if (arena) {
+        arena->release();
+    }
+}
+
+
+/// Parses translation unit, extracts action result and releases code model.
+/// Code model is allocated in arena if arena is specified
+static action_result process_tu(const refactor_action & action,
+                                const fs::path & input,
+                                const boost::program_options::variables_map & opts,
+                                memory_arena * arena) {
+    auto cm = parse_tu(input, arena);
+
+    action_result res;
+    {
+        stats_phase phase{"action"};
+        res = action.extract(*cm, opts);
+    }
+
+    // releasing AST and clang state of translation unit
+    release_tu(std::move(cm), arena);
+
+    refactor_stats::global().add(stats_counter::tus_processed, 1);
+    return res;
+}
+
+
+streaming_executor::streaming_executor(std::size_t concurrency, const arena_options & arena,
+                                       thread_pool & pool):
+concurrency_{concurrency}, arena_{arena}, pool_{pool} {}
+
+
+action_result streaming_executor::run(const refactor_action & action,
+                                      const std::vector<fs::path> & inputs,
+                                      const boost::program_options::variables_map & opts) const {
+    auto run_start = std::chrono::steady_clock::now();
+    auto busy_start = pool_.busy_time();
+
+    // ordering translation units by decreasing cost if hints are available
+    std::vector<std::size_t> order(inputs.size());
+    std::iota(order.begin(), order.end(), 0);
+    if (hints_ != nullptr) {
+        order = hints_->order(inputs);
+    }
+
+    std::mutex mtx;
+    action_result res;
+    concurrent_source_modifications coll{pool_.size()};
+    std::vector<std::optional<action_result>> pending(inputs.size());
+    std::size_t next_merge = 0;
+    std::size_t found_count = 0;
+    std::size_t completed_count = 0;
+    std::exception_ptr not_found_err;
+
+    // processes translation unit with specified position in order of processing,
+    // in arena if it's specified. Modifications are added to buffer of task, the rest
+    // of result is merged in order of inputs. Translation units interrupted by
+    // cancellation produce no result
+    auto process = [&](std::size_t pos, bool use_arena,
+                       concurrent_source_modifications::buffer & buf) {
+        auto idx = order[pos];
+        auto tu_start = std::chrono::steady_clock::now();
+
+        std::optional<action_result> tu_res;
+        bool found = true;
+        try {
+            std::optional<memory_arena> arena;
+            if (use_arena) {
+                arena.emplace(arena_);
+            }
+
+            tu_res.emplace(process_tu(action, inputs[idx], opts, arena ? &*arena : nullptr));
+        } catch (const source_not_found_error &) {
+            std::lock_guard lock{mtx};
+            if (!not_found_err) {
+                not_found_err = std::current_exception();
+            }
+
+            tu_res.emplace();
+            found = false;
+        } catch (const cancelled_error &) {
+            return;
+        }
+
+        if (hints_ != nullptr) {
+            hints_->record(inputs[idx], std::chrono::steady_clock::now() - tu_start);
+        }
+
+        buf.add(tu_res->mods());
+        tu_res->mods() = multi_source_modifications{};
+
+        // merging results in order of inputs, results of translation units
+        // finished out of order are kept until preceding results are merged
+        std::lock_guard lock{mtx};
+        if (found) {
+            ++found_count;
+        }
+
+        ++completed_count;
+
+        pending[idx] = std::move(tu_res);
+        while (next_merge < pending.size() && pending[next_merge]) {
+            res.merge(std::move(*pending[next_merge]));
+            pending[next_merge].reset();
+            ++next_merge;
+        }
+    };
+
+    // each task takes translation units one by one until all are taken or operation
+    // is cancelled, so number of translation units in memory doesn't exceed number of tasks.
+    // In arena mode the first translation unit of each task is parsed without arena,
+    // so long-lived parser state of thread executing task is initialized in regular heap
+    std::atomic<std::size_t> next{0};
+    auto concurrency = concurrency_ == 0 ? pool_.size() : concurrency_;
+    auto tasks_count = std::min({concurrency, pool_.size(), inputs.size()});
+    pool_.parallel_for(tasks_count, [&](std::size_t) {
+        concurrent_source_modifications::buffer buf{coll};
+        auto warm = false;
+        for (auto pos = next++; pos < inputs.size() && !cancellation_requested(); pos = next++) {
+            process(pos, arena_.enabled && warm, buf);
+            warm = true;
+        }
+
+        buf.flush();
+    });
+
+    // reporting utilization of pool threads during run
+    auto & stats = refactor_stats::global();
+    auto wall = std::chrono::steady_clock::now() - run_start;
+    auto busy = pool_.busy_time() - busy_start;
+    stats.add(stats_counter::pool_busy_us,
+              std::chrono::duration_cast<std::chrono::microseconds>(busy).count());
+    stats.add(stats_counter::pool_capacity_us,
+              std::chrono::duration_cast<std::chrono::microseconds>(wall).count() * pool_.size());
+
+    // merging results of translation units completed before cancellation
+    if (completed_count != inputs.size()) {
+        stats.add(stats_counter::tus_cancelled, inputs.size() - completed_count);
+        if (!partial_) {
+            check_cancelled();
+        }
+
+        for (auto && tu_res : pending) {
+            if (tu_res) {
+                res.merge(std::move(*tu_res));
+            }
+        }
+
+        res.mods() = coll.merge(pool_);
+        return res;
+    }
+
+    if (found_count == 0 && not_found_err) {
+        std::rethrow_exception(not_found_err);
+    }
+
+    res.mods() = coll.merge(pool_);
+    return res;
+}
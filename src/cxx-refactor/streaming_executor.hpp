@@ -0,0 +1,90 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file streaming_executor.hpp
+/// Contains definition of the streaming_executor class.
+
+#pragma once
+
+#include "action_result.hpp"
+#include "memory_arena.hpp"
+#include "refactor_action.hpp"
+#include "thread_pool.hpp"
+#include "tu_cost_hints.hpp"
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/// Sets compiler arguments passed to parser of translation units, like include
+/// directories. Must be called before translation units are parsed
+void set_parse_args(std::vector<std::string> args);
+
+
+/// Parses translation unit located at specified path into new code model. Code model
+/// is allocated in arena if arena is specified, parse errors are rethrown with messages
+/// copied out of arena
+std::unique_ptr<cm::src::source_code_model> parse_tu(const std::filesystem::path & input,
+                                                     memory_arena * arena = nullptr);
+
+
+/// Releases code model of translation unit and memory arena it was allocated in
+void release_tu(std::unique_ptr<cm::src::source_code_model> cm, memory_arena * arena = nullptr);
+
+
+/// Executes refactor action over multiple translation units in streaming mode.
+/// Each translation unit is parsed into its own code model, action result is extracted
+/// into compact form and code model is released before the next translation unit is
+/// taken. Peak memory is bounded by number of concurrently processed translation units
+/// rather than by number of translation units.
+///
+/// In experimental arena mode code model of each translation unit is allocated in its own
+/// memory arena and released at once after result is extracted. Arena is current only
+/// while code model is built. The first translation unit of each task is parsed without
+/// arena, so long-lived objects created by parser on first use in each thread (caches,
+/// static registries, thread locals) are allocated in regular heap.
+///
+/// Translation units are processed by tasks of work stealing thread pool, which
+/// also executes parallel work of actions. With cost hints the most expensive
+/// translation units are taken first, costs measured in the run are recorded back
+/// into hints. Time threads of pool spend executing tasks is reported in statistics.
+/// Source modifications of translation units are fed by tasks into concurrent collector
+/// and merged on pool after all translation units are processed, messages are merged
+/// in order of inputs.
+///
+/// Translation units are not taken after cancellation token of calling thread is
+/// cancelled. Results of translation units completed before cancellation are returned
+/// in partial mode, otherwise cancelled_error is thrown.
+class streaming_executor {
+public:
+    /// Constructs executor processing specified number of translation units concurrently
+    /// with specified thread pool. Zero concurrency means number of threads of pool,
+    /// smaller values limit number of code models kept in memory
+    explicit streaming_executor(std::size_t concurrency = 0, const arena_options & arena = {},
+                                thread_pool & pool = thread_pool::global());
+
+    /// Sets hints of translation unit costs used for ordering translation units.
+    /// Hints must outlive executor
+    void set_cost_hints(tu_cost_hints * hints) { hints_ = hints; }
+
+    /// Sets partial mode, in which results completed before cancellation are returned
+    void set_partial(bool partial) { partial_ = partial; }
+
+    /// Runs action over translation units and returns results merged in order of
+    /// inputs. Translation units which do not contain source referenced by action
+    /// arguments are skipped, error is reported only if all translation units are skipped
+    action_result run(const refactor_action & action,
+                      const std::vector<std::filesystem::path> & inputs,
+                      const boost::program_options::variables_map & opts) const;
+
+private:
+    std::size_t concurrency_;               ///< Max number of concurrent TUs, 0 if unlimited
+    arena_options arena_;                   ///< Options of arena allocation mode
+    thread_pool & pool_;                    ///< Thread pool executing tasks
+    tu_cost_hints * hints_ = nullptr;       ///< Hints of translation unit costs
+    bool partial_ = false;                  ///< Return partial results on cancellation
+};
@@ -0,0 +1,288 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file symbol_prefilter.cpp
+/// Contains implementation of the symbol_prefilter class.
+
+#include "pch.hpp"
+#include "symbol_prefilter.hpp"
+#include "fnv_hash.hpp"
+#include "line_index.hpp"
+#include "refactor_stats.hpp"
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+namespace fs = std::filesystem;
+
+
+/// Header line of saved bitmap cache file
+static constexpr std::string_view cache_file_header = "cxx-refactor-prefilter 1";
+
+
+bool contains_substring(std::string_view text, std::string_view needle) {
+    if (needle.empty()) {
+        return true;
+    }
+
+    if (needle.size() > text.size()) {
+        return false;
+    }
+
+    auto last = text.size() - needle.size();
+    auto matches = [&](std::size_t i) {
+        return std::memcmp(text.data() + i, needle.data(), needle.size()) == 0;
+    };
+
+    std::size_t i = 0;
+
+#ifdef __SSE2__
+    // comparing first and last characters of needle with 16 candidate positions
+    // at once, full comparison is done only for positions where both match
+    auto first_ch = _mm_set1_epi8(needle.front());
+    auto last_ch = _mm_set1_epi8(needle.back());
+    for (; i + 16 <= last + 1; i += 16) {
+        auto first_block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i));
+        auto last_block = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(text.data() + i + needle.size() - 1));
+
+        auto eq = _mm_and_si128(_mm_cmpeq_epi8(first_ch, first_block),
+                                _mm_cmpeq_epi8(last_ch, last_block));
+
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        while (mask != 0) {
+            if (matches(i + std::countr_zero(mask))) {
+                return true;
+            }
+
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    for (; i <= last; ++i) {
+        if (text[i] == needle.front() && matches(i)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/// Returns true if character may be a part of identifier
+static bool is_ident_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+
+std::optional<std::string> identifier_at(const fs::path & p, const cm::src::source_position & pos) {
+    std::error_code ec;
+    if (!fs::is_regular_file(p, ec)) {
+        return std::nullopt;
+    }
+
+    mapped_file file{p};
+    auto text = file.text();
+
+    source_offset off = 0;
+    try {
+        off = line_index{text}.offset(pos);
+    }
+    catch (std::runtime_error &) {
+        return std::nullopt;
+    }
+
+    // extending identifier in both directions from position
+    auto start = off;
+    while (start > 0 && is_ident_char(text[start - 1])) {
+        --start;
+    }
+
+    auto end = off;
+    while (end < text.size() && is_ident_char(text[end])) {
+        ++end;
+    }
+
+    if (start == end) {
+        return std::nullopt;
+    }
+
+    return std::string{text.substr(start, end - start)};
+}
+
+
+std::size_t symbol_prefilter::token_bit(std::string_view token) {
+    return fnv1a_hash(token) % bitmap_bits;
+}
+
+
+bool symbol_prefilter::is_identifier(std::string_view s) {
+    return !s.empty() && std::ranges::all_of(s, is_ident_char);
+}
+
+
+bool symbol_prefilter::may_contain(file_id file, const std::string & spelling) {
+    auto & p = source_path_table::global().path(file);
+    auto stamp = file_stamp::of(p);
+    if (!stamp.exists) {
+        return false;
+    }
+
+    auto check_bitmap = is_identifier(spelling);
+    auto bit = check_bitmap ? token_bit(spelling) : 0;
+
+    auto it = cache_.find(file);
+    if (check_bitmap && it != cache_.end() && it->second.stamp == stamp &&
+        !it->second.tokens.test(bit)) {
+        return false;
+    }
+
+    mapped_file mfile{p};
+    auto text = mfile.text();
+
+    // building bitmap of identifier tokens if file is not cached or changed
+    if (cache_bitmaps_ && (it == cache_.end() || it->second.stamp != stamp)) {
+        file_tokens ft;
+        ft.stamp = stamp;
+
+        std::size_t i = 0;
+        while (i < text.size()) {
+            if (!is_ident_char(text[i])) {
+                ++i;
+                continue;
+            }
+
+            auto start = i;
+            while (i < text.size() && is_ident_char(text[i])) {
+                ++i;
+            }
+
+            ft.tokens.set(token_bit(text.substr(start, i - start)));
+        }
+
+        ++scanned_count_;
+        it = cache_.insert_or_assign(file, ft).first;
+        if (check_bitmap && !it->second.tokens.test(bit)) {
+            return false;
+        }
+    }
+
+    ++searched_count_;
+    return contains_substring(text, spelling);
+}
+
+
+std::vector<fs::path> symbol_prefilter::candidates(const std::vector<fs::path> & tus,
+                                                   const std::string & spelling,
+                                                   const include_graph & graph) {
+    stats_phase phase{"prefilter"};
+
+    // checking each file once, headers are shared by many translation units
+    std::unordered_map<file_id, bool> file_results;
+    std::vector<fs::path> res;
+    for (auto && tu : tus) {
+        // translation unit including unknown files may mention symbol in them
+        if (!graph.complete(tu)) {
+            res.push_back(tu);
+            continue;
+        }
+
+        for (auto file : graph.included_files(tu)) {
+            auto [it, inserted] = file_results.try_emplace(file, false);
+            if (inserted) {
+                it->second = may_contain(file, spelling);
+            }
+
+            if (it->second) {
+                res.push_back(tu);
+                break;
+            }
+        }
+    }
+
+    refactor_stats::global().add(stats_counter::tus_prefiltered, tus.size() - res.size());
+    return res;
+}
+
+
+void symbol_prefilter::load(const fs::path & p) {
+    std::ifstream istr{p};
+    if (!istr.is_open()) {
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(istr, line) || line != cache_file_header) {
+        std::ostringstream msg;
+        msg << "invalid pre-filter cache file: " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    // each line contains file stamp, bitmap in hex digits starting from the lowest bits
+    // and file path
+    auto & paths = source_path_table::global();
+    while (std::getline(istr, line)) {
+        std::istringstream lstr{line};
+        std::string kind, bits;
+        file_tokens ft;
+        lstr >> kind >> ft.stamp.mtime >> ft.stamp.size >> bits;
+        ft.stamp.exists = true;
+        lstr.get();
+
+        std::string path;
+        std::getline(lstr, path);
+        if (kind != "file" || !lstr || bits.size() != bitmap_bits / 4 || path.empty()) {
+            std::ostringstream msg;
+            msg << "invalid line in pre-filter cache file " << p << ": " << line;
+            throw std::runtime_error{msg.str()};
+        }
+
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            auto c = bits[i];
+            unsigned digit = c >= 'a' ? c - 'a' + 10 : c - '0';
+            for (std::size_t b = 0; b < 4; ++b) {
+                ft.tokens[i * 4 + b] = (digit >> b) & 1;
+            }
+        }
+
+        cache_.insert_or_assign(paths.intern(path), ft);
+    }
+}
+
+
+void symbol_prefilter::save(const fs::path & p) const {
+    std::ofstream ostr{p};
+    if (!ostr.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open pre-filter cache file for writing: " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    auto & paths = source_path_table::global();
+    ostr << cache_file_header << '\n';
+
+    std::string bits(bitmap_bits / 4, '0');
+    for (auto && [file, ft] : cache_) {
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            unsigned digit = 0;
+            for (std::size_t b = 0; b < 4; ++b) {
+                digit |= static_cast<unsigned>(ft.tokens[i * 4 + b]) << b;
+            }
+
+            bits[i] = "0123456789abcdef"[digit];
+        }
+
+        ostr << "file " << ft.stamp.mtime << ' ' << ft.stamp.size << ' ' << bits << ' '
+             << paths.path(file).string() << '\n';
+    }
+}
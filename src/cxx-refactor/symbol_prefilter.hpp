@@ -0,0 +1,86 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file symbol_prefilter.hpp
+/// Contains definition of the symbol_prefilter class.
+
+#pragma once
+
+#include "include_graph.hpp"
+#include <bitset>
+#include <cm/src/cmsrc.hpp>
+#include <optional>
+#include <string>
+
+
+/// Returns true if text contains specified substring. Uses SSE2 instructions
+/// when they are available
+bool contains_substring(std::string_view text, std::string_view needle);
+
+
+/// Returns identifier located at specified position in source file or nullopt
+/// if file doesn't exist or there is no identifier at position
+std::optional<std::string> identifier_at(const std::filesystem::path & p,
+                                         const cm::src::source_position & pos);
+
+
+/// Textual pre-filter of translation units. Proves that spelling of symbol doesn't
+/// occur in translation unit and headers it includes, so translation unit can be
+/// skipped without parsing. Each file is summarized once by bitmap of hashes of its
+/// identifier tokens, files which have bit of symbol set are searched for symbol
+/// spelling. Bitmaps are cached per file and reused for other symbols while file
+/// doesn't change, cache may be saved to file and loaded in the next run. Building
+/// bitmap costs more than single search, so bitmaps are built only if they are kept.
+class symbol_prefilter {
+public:
+    /// Constructs pre-filter with empty cache. If cache_bitmaps is false bitmaps are not
+    /// built and files are only searched for spelling
+    explicit symbol_prefilter(bool cache_bitmaps = true): cache_bitmaps_{cache_bitmaps} {}
+
+    /// Returns translation units from list which may mention symbol with specified
+    /// spelling in their text or in text of included files. Include graph must be
+    /// updated for all translation units
+    std::vector<std::filesystem::path> candidates(const std::vector<std::filesystem::path> & tus,
+                                                  const std::string & spelling,
+                                                  const include_graph & graph);
+
+    /// Returns true if file may contain specified spelling
+    bool may_contain(file_id file, const std::string & spelling);
+
+    /// Loads cached bitmaps from file saved by the save function. Does nothing if
+    /// file doesn't exist
+    void load(const std::filesystem::path & p);
+
+    /// Saves cached bitmaps to file
+    void save(const std::filesystem::path & p) const;
+
+    /// Returns number of files searched for spelling after bitmap check
+    std::size_t searched_count() const { return searched_count_; }
+
+    /// Returns number of files which bitmaps were built
+    std::size_t scanned_count() const { return scanned_count_; }
+
+private:
+    /// Number of bits in token bitmap
+    static constexpr std::size_t bitmap_bits = 4096;
+
+    /// Cached bitmap of identifier tokens of file
+    struct file_tokens {
+        file_stamp stamp;                           ///< File stamp at scan
+        std::bitset<bitmap_bits> tokens;            ///< Bits of token hashes
+    };
+
+    /// Returns bit index of token in bitmap
+    static std::size_t token_bit(std::string_view token);
+
+    /// Returns true if spelling is single identifier token
+    static bool is_identifier(std::string_view s);
+
+    bool cache_bitmaps_;                                ///< Bitmaps are built and cached
+    std::unordered_map<file_id, file_tokens> cache_;    ///< Cached file bitmaps
+    std::size_t searched_count_ = 0;                    ///< Number of searched files
+    std::size_t scanned_count_ = 0;                     ///< Number of scanned files
+};
@@ -9,6 +9,9 @@
 
 #include "pch.hpp"
 #include "template_parameter_remove_action.hpp"
+#include "cancellation.hpp"
+#include "concurrent_source_modifications.hpp"
+#include "refactor_stats.hpp"
 #include "log/log.hpp"
 
 
@@ -46,16 +49,216 @@ remove_template_argument(const cm::src::template_argument_spec * arg,
 }
 
 
+/// Modifications and statistics collected for a chunk of uses
+struct uses_chunk_result {
+    /// Constructs result collecting modifications of source file into collector
+    explicit uses_chunk_result(concurrent_source_modifications & coll, file_id file):
+        mods{coll}, file{file} {}
+
+    /// Adds modification of source file
+    void add(const source_modification & mod) { mods.add(file, mod); }
+
+    concurrent_source_modifications::buffer mods;   ///< Buffer of collected modifications
+    file_id file;                                   ///< Identifier of modified source file
+    std::size_t casts = 0;                          ///< Number of attempted dynamic casts
+    std::size_t nodes = 0;                          ///< Number of visited AST nodes
+};
+
+
+/// Performs dynamic cast of use and counts it in chunk result
+template <typename T, typename U>
+static const T * counted_cast(const U * p, uses_chunk_result & res) {
+    ++res.casts;
+    return dynamic_cast<const T*>(p);
+}
+
+
+/// Collects modifications for template use. Removes template argument
+/// from template substitution
+static void collect_substitution_mods(const auto * use,
+                                      std::ptrdiff_t param_idx,
+                                      std::ptrdiff_t params_size,
+                                      uses_chunk_result & res) {
+    if (auto subst = counted_cast<cm::template_substitution>(use, res)) {
+        TPR_DEBUG << "found template substitution: " << subst->desc();
+
+        for (auto subst_spec : subst->template uses<cm::src::template_substitution_spec>()) {
+            TPR_DEBUG << "found template substitution spec: " << subst_spec->class_name();
+            ++res.nodes;
+
+            // seatching for template argument spec and previous/next arguments
+            auto args = subst_spec->arguments();
+            assert(param_idx < std::ranges::ssize(args) && "template parameters inconsistency");
+            auto arg_it = std::ranges::begin(args);
+            std::ranges::advance(arg_it, param_idx);
+
+            const cm::src::template_argument_spec * prev_arg = nullptr;
+            const cm::src::template_argument_spec * next_arg = nullptr;
+
+            if (param_idx != 0) {
+                // TODO: bug in std::prev in libc++
+                auto prev_arg_it = arg_it;
+                --prev_arg_it;
+                prev_arg = *prev_arg_it;
+            }
+
+            if (param_idx != params_size - 1) {
+                next_arg = *(std::next(arg_it));
+            }
+
+            res.add(remove_template_argument(*arg_it, prev_arg, next_arg));
+        }
+    } else if (auto ent = counted_cast<cm::entity>(use, res)) {
+        TPR_DEBUG << "found template use entity, skipping: " << ent->desc();
+    } else if (auto node = counted_cast<cm::src::ast_node>(use, res)) {
+        ++res.nodes;
+        TPR_DEBUG << "found template use AST node, skipping: " << node->class_name();
+    } else {
+        TPR_ERROR << "found unknown template use";
+    }
+}
+
+
+/// Collects modifications for template parameter use
+static void collect_parameter_use_mods(const auto * use, uses_chunk_result & res) {
+    auto node = counted_cast<cm::src::ast_node>(use, res);
+    if (!node) {
+        return;
+    }
+
+    ++res.nodes;
+
+    if (auto par_decl = counted_cast<cm::src::template_parameter_decl>(node, res)) {
+        // template parameter declaration for template class itself
+        // or for outline members declarations
+
+        TPR_DEBUG << "found template parameter decl: "
+                  << par_decl->class_name() << ' '
+                  << par_decl->source_range();
+
+        // getting declarations of previous and next parameters
+        auto prev_par_decl = par_decl->prev();
+        auto next_par_decl = par_decl->next();
+
+        auto remove_range = par_decl->source_range().range();
+
+        // adjusting beginning of remove range if parameter is not the first parameter
+        if (prev_par_decl != nullptr) {
+            auto prev_end = prev_par_decl->source_range().range().end();
+            assert(prev_end < remove_range.start() && "invalid prev parameter range end");
+            remove_range.set_start(prev_par_decl->source_range().range().end());
+        }
+
+        // adjusting end of remove range if parameter is not the last parameter
+        if (next_par_decl != nullptr) {
+            auto next_start = next_par_decl->source_range().range().start();
+            assert(next_start > remove_range.end() && "invalid next parameter range start");
+            remove_range.set_end(next_par_decl->source_range().range().start());
+        }
+
+        TPR_DEBUG << "adjusted range for removed template parameter: " << remove_range;
+
+        // adding remove modification
+        res.add(source_modification{remove_range, {}});
+        return;
+    }
+
+    if (auto spec = counted_cast<cm::src::template_param_type_spec>(node, res)) {
+        TPR_DEBUG << "found template parameter type spec:"
+                  << spec->class_name() << ' ' << spec->source_range();
+
+        // checking for special case when parameter is used for referencing template record
+        // itself inside template definition
+        if (auto targ_spec =
+            counted_cast<cm::src::template_argument_spec>(spec->parent(), res)) {
+
+            auto subst_spec = targ_spec->parent();
+            if (counted_cast<cm::src::template_record_type_spec>(subst_spec, res) ||
+                counted_cast<cm::src::template_record_scope_spec>(subst_spec, res)) {
+
+                TPR_DEBUG << "tempalte parameter used for referencing template record,"
+                          << " removing";
+
+                // removing template argument from template substitution
+                res.add(remove_template_argument(targ_spec,
+                                                        targ_spec->find_prev(),
+                                                        targ_spec->find_next()));
+                return;
+            }
+        }
+
+        // template parameter is used as another type specification, replacing it with ???
+
+        TPR_DEBUG << "template parameter is used as simple type specification, "
+                  << "replacing with ???: "
+                  << node->class_name() << ' ' << node->source_range();
+
+        auto sz = spec->name()->string().size();
+        std::string replace_str;
+        for (size_t i = 0; i < sz; ++i) {
+            replace_str.push_back('?');
+        }
+
+        res.add(source_modification{spec->source_range().range(), replace_str});
+        return;
+    }
+
+    TPR_ERROR << "unknown template parameter use: "
+              << node->class_name() << ": "
+              << node->source_range() << std::endl;
+}
+
+
+/// Number of uses processed by single parallel task
+static constexpr std::size_t uses_chunk_size = 256;
+
+
+/// Collects modifications of source file for all uses in range with specified function
+/// in parallel. Uses are split into chunks, modifications of each chunk are buffered
+/// and flushed into collector when chunk is processed.
+template <typename Uses, typename Fn>
+static void collect_uses_mods(thread_pool & pool, concurrent_source_modifications & coll,
+                              file_id file, Uses && uses, Fn && fn) {
+    std::vector<std::ranges::range_value_t<Uses>> uses_vec;
+    std::ranges::copy(uses, std::back_inserter(uses_vec));
+
+    auto & stats = refactor_stats::global();
+    auto chunks_count = (uses_vec.size() + uses_chunk_size - 1) / uses_chunk_size;
+    pool.parallel_for(chunks_count, [&](std::size_t chunk) {
+        trace_scope trace{"collect-uses-chunk"};
+        check_cancelled();
+        uses_chunk_result chunk_res{coll, file};
+        auto begin = chunk * uses_chunk_size;
+        auto end = std::min(begin + uses_chunk_size, uses_vec.size());
+        for (auto i = begin; i < end; ++i) {
+            fn(uses_vec[i], chunk_res);
+        }
+
+        chunk_res.mods.flush();
+        stats.add(stats_counter::casts_attempted, chunk_res.casts);
+        stats.add(stats_counter::nodes_visited, chunk_res.nodes);
+    });
+
+    stats.add(stats_counter::uses_scanned, uses_vec.size());
+}
+
+
 multi_source_modifications
 template_parameter_remove_action::perform_mod(const cm::src::source_code_model & cm,
                                               const cm::src::source_file * src_file,
-                                              const cm::src::source_position & pos) const {
+                                              const cm::src::source_position & pos,
+                                              thread_pool & pool) const {
 
     cm::src::source_file_position src_pos{src_file->cm_src(), pos}; 
     TPR_DEBUG << "position: " << src_pos;
 
     // looking for AST node located at specified position
-    auto node = cm.find_node_at_pos(src_pos);
+    const cm::src::ast_node * node = nullptr;
+    {
+        stats_phase phase{"find-node"};
+        node = cm.find_node_at_pos(src_pos);
+    }
+
     if (!node) {
         std::ostringstream msg;
         msg << "can't find AST node located at source position " << src_pos;
@@ -85,7 +288,7 @@ template_parameter_remove_action::perform_mod(const cm::src::source_code_model &
     }
 
     TPR_DEBUG << "found code model entity associated with AST node: " << ent->desc();
-    TPR_TRACE << ent->dump_to_string();
+    TPR_TRACE << REFACTOR_LOG_LAZY(ent->dump_to_string());
 
     // checking that entity is a template parameter
     auto par = dynamic_cast<const cm::template_parameter*>(ent);
@@ -110,139 +313,22 @@ template_parameter_remove_action::perform_mod(const cm::src::source_code_model &
 
     TPR_DEBUG << "template parameter index: " << param_idx;
 
-    multi_source_modifications mods;
-
     // iterating over all template substitutions and removing argument
-    for (auto && use : templ->uses()) {
-        if (auto subst = dynamic_cast<const cm::template_substitution*>(use)) {
-            TPR_DEBUG << "found template substitution: " << subst->desc();
-
-            for (auto subst_spec : subst->uses<cm::src::template_substitution_spec>()) {
-                TPR_DEBUG << "found template substitution spec: " << subst_spec->class_name();
-
-                // seatching for template argument spec and previous/next arguments
-                auto args = subst_spec->arguments();
-                assert(param_idx < std::ranges::size(args) && "template parameters inconsistency");
-                auto arg_it = std::ranges::begin(args);
-                std::ranges::advance(arg_it, param_idx);
-
-                const cm::src::template_argument_spec * prev_arg = nullptr;
-                const cm::src::template_argument_spec * next_arg = nullptr;
-
-                if (param_idx != 0) {
-                    // TODO: bug in std::prev in libc++
-                    auto prev_arg_it = arg_it;
-                    --prev_arg_it;
-                    prev_arg = *prev_arg_it;
-                }
-
-                if (param_idx != params_size - 1) {
-                    next_arg = *(std::next(arg_it));
-                }
-
-                auto mod = remove_template_argument(*arg_it, prev_arg, next_arg);
-                mods.add(src_file->cm_src()->path(), mod);
-            }
-        } else if (auto ent = dynamic_cast<const cm::entity*>(use)) {
-            TPR_DEBUG << "found template use entity, skipping: " << ent->desc();
-        } else if (auto node = dynamic_cast<const cm::src::ast_node*>(use)) {
-            TPR_DEBUG << "found template use AST node, skipping: " << node->class_name();
-        } else {
-            TPR_ERROR << "found unknown template use";
-        }
-    }
+    auto subst_fn = [param_idx, params_size](auto && use, auto & out) {
+        collect_substitution_mods(use, param_idx, params_size, out);
+    };
 
+    concurrent_source_modifications coll{pool.size()};
+    auto file = source_path_table::global().intern(src_file->cm_src()->path());
+    collect_uses_mods(pool, coll, file, templ->uses(), subst_fn);
 
     // iterating over all parameter uses
-    for (auto && use : par->uses()) {
-        auto node = dynamic_cast<const cm::src::ast_node *>(use);
-        if (!node) {
-            continue;
-        }
-
-        if (auto par_decl = dynamic_cast<const cm::src::template_parameter_decl*>(node)) {
-            // template parameter declaration for template class itself
-            // or for outline members declarations
-
-            TPR_DEBUG << "found template parameter decl: "
-                      << par_decl->class_name() << ' '
-                      << par_decl->source_range();
+    auto par_use_fn = [](auto && use, auto & out) {
+        collect_parameter_use_mods(use, out);
+    };
 
-            // getting declarations of previous and next parameters
-            auto prev_par_decl = par_decl->prev();
-            auto next_par_decl = par_decl->next();
-
-            auto remove_range = par_decl->source_range().range();
-
-            // adjusting beginning of remove range if parameter is not the first parameter
-            if (prev_par_decl != nullptr) {
-                auto prev_end = prev_par_decl->source_range().range().end();
-                assert(prev_end < remove_range.start() && "invalid prev parameter range end");
-                remove_range.set_start(prev_par_decl->source_range().range().end());
-            }
-
-            // adjusting end of remove range if parameter is not the last parameter
-            if (next_par_decl != nullptr) {
-                auto next_start = next_par_decl->source_range().range().start();
-                assert(next_start > remove_range.end() && "invalid next parameter range start");
-                remove_range.set_end(next_par_decl->source_range().range().start());
-            }
-
-            TPR_DEBUG << "adjusted range for removed template parameter: " << remove_range;
-
-            // adding remove modification
-            mods.add(src_file->cm_src()->path(), source_modification{remove_range, {}});
-
-            continue;
-        }
-        
-        if (auto spec = dynamic_cast<const cm::src::template_param_type_spec*>(node)) {
-            TPR_DEBUG << "found template parameter type spec:"
-                      << spec->class_name() << ' ' << spec->source_range();
-
-            // checking for special case when parameter is used for referencing template record
-            // itself inside template definition
-            if (auto targ_spec =
-                dynamic_cast<const cm::src::template_argument_spec*>(spec->parent())) {
-                
-                auto subst_spec = targ_spec->parent();
-                if (dynamic_cast<const cm::src::template_record_type_spec*>(subst_spec) ||
-                    dynamic_cast<const cm::src::template_record_scope_spec*>(subst_spec)) {
-
-                    TPR_DEBUG << "tempalte parameter used for referencing template record,"
-                              << " removing";
-
-                    // removing template argument from template substitution
-                    auto mod = remove_template_argument(targ_spec,
-                                                        targ_spec->find_prev(),
-                                                        targ_spec->find_next());
-                    mods.add(src_file->cm_src()->path(), mod);
-
-                    continue;
-                }
-            }
-
-            // template parameter is used as another type specification, replacing it with ???
-
-            TPR_DEBUG << "template parameter is used as simple type specification, "
-                      << "replacing with ???: "
-                      << node->class_name() << ' ' << node->source_range();
-
-            auto sz = spec->name()->string().size();
-            std::string replace_str;
-            for (size_t i = 0; i < sz; ++i) {
-                replace_str.push_back('?');
-            }
-
-            mods.add(src_file->cm_src()->path(),
-                    source_modification{spec->source_range().range(), replace_str});
-            continue;
-        }
-
-        TPR_ERROR << "unknown template parameter use: "
-                  << node->class_name() << ": "
-                  << node->source_range() << std::endl;
-    }
+    collect_uses_mods(pool, coll, file, par->uses(), par_use_fn);
 
-    return mods;
+    // sorting collected modifications, result doesn't depend on order of chunks
+    return coll.merge(pool);
 }
@@ -23,5 +23,6 @@ private:
     multi_source_modifications
     perform_mod(const cm::src::source_code_model & cm,
                 const cm::src::source_file * src_file,
-                const cm::src::source_position & pos) const override;
+                const cm::src::source_position & pos,
+                thread_pool & pool) const override;
 };
@@ -0,0 +1,116 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file action_result_test.cpp
+/// Contains unit tests for merging of action results.
+
+#include "../action_result.hpp"
+#include "../result_serialization.hpp"
+#include <sstream>
+#include <boost/test/unit_test.hpp>
+
+
+/// Returns modification with specified range on single line and insert string.
+/// Lines are assumed to be 100 bytes long
+static compact_modification make_mod(std::size_t line, std::size_t start, std::size_t end,
+                                     const std::string & str) {
+    auto line_off = static_cast<source_offset>((line - 1) * 100);
+    return compact_modification{static_cast<source_offset>(line_off + start - 1),
+                                static_cast<source_offset>(line_off + end - 1),
+                                str};
+}
+
+
+BOOST_AUTO_TEST_SUITE(action_result_test)
+
+
+/// Checks that identical modifications and messages from different translation
+/// units are merged into one
+BOOST_AUTO_TEST_CASE(merge_identical_test) {
+    action_result res;
+    res.mods().add("a.hpp", make_mod(1, 1, 5, "x"));
+    res.add_message("found");
+
+    action_result tu_res;
+    tu_res.mods().add("a.hpp", make_mod(1, 1, 5, "x"));
+    tu_res.mods().add("a.hpp", make_mod(2, 1, 5, "y"));
+    tu_res.mods().add("b.cpp", make_mod(1, 1, 2, ""));
+    tu_res.add_message("found");
+    tu_res.add_message("other");
+
+    res.merge(std::move(tu_res));
+
+    BOOST_REQUIRE_EQUAL(res.mods().mods().size(), 2);
+    BOOST_REQUIRE(res.mods().find("a.hpp") != nullptr);
+    BOOST_CHECK_EQUAL(res.mods().find("a.hpp")->size(), 2);
+    BOOST_REQUIRE(res.mods().find("b.cpp") != nullptr);
+    BOOST_CHECK_EQUAL(res.mods().find("b.cpp")->size(), 1);
+    BOOST_REQUIRE_EQUAL(res.messages().size(), 2);
+    BOOST_CHECK_EQUAL(res.messages()[0], "found");
+    BOOST_CHECK_EQUAL(res.messages()[1], "other");
+}
+
+
+/// Checks that different overlapping modifications are reported as errors
+BOOST_AUTO_TEST_CASE(merge_conflict_test) {
+    action_result res;
+    res.mods().add("a.hpp", make_mod(1, 1, 5, "x"));
+
+    action_result tu_res;
+    tu_res.mods().add("a.hpp", make_mod(1, 1, 5, "z"));
+
+    BOOST_CHECK_THROW(res.merge(std::move(tu_res)), std::runtime_error);
+}
+
+
+/// Checks that modifications of the same file added with different path spellings
+/// are grouped together
+BOOST_AUTO_TEST_CASE(path_spelling_test) {
+    auto abs_path = std::filesystem::current_path() / "a.hpp";
+
+    action_result res;
+    res.mods().add("a.hpp", make_mod(1, 1, 5, "x"));
+    res.mods().add("./dir/../a.hpp", make_mod(2, 1, 5, "y"));
+    res.mods().add(abs_path, make_mod(3, 1, 5, "z"));
+
+    BOOST_REQUIRE_EQUAL(res.mods().mods().size(), 1);
+    BOOST_CHECK_EQUAL(res.mods().mods().begin()->second.size(), 3);
+    BOOST_CHECK_EQUAL(res.mods().path(res.mods().mods().begin()->first), abs_path);
+}
+
+
+/// Checks that serialized result is read back with the same modifications and messages,
+/// and that truncated data is rejected
+BOOST_AUTO_TEST_CASE(serialization_test) {
+    action_result res;
+    res.mods().add("a.hpp", make_mod(1, 1, 5, "x"));
+    res.mods().add("a.hpp", make_mod(2, 3, 3, "inserted"));
+    res.mods().add("b.cpp", make_mod(1, 1, 2, ""));
+    res.add_message("found");
+
+    std::ostringstream ostr;
+    write_action_result(ostr, res);
+
+    std::istringstream istr{ostr.str()};
+    auto read_res = read_action_result(istr);
+
+    BOOST_REQUIRE_EQUAL(read_res.mods().mods().size(), 2);
+    for (auto && [file, smods] : res.mods().mods()) {
+        auto read_smods = read_res.mods().find(res.mods().path(file));
+        BOOST_REQUIRE(read_smods != nullptr);
+        BOOST_CHECK(std::ranges::equal(read_smods->mods(), smods.mods()));
+    }
+
+    BOOST_REQUIRE_EQUAL(read_res.messages().size(), 1);
+    BOOST_CHECK_EQUAL(read_res.messages()[0], "found");
+
+    auto data = ostr.str();
+    std::istringstream trunc_istr{data.substr(0, data.size() - 3)};
+    BOOST_CHECK_THROW(read_action_result(trunc_istr), std::runtime_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,75 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file bounded_queue_test.cpp
+/// Contains unit tests for the bounded_queue class.
+
+#include "../bounded_queue.hpp"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+BOOST_AUTO_TEST_SUITE(bounded_queue_test)
+
+
+/// Checks that items are passed in order and producer never runs ahead of consumer
+/// by more than queue capacity
+BOOST_AUTO_TEST_CASE(capacity_test) {
+    bounded_queue<int> queue{2};
+    std::atomic<int> pushed{0};
+    std::atomic<int> popped{0};
+    std::atomic<int> max_ahead{0};
+
+    std::jthread producer{[&]() {
+        for (int i = 0; i < 1000; ++i) {
+            queue.push(int{i});
+            auto ahead = ++pushed - popped.load();
+            if (ahead > max_ahead) {
+                max_ahead = ahead;
+            }
+        }
+
+        queue.close();
+    }};
+
+    std::vector<int> items;
+    while (auto item = queue.pop()) {
+        items.push_back(*item);
+        ++popped;
+    }
+
+    BOOST_REQUIRE_EQUAL(items.size(), 1000);
+    for (int i = 0; i < 1000; ++i) {
+        BOOST_CHECK_EQUAL(items[i], i);
+    }
+
+    // one item may be popped between push and counter increment
+    BOOST_CHECK_LE(max_ahead.load(), 3);
+}
+
+
+/// Checks that closing queue wakes up blocked producer and rejects new items,
+/// while items already in queue are still popped
+BOOST_AUTO_TEST_CASE(close_test) {
+    bounded_queue<int> queue{1};
+    BOOST_CHECK(queue.push(1));
+
+    std::atomic<bool> result{true};
+    std::jthread producer{[&]() { result = queue.push(2); }};
+
+    queue.close();
+    producer.join();
+
+    BOOST_CHECK(!result);
+    BOOST_CHECK(!queue.push(3));
+    BOOST_CHECK_EQUAL(queue.pop().value(), 1);
+    BOOST_CHECK(!queue.pop());
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file cancellation_test.cpp
+/// Contains unit tests for the cancellation_token class.
+
+#include "../cancellation.hpp"
+#include "../thread_pool.hpp"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+
+
+BOOST_AUTO_TEST_SUITE(cancellation_test)
+
+
+/// Checks explicit cancellation and deadlines
+BOOST_AUTO_TEST_CASE(token_test) {
+    cancellation_token token;
+    BOOST_CHECK(!token.cancelled());
+    BOOST_CHECK_NO_THROW(token.check());
+
+    token.cancel();
+    BOOST_CHECK(token.cancelled());
+    BOOST_CHECK(!token.deadline_exceeded());
+    BOOST_CHECK_THROW(token.check(), cancelled_error);
+
+    cancellation_token expired{cancellation_token::clock::now() - std::chrono::seconds{1}};
+    BOOST_CHECK(expired.cancelled());
+    BOOST_CHECK(expired.deadline_exceeded());
+
+    cancellation_token future{cancellation_token::clock::now() + std::chrono::hours{1}};
+    BOOST_CHECK(!future.cancelled());
+}
+
+
+/// Checks that token of current thread is set by scope and propagated to tasks
+/// of thread pool
+BOOST_AUTO_TEST_CASE(scope_test) {
+    BOOST_CHECK(cancellation_token::current() == nullptr);
+    BOOST_CHECK_NO_THROW(check_cancelled());
+
+    thread_pool pool{4};
+    cancellation_token token;
+    {
+        cancellation_scope scope{&token};
+        BOOST_CHECK(cancellation_token::current() == &token);
+
+        std::atomic<std::size_t> seen{0};
+        pool.parallel_for(100, [&](std::size_t) {
+            if (cancellation_token::current() == &token) {
+                ++seen;
+            }
+        });
+
+        BOOST_CHECK_EQUAL(seen.load(), 100);
+
+        token.cancel();
+        BOOST_CHECK(cancellation_requested());
+        BOOST_CHECK_THROW(pool.parallel_for(100, [](std::size_t) { check_cancelled(); }),
+                          cancelled_error);
+    }
+
+    BOOST_CHECK(cancellation_token::current() == nullptr);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,121 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file concurrent_source_modifications_test.cpp
+/// Contains unit tests for the concurrent_source_modifications class.
+
+#include "../concurrent_source_modifications.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <optional>
+
+
+BOOST_AUTO_TEST_SUITE(concurrent_source_modifications_test)
+
+
+/// Feeds collector from tasks of thread pool and checks merged modifications
+BOOST_AUTO_TEST_CASE(multi_thread_test) {
+    thread_pool pool{4};
+    source_path_table paths;
+    concurrent_source_modifications coll{4, paths};
+
+    constexpr std::size_t tasks_count = 8;
+    constexpr std::size_t mods_per_task = 1000;
+
+    pool.parallel_for(tasks_count, [&coll](std::size_t t) {
+        concurrent_source_modifications::buffer buf{coll};
+        for (std::size_t i = 0; i < mods_per_task; ++i) {
+            auto off = static_cast<source_offset>((t * mods_per_task + i) * 2);
+            auto path = (i % 2) ? "a.cpp" : "b.cpp";
+            buf.add(path, compact_modification{off, off + 1, "x"});
+        }
+
+        buf.flush();
+    });
+
+    auto mods = coll.merge(pool);
+    BOOST_REQUIRE_EQUAL(mods.mods().size(), 2);
+
+    std::size_t total = 0;
+    for (auto && [path, smods] : mods.mods()) {
+        for (std::optional<source_offset> prev_start; auto && mod : smods.mods()) {
+            BOOST_CHECK(!prev_start || *prev_start < mod.start());
+            prev_start = mod.start();
+            ++total;
+        }
+    }
+
+    BOOST_CHECK_EQUAL(total, tasks_count * mods_per_task);
+}
+
+
+/// Checks that intersecting modifications are detected during merge
+BOOST_AUTO_TEST_CASE(intersection_test) {
+    thread_pool pool{2};
+    source_path_table paths;
+    concurrent_source_modifications coll{2, paths};
+    coll.add("a.cpp", compact_modification{0, 4, ""});
+    coll.add("a.cpp", compact_modification{2, 7, ""});
+
+    BOOST_CHECK_THROW(coll.merge(pool), std::runtime_error);
+
+    // insertions at the same offset are reported too
+    concurrent_source_modifications ins_coll{2, paths};
+    ins_coll.add("a.cpp", compact_modification{3, 3, "x"});
+    ins_coll.add("a.cpp", compact_modification{3, 3, "y"});
+
+    BOOST_CHECK_THROW(ins_coll.merge(pool), std::runtime_error);
+}
+
+
+/// Checks that identical modifications are merged into one and that modifications
+/// left in buffer are discarded
+BOOST_AUTO_TEST_CASE(identical_test) {
+    thread_pool pool{2};
+    source_path_table paths;
+    concurrent_source_modifications coll{2, paths};
+    coll.add("a.cpp", compact_modification{3, 5, "x"});
+
+    {
+        concurrent_source_modifications::buffer buf{coll};
+        buf.add("a.cpp", compact_modification{3, 5, "x"});
+        buf.flush();
+        buf.add("a.cpp", compact_modification{8, 9, "y"});
+    }
+
+    auto mods = coll.merge(pool);
+    BOOST_REQUIRE(mods.find("a.cpp") != nullptr);
+    BOOST_CHECK_EQUAL(mods.find("a.cpp")->size(), 1);
+}
+
+
+/// Checks conversion of line/column modifications with line index of source file
+BOOST_FIXTURE_TEST_CASE(line_column_test, temp_dir_fixture) {
+    auto path = dir / "line_column_test.cpp";
+    write_file(path, "int a;\nint b;\n");
+
+    source_path_table paths;
+    concurrent_source_modifications coll{2, paths};
+    coll.add(path, source_modification{{{2, 5}, {2, 6}}, "c"});
+
+    thread_pool pool{2};
+    auto mods = coll.merge(pool);
+    BOOST_REQUIRE(mods.find(path) != nullptr);
+    auto & smods = *mods.find(path);
+    BOOST_REQUIRE_EQUAL(smods.size(), 1);
+    auto smods_range = smods.mods();
+    auto && mod = *std::ranges::begin(smods_range);
+    BOOST_CHECK_EQUAL(mod.start(), 11);
+    BOOST_CHECK_EQUAL(mod.end(), 12);
+    BOOST_REQUIRE(smods.index() != nullptr);
+    BOOST_CHECK(mod.range(*smods.index()).start() == (cm::src::source_position{2, 5}));
+
+    line_index_table::global().invalidate(path);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
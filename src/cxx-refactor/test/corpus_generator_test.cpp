@@ -0,0 +1,78 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file corpus_generator_test.cpp
+/// Contains unit tests for the corpus_generator class.
+
+#include "corpus-gen/corpus_generator.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+/// Returns text located at position "file:line:column" in file from directory
+static std::string text_at(const fs::path & dir, const std::string & pos, std::size_t len) {
+    auto col_sep = pos.rfind(':');
+    auto line_sep = pos.rfind(':', col_sep - 1);
+    auto file = pos.substr(0, line_sep);
+    auto line = std::stoul(pos.substr(line_sep + 1, col_sep - line_sep - 1));
+    auto col = std::stoul(pos.substr(col_sep + 1));
+
+    std::ifstream istr{dir / file};
+    std::string str;
+    for (std::size_t i = 0; i < line; ++i) {
+        std::getline(istr, str);
+    }
+
+    return str.substr(col - 1, len);
+}
+
+
+BOOST_AUTO_TEST_SUITE(corpus_generator_test)
+
+
+/// Checks generated files and positions of template parameters and uses
+BOOST_FIXTURE_TEST_CASE(positions_test, temp_dir_fixture) {
+    for (std::size_t headers : {0, 2}) {
+        corpus_options opts;
+        opts.templates = 3;
+        opts.params = 3;
+        opts.insts = 4;
+        opts.tus = 2;
+        opts.headers = headers;
+
+        auto corpus_dir = dir / std::to_string(headers);
+        auto info = corpus_generator{opts}.generate(corpus_dir);
+        BOOST_CHECK_EQUAL(info.tus.size(), 2);
+        BOOST_CHECK_EQUAL(info.headers.size(), headers);
+
+        for (std::size_t t = 0; t < opts.templates; ++t) {
+            BOOST_REQUIRE_EQUAL(info.param_positions[t].size(), opts.params);
+            for (std::size_t p = 0; p < opts.params; ++p) {
+                BOOST_CHECK_EQUAL(text_at(corpus_dir, info.param_positions[t][p], 2),
+                                  "T" + std::to_string(p));
+            }
+
+            BOOST_REQUIRE_EQUAL(info.use_positions[t].size(), opts.insts);
+            for (auto && pos : info.use_positions[t]) {
+                BOOST_CHECK_EQUAL(text_at(corpus_dir, pos, 7), "templ_" + std::to_string(t));
+            }
+        }
+
+        BOOST_REQUIRE_EQUAL(info.tu_use_positions.size(), opts.tus);
+        for (std::size_t tu = 0; tu < opts.tus; ++tu) {
+            auto file = "corpus_" + std::to_string(tu) + ".cpp:";
+            BOOST_CHECK_EQUAL(info.tu_use_positions[tu].substr(0, file.size()), file);
+            BOOST_CHECK_EQUAL(text_at(corpus_dir, info.tu_use_positions[tu], 7), "templ_0");
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,191 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file edit_script_test.cpp
+/// Contains unit tests for reading edit scripts.
+
+#include "../edit_script.hpp"
+#include "../result_serialization.hpp"
+#include "../source_rewriter.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+
+namespace fs = std::filesystem;
+
+
+/// Rewrites source with modifications from script, returns rewritten text
+static std::string rewrite(const multi_source_modifications & mods, const fs::path & p) {
+    auto smods = mods.find(p);
+    BOOST_REQUIRE(smods != nullptr);
+
+    std::ostringstream ostr;
+    source_rewriter rw;
+    rw.rewrite(*smods, p, ostr);
+    return ostr.str();
+}
+
+
+BOOST_AUTO_TEST_SUITE(edit_script_test)
+
+
+/// Checks that edits of JSON script are grouped by sources and sorted by offsets
+BOOST_FIXTURE_TEST_CASE(json_script_test, temp_dir_fixture) {
+    write_file(dir / "a.cpp", "int x = 1;\n");
+    write_file(dir / "b.cpp", "int y;\n");
+
+    auto a = (dir / "a.cpp").string();
+    auto b = (dir / "b.cpp").string();
+    auto script = "{\"version\": 1, \"tool\": {\"name\": \"gen\", \"args\": [1, true, null]}, \"edits\": [\n"
+        "  {\"path\": \"" + a + "\", \"offset\": 8, \"length\": 1, \"replacement\": \"\\\"\\u00e9\\ud83d\\ude00\\\"\"},\n"
+        "  {\"path\": \"" + b + "\", \"offset\": 0, \"length\": 3, \"replacement\": \"long\", \"note\": \"x\"},\n"
+        "  {\"path\": \"" + a + "\", \"offset\": 4, \"length\": 1, \"replacement\": \"z\\n\"},\n"
+        "  {\"offset\": 0, \"path\": \"" + a + "\", \"replacement\": \"// \"}\n"
+        "]}";
+
+    thread_pool pool{2};
+    auto mods = parse_edit_script(script, pool);
+    BOOST_CHECK_EQUAL(mods.mods().size(), 2);
+    BOOST_CHECK_EQUAL(rewrite(mods, dir / "a.cpp"), "// int z\n = \"\xc3\xa9\xf0\x9f\x98\x80\";\n");
+    BOOST_CHECK_EQUAL(rewrite(mods, dir / "b.cpp"), "long y;\n");
+
+    // bare array of edits
+    auto arr_mods = parse_edit_script("[{\"path\": \"" + b + "\", \"offset\": 6}]", pool);
+    BOOST_CHECK_EQUAL(rewrite(arr_mods, dir / "b.cpp"), "int y;\n");
+}
+
+
+/// Checks that overlapping edits and malformed scripts are reported
+BOOST_FIXTURE_TEST_CASE(invalid_script_test, temp_dir_fixture) {
+    write_file(dir / "a.cpp", "int x = 1;\n");
+
+    auto a = (dir / "a.cpp").string();
+    thread_pool pool{2};
+
+    auto overlap = "[{\"path\": \"" + a + "\", \"offset\": 4, \"length\": 3},"
+                   " {\"path\": \"" + a + "\", \"offset\": 0, \"length\": 5}]";
+    BOOST_CHECK_THROW(parse_edit_script(overlap, pool), std::runtime_error);
+
+    auto same_offset = "[{\"path\": \"" + a + "\", \"offset\": 4, \"replacement\": \"a\"},"
+                       " {\"path\": \"" + a + "\", \"offset\": 4, \"replacement\": \"b\"}]";
+    BOOST_CHECK_THROW(parse_edit_script(same_offset, pool), std::runtime_error);
+
+    BOOST_CHECK_THROW(parse_edit_script("[{\"path\": \"" + a + "\"}]", pool), std::runtime_error);
+    BOOST_CHECK_THROW(parse_edit_script("[{\"path\": \"" + a + "\", \"offset\": -1}]", pool),
+                      std::runtime_error);
+    BOOST_CHECK_THROW(parse_edit_script("{\"edits\": [}", pool), std::runtime_error);
+    BOOST_CHECK_THROW(parse_edit_script("{}", pool), std::runtime_error);
+}
+
+
+/// Checks that scripts in binary format of serialized action results are read
+BOOST_FIXTURE_TEST_CASE(binary_script_test, temp_dir_fixture) {
+    write_file(dir / "a.cpp", "int x;\n");
+
+    action_result res;
+    res.mods().add(dir / "a.cpp", compact_modification{0, 3, "long"});
+    res.mods().add(dir / "a.cpp", compact_modification{4, 5, "y"});
+
+    std::ostringstream ostr;
+    write_action_result(ostr, res);
+    write_file(dir / "edits.bin", ostr.str());
+
+    auto mods = read_edit_script(dir / "edits.bin");
+    BOOST_CHECK_EQUAL(rewrite(mods, dir / "a.cpp"), "long y;\n");
+}
+
+
+/// Checks that binary script encoded byte by byte according to documented little-endian
+/// layout is read
+BOOST_FIXTURE_TEST_CASE(binary_layout_test, temp_dir_fixture) {
+    write_file(dir / "a.cpp", "int x;\n");
+
+    std::string data;
+    auto u32 = [&](std::uint32_t val) {
+        for (int i = 0; i < 4; ++i) {
+            data.push_back(static_cast<char>((val >> (i * 8)) & 0xff));
+        }
+    };
+
+    auto str = [&](const std::string & s) {
+        u32(static_cast<std::uint32_t>(s.size()));
+        data += s;
+    };
+
+    data += "CXR1";
+    u32(0);
+    u32(1);
+    str((dir / "a.cpp").string());
+    u32(1);
+    u32(4);
+    u32(5);
+    str("value");
+
+    auto mods = parse_edit_script(data);
+    BOOST_CHECK_EQUAL(rewrite(mods, dir / "a.cpp"), "int value;\n");
+}
+
+
+/// Checks that overlapping edits and edits with the same offset in binary script are
+/// reported, including edits of source listed twice
+BOOST_FIXTURE_TEST_CASE(binary_overlap_test, temp_dir_fixture) {
+    write_file(dir / "a.cpp", "int x;\n");
+
+    // writes binary script with edits of sources given as lists of (start, end, text)
+    using edit = std::tuple<std::uint32_t, std::uint32_t, std::string>;
+    auto script = [](const std::vector<std::pair<std::string, std::vector<edit>>> & srcs) {
+        std::string data;
+        auto u32 = [&](std::uint32_t val) {
+            for (int i = 0; i < 4; ++i) {
+                data.push_back(static_cast<char>((val >> (i * 8)) & 0xff));
+            }
+        };
+
+        auto str = [&](const std::string & s) {
+            u32(static_cast<std::uint32_t>(s.size()));
+            data += s;
+        };
+
+        data += "CXR1";
+        u32(0);
+        u32(static_cast<std::uint32_t>(srcs.size()));
+        for (auto && [path, edits] : srcs) {
+            str(path);
+            u32(static_cast<std::uint32_t>(edits.size()));
+            for (auto && [start, end, text] : edits) {
+                u32(start);
+                u32(end);
+                str(text);
+            }
+        }
+
+        return data;
+    };
+
+    auto a = (dir / "a.cpp").string();
+    auto a_alt = (dir / "." / "a.cpp").string();
+
+    auto same_start = script({{a, {{4, 4, "a"}, {4, 4, "b"}}}});
+    BOOST_CHECK_THROW(parse_edit_script(same_start), std::runtime_error);
+    BOOST_CHECK_THROW(read_action_result(same_start), std::runtime_error);
+
+    auto same_start_split = script({{a, {{4, 5, "y"}}}, {a_alt, {{4, 4, "z"}}}});
+    BOOST_CHECK_THROW(parse_edit_script(same_start_split), std::runtime_error);
+
+    auto overlap = script({{a, {{0, 3, "long"}}}, {a_alt, {{2, 5, "z"}}}});
+    BOOST_CHECK_THROW(parse_edit_script(overlap), std::runtime_error);
+
+    auto valid = script({{a, {{4, 5, "y"}}}, {a_alt, {{0, 3, "long"}}}});
+    BOOST_CHECK_EQUAL(rewrite(parse_edit_script(valid), dir / "a.cpp"), "long y;\n");
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,63 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file in_place_writer_test.cpp
+/// Contains unit tests for applying modifications in place.
+
+#include "../in_place_writer.hpp"
+#include "../mapped_file.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+/// Reads whole file located at specified path
+static std::string read_file(const fs::path & p) {
+    std::ifstream istr{p};
+    return std::string{std::istreambuf_iterator<char>{istr}, {}};
+}
+
+
+BOOST_AUTO_TEST_SUITE(in_place_writer_test)
+
+
+/// Checks that changed files are rewritten and files with unchanged content
+/// are not written
+BOOST_FIXTURE_TEST_CASE(skip_unchanged_test, temp_dir_fixture) {
+
+    write_file(dir / "changed.cpp", "int x;\n");
+    write_file(dir / "noop.cpp", "int y;\n");
+    write_file(dir / "cancel.cpp", "aab\n");
+
+    auto noop_stamp = file_stamp::of(dir / "noop.cpp");
+    auto cancel_stamp = file_stamp::of(dir / "cancel.cpp");
+
+    multi_source_modifications mods;
+    mods.add(dir / "changed.cpp", compact_modification{0, 3, "long"});
+    mods.add(dir / "noop.cpp", compact_modification{0, 3, "int"});
+
+    // removing character and inserting the same character after it
+    mods.add(dir / "cancel.cpp", compact_modification{0, 1, ""});
+    mods.add(dir / "cancel.cpp", compact_modification{1, 1, "a"});
+
+    thread_pool pool{2};
+    auto summary = apply_in_place(mods, pool);
+
+    BOOST_CHECK_EQUAL(summary.written, 1);
+    BOOST_CHECK_EQUAL(summary.unchanged, 2);
+    BOOST_CHECK_EQUAL(read_file(dir / "changed.cpp"), "long x;\n");
+    BOOST_CHECK_EQUAL(read_file(dir / "noop.cpp"), "int y;\n");
+    BOOST_CHECK_EQUAL(read_file(dir / "cancel.cpp"), "aab\n");
+    BOOST_CHECK(file_stamp::of(dir / "noop.cpp") == noop_stamp);
+    BOOST_CHECK(file_stamp::of(dir / "cancel.cpp") == cancel_stamp);
+    BOOST_CHECK(!fs::exists(dir / "changed.cpp.cxx-refactor.tmp"));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,158 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file include_graph_test.cpp
+/// Contains unit tests for the include_graph class.
+
+#include "../include_graph.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+BOOST_AUTO_TEST_SUITE(include_graph_test)
+
+
+/// Checks scanning of include directives
+BOOST_AUTO_TEST_CASE(scan_includes_test) {
+    auto incs = include_graph::scan_includes("#include \"a.hpp\"\n"
+                                             "  #  include   \"dir/b.hpp\"\n"
+                                             "#include <vector>\n"
+                                             "// #include \"c.hpp\"\n"
+                                             "#include_next <d.hpp>\n"
+                                             "#include HEADER_MACRO\n"
+                                             "#includes \"e.hpp\"\n"
+                                             "#include \"f.hpp\"");
+
+    BOOST_REQUIRE_EQUAL(incs.size(), 6);
+    BOOST_CHECK_EQUAL(incs[0].path, "a.hpp");
+    BOOST_CHECK(!incs[0].angled);
+    BOOST_CHECK_EQUAL(incs[1].path, "dir/b.hpp");
+    BOOST_CHECK_EQUAL(incs[2].path, "vector");
+    BOOST_CHECK(incs[2].angled);
+    BOOST_CHECK_EQUAL(incs[3].path, "d.hpp");
+    BOOST_CHECK(incs[3].angled);
+    BOOST_CHECK(incs[4].path.empty());
+    BOOST_CHECK_EQUAL(incs[5].path, "f.hpp");
+}
+
+
+/// Checks selection of translation units including target file, incremental
+/// updates and saving of graph
+BOOST_FIXTURE_TEST_CASE(affected_test, temp_dir_fixture) {
+    fs::create_directories(dir / "inc");
+
+    write_file(dir / "inc" / "a.hpp", "int a;\n");
+    write_file(dir / "b.hpp", "#include \"inc/a.hpp\"\n");
+    write_file(dir / "tu1.cpp", "#include \"b.hpp\"\n");
+    write_file(dir / "tu2.cpp", "#include <vector>\n");
+    std::vector<fs::path> tus{dir / "tu1.cpp", dir / "tu2.cpp"};
+
+    fs::create_directories(dir / "sys");
+    write_file(dir / "sys" / "vector", "#include <bits/missing.h>\n");
+
+    include_graph graph{{}, {dir / "sys"}};
+    for (auto && tu : tus) {
+        graph.update(tu);
+    }
+
+    BOOST_CHECK_EQUAL(graph.size(), 4);
+    BOOST_CHECK_EQUAL(graph.scanned_count(), 4);
+
+    auto res = graph.affected(tus, "inc/a.hpp");
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res[0], tus[0]);
+
+    BOOST_CHECK_EQUAL(graph.affected(tus, "tu2.cpp").size(), 1);
+    BOOST_CHECK_EQUAL(graph.affected(tus, "unknown.hpp").size(), 2);
+
+    // unchanged files are not scanned again
+    graph.update(tus[0]);
+    BOOST_CHECK_EQUAL(graph.scanned_count(), 4);
+
+    // changed file is scanned again
+    write_file(dir / "tu2.cpp", "#include \"inc/a.hpp\"\n// changed\n");
+    graph.update(tus[1]);
+    BOOST_CHECK_EQUAL(graph.scanned_count(), 5);
+    BOOST_CHECK_EQUAL(graph.affected(tus, "a.hpp").size(), 2);
+
+    // loaded graph is up to date
+    graph.save(dir / "graph.txt");
+    include_graph loaded{{}, {dir / "sys"}};
+    loaded.load(dir / "graph.txt");
+    BOOST_CHECK_EQUAL(loaded.size(), 4);
+    for (auto && tu : tus) {
+        loaded.update(tu);
+    }
+
+    BOOST_CHECK_EQUAL(loaded.scanned_count(), 0);
+    BOOST_CHECK_EQUAL(loaded.affected(tus, "a.hpp").size(), 2);
+
+    // graph saved with other include directories is not loaded
+    include_graph other{{dir / "inc"}, {dir / "sys"}};
+    other.load(dir / "graph.txt");
+    BOOST_CHECK_EQUAL(other.size(), 0);
+}
+
+
+/// Checks resolution of includes in include directories and selection of translation
+/// units with unresolved includes
+BOOST_FIXTURE_TEST_CASE(include_dirs_test, temp_dir_fixture) {
+    fs::create_directories(dir / "src");
+    fs::create_directories(dir / "inc" / "lib");
+    fs::create_directories(dir / "sys");
+
+    write_file(dir / "inc" / "lib" / "a.hpp", "int a;\n");
+    write_file(dir / "inc" / "b.hpp", "#include <lib/a.hpp>\n");
+    write_file(dir / "sys" / "vector", "#include \"../src/c.hpp\"\n");
+    write_file(dir / "src" / "c.hpp", "int c;\n");
+    write_file(dir / "src" / "tu1.cpp", "#include \"b.hpp\"\n#include <vector>\n");
+    write_file(dir / "src" / "tu2.cpp", "#include \"c.hpp\"\n");
+    write_file(dir / "src" / "tu3.cpp", "#include <vector>\n");
+    write_file(dir / "src" / "tu4.cpp", "#ifdef _WIN32\n#include <windows.h>\n#endif\n");
+    write_file(dir / "src" / "tu5.cpp", "#include CONFIG_HEADER\n");
+    std::vector<fs::path> tus;
+    for (auto name : {"tu1.cpp", "tu2.cpp", "tu3.cpp", "tu4.cpp", "tu5.cpp"}) {
+        tus.push_back(dir / "src" / name);
+    }
+
+    include_graph graph{{dir / "inc"}, {dir / "sys"}};
+    for (auto && tu : tus) {
+        graph.update(tu);
+    }
+
+    // quoted and angled includes are resolved in include directories,
+    // system headers are not part of graph
+    BOOST_CHECK_EQUAL(graph.included_files(tus[0]).size(), 3);
+    BOOST_CHECK(graph.complete(tus[0]));
+    BOOST_CHECK(graph.complete(tus[1]));
+    BOOST_CHECK(graph.complete(tus[2]));
+    BOOST_CHECK_EQUAL(graph.included_files(tus[2]).size(), 1);
+
+    // missing and computed includes make dependencies unknown
+    BOOST_CHECK(!graph.complete(tus[3]));
+    BOOST_CHECK(!graph.complete(tus[4]));
+
+    auto res = graph.affected(tus, "lib/a.hpp");
+    BOOST_REQUIRE_EQUAL(res.size(), 3);
+    BOOST_CHECK_EQUAL(res[0], tus[0]);
+    BOOST_CHECK_EQUAL(res[1], tus[3]);
+    BOOST_CHECK_EQUAL(res[2], tus[4]);
+
+    // unresolved includes are kept in saved graph
+    graph.save(dir / "graph.txt");
+    include_graph loaded{{dir / "inc"}, {dir / "sys"}};
+    loaded.load(dir / "graph.txt");
+    BOOST_CHECK_EQUAL(loaded.size(), graph.size());
+    BOOST_CHECK(!loaded.complete(tus[3]));
+    BOOST_CHECK(loaded.complete(tus[0]));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
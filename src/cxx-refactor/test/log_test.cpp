@@ -0,0 +1,90 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_test.cpp
+/// Contains unit tests for compile time and runtime filtering of log statements.
+
+#include "log/log.hpp"
+#include "log/log_init.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <filesystem>
+
+
+namespace fs = std::filesystem;
+
+
+#pragma push_macro("REFACTOR_LOG_MIN_LEVEL")
+#undef REFACTOR_LOG_MIN_LEVEL
+#define REFACTOR_LOG_MIN_LEVEL 2
+
+/// Writes trace and info records with trace compiled out
+static void log_with_trace_compiled_out(int & trace_count, int & info_count) {
+    REFACTOR_LOG_TRACE(test) << REFACTOR_LOG_LAZY(++trace_count);
+    REFACTOR_LOG_INFO(test) << REFACTOR_LOG_LAZY(++info_count);
+}
+
+#pragma pop_macro("REFACTOR_LOG_MIN_LEVEL")
+
+
+BOOST_AUTO_TEST_SUITE(log_test)
+
+
+/// Checks that lazy payloads are evaluated only for records passing filter
+/// and are never evaluated for compiled out statements
+BOOST_FIXTURE_TEST_CASE(lazy_payload_test, temp_dir_fixture) {
+    log_init(false, dir / "log.txt");
+
+    int trace_count = 0;
+    int info_count = 0;
+
+    refactor_log_configure(boost::log::trivial::info, {});
+    REFACTOR_LOG_TRACE(test) << REFACTOR_LOG_LAZY(++trace_count);
+    REFACTOR_LOG_INFO(test) << REFACTOR_LOG_LAZY(++info_count);
+    BOOST_CHECK_EQUAL(trace_count, 0);
+    BOOST_CHECK_EQUAL(info_count, 1);
+
+    refactor_log_configure(boost::log::trivial::trace, {});
+    REFACTOR_LOG_TRACE(test) << REFACTOR_LOG_LAZY(++trace_count);
+    BOOST_CHECK_EQUAL(trace_count, 1);
+
+    log_with_trace_compiled_out(trace_count, info_count);
+    BOOST_CHECK_EQUAL(trace_count, 1);
+    BOOST_CHECK_EQUAL(info_count, 2);
+
+    log_shutdown();
+    refactor_log_configure(boost::log::trivial::info, {});
+}
+
+
+/// Checks that records written without log macros are filtered by global severity
+/// level and don't affect levels of categories
+BOOST_FIXTURE_TEST_CASE(uncategorized_filter_test, temp_dir_fixture) {
+    log_init(false, dir / "log.txt");
+
+    boost::log::sources::severity_logger<boost::log::trivial::severity_level> lg;
+    int debug_count = 0;
+    int info_count = 0;
+    int cat_debug_count = 0;
+
+    refactor_log_configure(boost::log::trivial::info, {{"test", boost::log::trivial::debug}});
+    BOOST_LOG_SEV(lg, boost::log::trivial::debug) << ++debug_count;
+    BOOST_LOG_SEV(lg, boost::log::trivial::info) << ++info_count;
+    REFACTOR_LOG_DEBUG(test) << REFACTOR_LOG_LAZY(++cat_debug_count);
+    BOOST_CHECK_EQUAL(debug_count, 0);
+    BOOST_CHECK_EQUAL(info_count, 1);
+    BOOST_CHECK_EQUAL(cat_debug_count, 1);
+
+    refactor_log_configure(boost::log::trivial::debug, {});
+    BOOST_LOG_SEV(lg, boost::log::trivial::debug) << ++debug_count;
+    BOOST_CHECK_EQUAL(debug_count, 1);
+
+    log_shutdown();
+    refactor_log_configure(boost::log::trivial::info, {});
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
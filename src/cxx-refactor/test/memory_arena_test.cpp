@@ -0,0 +1,137 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file memory_arena_test.cpp
+/// Contains unit tests for the memory_arena class.
+
+#include "../memory_arena.hpp"
+#include "../streaming_executor.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+
+
+/// Action extracting empty result from code model
+class empty_action: public refactor_action {
+public:
+    std::string name() const override { return "empty"; }
+
+    boost::program_options::options_description opts() const override { return {}; }
+
+    action_result extract(const cm::src::source_code_model &,
+                          const boost::program_options::variables_map &) const override {
+        return action_result{};
+    }
+};
+
+
+BOOST_AUTO_TEST_SUITE(memory_arena_test)
+
+
+/// Checks allocation alignment, ownership of blocks and release of arena
+BOOST_AUTO_TEST_CASE(allocate_release_test) {
+    arena_options opts;
+    opts.reserve_bytes = 1 << 20;
+
+    memory_arena arena{opts};
+    auto p1 = arena.allocate(3, 1);
+    auto p2 = arena.allocate(16, 64);
+    BOOST_REQUIRE(p1 != nullptr);
+    BOOST_REQUIRE(p2 != nullptr);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::uintptr_t>(p2) % 64, 0);
+    BOOST_CHECK_EQUAL(arena.allocations(), 2);
+    BOOST_CHECK_EQUAL(arena.requested_bytes(), 19);
+
+    int local = 0;
+    BOOST_CHECK(memory_arena::owns(p1));
+    BOOST_CHECK(memory_arena::owns(p2));
+    BOOST_CHECK(!memory_arena::owns(&local));
+
+    // arena is exhausted when reserved region is used
+    BOOST_CHECK(arena.allocate(opts.reserve_bytes, 1) == nullptr);
+
+    auto before = memory_arena::all_totals();
+    arena.release();
+    BOOST_CHECK(!memory_arena::owns(p1));
+    BOOST_CHECK(arena.allocate(1, 1) == nullptr);
+    BOOST_CHECK_EQUAL(memory_arena::all_totals().arenas, before.arenas + 1);
+}
+
+
+/// Checks that arena scope sets and restores current arena of thread
+BOOST_AUTO_TEST_CASE(scope_test) {
+    arena_options opts;
+    opts.reserve_bytes = 1 << 20;
+
+    memory_arena a1{opts};
+    memory_arena a2{opts};
+    BOOST_CHECK(memory_arena::current() == nullptr);
+    {
+        arena_scope s1{a1};
+        BOOST_CHECK(memory_arena::current() == &a1);
+        {
+            arena_scope s2{a2};
+            BOOST_CHECK(memory_arena::current() == &a2);
+        }
+        BOOST_CHECK(memory_arena::current() == &a1);
+    }
+    BOOST_CHECK(memory_arena::current() == nullptr);
+}
+
+
+/// Checks that arena suspension clears and restores current arena of thread
+BOOST_AUTO_TEST_CASE(suspend_test) {
+    arena_options opts;
+    opts.reserve_bytes = 1 << 20;
+
+    memory_arena arena{opts};
+    {
+        arena_scope scope{arena};
+        {
+            arena_suspend no_arena;
+            BOOST_CHECK(memory_arena::current() == nullptr);
+        }
+        BOOST_CHECK(memory_arena::current() == &arena);
+    }
+    BOOST_CHECK(memory_arena::current() == nullptr);
+}
+
+
+/// Checks that error of translation unit parsed in arena is reported with its message
+/// after arena is released
+BOOST_FIXTURE_TEST_CASE(parse_error_test, temp_dir_fixture) {
+    write_file(dir / "good.cpp", "int a;\n");
+    write_file(dir / "broken.cpp", "#error broken translation unit\nint b = ;\n");
+
+    std::string expected;
+    try {
+        parse_tu(dir / "broken.cpp");
+    }
+    catch (const std::exception & err) {
+        expected = err.what();
+    }
+
+    BOOST_REQUIRE(!expected.empty());
+
+    // the first translation unit of task is parsed without arena, the second one in arena
+    arena_options opts;
+    opts.enabled = true;
+    opts.reserve_bytes = 64 << 20;
+
+    thread_pool pool{1};
+    streaming_executor executor{1, opts, pool};
+    std::string msg;
+    try {
+        executor.run(empty_action{}, {dir / "good.cpp", dir / "broken.cpp"}, {});
+    }
+    catch (const std::exception & err) {
+        msg = err.what();
+    }
+
+    BOOST_CHECK_EQUAL(msg, expected);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file result_cache_test.cpp
+/// Contains unit tests for the result_cache class.
+
+#include "../result_cache.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+#include <thread>
+
+
+namespace fs = std::filesystem;
+namespace po = boost::program_options;
+
+
+/// Returns result with single modification of specified source
+static action_result make_result(const fs::path & p, const std::string & insert) {
+    action_result res;
+    res.mods().add(p, compact_modification{0, 3, insert});
+    res.add_message("done");
+    return res;
+}
+
+
+BOOST_AUTO_TEST_SUITE(result_cache_test)
+
+
+/// Checks that queries are normalized and depend on action arguments and inputs
+BOOST_AUTO_TEST_CASE(query_test) {
+    po::options_description desc;
+    desc.add_options()
+        ("position", po::value<std::string>())
+        ("count", po::value<unsigned>()->default_value(2))
+        ("flag", "switch");
+
+    auto parse = [&](std::vector<std::string> args) {
+        po::variables_map var_map;
+        po::store(po::command_line_parser(args).options(desc).run(), var_map);
+        po::notify(var_map);
+        return var_map;
+    };
+
+    auto q1 = result_cache::make_query("act", parse({"--position", "a.cpp:1:2", "--flag"}), {"a.cpp"});
+    auto q2 = result_cache::make_query("act", parse({"--flag", "--position", "a.cpp:1:2"}), {"a.cpp"});
+    auto q3 = result_cache::make_query("act", parse({"--position", "a.cpp:1:3", "--flag"}), {"a.cpp"});
+    auto q4 = result_cache::make_query("act", parse({"--position", "a.cpp:1:2", "--flag"}), {"b.cpp"});
+    auto q5 = result_cache::make_query("other", parse({"--position", "a.cpp:1:2", "--flag"}), {"a.cpp"});
+
+    auto q6 = result_cache::make_query("act", parse({"--position", "a.cpp:1:2", "--flag"}), {"a.cpp"},
+                                       {"-Iinclude"});
+
+    BOOST_REQUIRE(q1 && q2 && q3 && q4 && q5 && q6);
+    BOOST_CHECK_EQUAL(*q1, *q2);
+    BOOST_CHECK_NE(*q1, *q3);
+    BOOST_CHECK_NE(*q1, *q4);
+    BOOST_CHECK_NE(*q1, *q5);
+    BOOST_CHECK_NE(*q1, *q6);
+}
+
+
+/// Checks parsing of dependency output of compiler, compiler is replaced with script
+/// printing make rule
+BOOST_FIXTURE_TEST_CASE(compiler_dependencies_test, temp_dir_fixture) {
+    write_file(dir / "cc.sh",
+               "#!/bin/sh\n"
+               "[ \"$1\" = -Ibad ] && exit 1\n"
+               "echo 'x: a.cpp /inc/my\\ header.hpp \\'\n"
+               "echo ' /usr/include/vector cost$$.hpp'\n");
+    fs::permissions(dir / "cc.sh", fs::perms::owner_all);
+
+    auto deps = result_cache::compiler_dependencies((dir / "cc.sh").string(), {"-Iinc"}, "a.cpp");
+    BOOST_REQUIRE(deps);
+    BOOST_REQUIRE_EQUAL(deps->size(), 4);
+    BOOST_CHECK_EQUAL((*deps)[0], "a.cpp");
+    BOOST_CHECK_EQUAL((*deps)[1], "/inc/my header.hpp");
+    BOOST_CHECK_EQUAL((*deps)[2], "/usr/include/vector");
+    BOOST_CHECK_EQUAL((*deps)[3], "cost$.hpp");
+
+    // dependencies are unknown if compiler fails or can't be run
+    BOOST_CHECK(!result_cache::compiler_dependencies((dir / "cc.sh").string(), {"-Ibad"}, "a.cpp"));
+    BOOST_CHECK(!result_cache::compiler_dependencies((dir / "none.sh").string(), {}, "a.cpp"));
+}
+
+
+/// Checks that stored result is found only while contents of files read by action
+/// don't change
+BOOST_FIXTURE_TEST_CASE(find_test, temp_dir_fixture) {
+    fs::create_directories(dir / "src");
+    write_file(dir / "src/a.cpp", "int x;\n");
+    write_file(dir / "src/a.hpp", "int y;\n");
+
+    thread_pool pool{2};
+    result_cache cache{dir / "cache", 1 << 20};
+    BOOST_CHECK(!cache.find("query", pool));
+
+    cache.store("query", {dir / "src/a.cpp", dir / "src/a.hpp"}, make_result(dir / "src/a.cpp", "long"), pool);
+    BOOST_CHECK(!cache.find("another query", pool));
+
+    auto res = cache.find("query", pool);
+    BOOST_REQUIRE(res);
+    BOOST_CHECK_EQUAL(res->messages().size(), 1);
+    auto smods = res->mods().find(dir / "src/a.cpp");
+    BOOST_REQUIRE(smods != nullptr);
+    BOOST_CHECK_EQUAL(smods->mods().front().insert_string(), "long");
+
+    // rewriting file with the same contents changes only its stamp
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    write_file(dir / "src/a.hpp", "int y;\n");
+    BOOST_CHECK(cache.find("query", pool));
+
+    write_file(dir / "src/a.hpp", "int z;\n");
+    BOOST_CHECK(!cache.find("query", pool));
+}
+
+
+/// Checks that least recently used entries are evicted when cache exceeds size limit
+BOOST_FIXTURE_TEST_CASE(evict_test, temp_dir_fixture) {
+    write_file(dir / "a.cpp", "int x;\n");
+
+    thread_pool pool{2};
+    result_cache unbounded{dir / "cache", 1 << 20};
+    unbounded.store("first", {dir / "a.cpp"}, make_result(dir / "a.cpp", "long"), pool);
+    auto entry_size = unbounded.size();
+    BOOST_REQUIRE(entry_size > 0);
+
+    // cache with limit of two entries, the first entry is used after the second one
+    result_cache cache{dir / "cache", entry_size * 2 + entry_size / 2};
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    cache.store("secnd", {dir / "a.cpp"}, make_result(dir / "a.cpp", "char"), pool);
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    BOOST_CHECK(cache.find("first", pool));
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    cache.store("third", {dir / "a.cpp"}, make_result(dir / "a.cpp", "auto"), pool);
+
+    BOOST_CHECK(cache.size() <= entry_size * 2 + entry_size / 2);
+    BOOST_CHECK(cache.find("first", pool));
+    BOOST_CHECK(!cache.find("secnd", pool));
+    BOOST_CHECK(cache.find("third", pool));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
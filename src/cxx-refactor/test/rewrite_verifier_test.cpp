@@ -0,0 +1,115 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file rewrite_verifier_test.cpp
+/// Contains unit tests for the rewrite_verifier class.
+
+#include "../rewrite_verifier.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+BOOST_AUTO_TEST_SUITE(rewrite_verifier_test)
+
+
+/// Checks selection of diagnostics which appear only after rewriting
+BOOST_AUTO_TEST_CASE(new_diagnostics_test) {
+    auto before = rewrite_verifier::parse_diagnostics(
+        "a.cpp:3:1: warning: unused variable 'x'\n"
+        "note: some note\n"
+        "a.hpp:10:5: error: unknown type name 'T'\n");
+    BOOST_REQUIRE_EQUAL(before.size(), 2);
+
+    // shifted existing diagnostics are not new
+    auto after = rewrite_verifier::parse_diagnostics(
+        "a.cpp:5:1: warning: unused variable 'x'\n"
+        "a.hpp:12:5: error: unknown type name 'T'\n"
+        "a.hpp:12:9: error: expected expression\n"
+        "a.hpp:14:9: error: unknown type name 'T'");
+
+    auto diags = rewrite_verifier::new_diagnostics(before, after);
+    BOOST_REQUIRE_EQUAL(diags.size(), 2);
+    BOOST_CHECK_EQUAL(diags[0], "a.hpp:12:9: error: expected expression");
+    BOOST_CHECK_EQUAL(diags[1], "a.hpp:14:9: error: unknown type name 'T'");
+}
+
+
+/// Checks that rewritten sources are passed to compiler through overlay of memory
+/// files and only translation units including modified sources or having unresolved
+/// includes are verified.
+/// Compiler is replaced with script reporting placeholders in overlay files
+BOOST_FIXTURE_TEST_CASE(verify_test, temp_dir_fixture) {
+
+    write_file(dir / "a.hpp", "template <typename T, typename U> struct a;\n");
+    write_file(dir / "tu1.cpp", "#include \"a.hpp\"\n");
+    write_file(dir / "tu2.cpp", "int x;\n");
+    write_file(dir / "tu3.cpp", "#include HEADER_MACRO\n");
+    write_file(dir / "cc.sh",
+               "#!/bin/sh\n"
+               "prev=; overlay=\n"
+               "for a in \"$@\"; do [ \"$prev\" = -ivfsoverlay ] && overlay=$a; prev=$a; done\n"
+               "[ -z \"$overlay\" ] && exit 0\n"
+               "for f in $(grep -o '\"external-contents\":\"[^\"]*\"' $overlay | cut -d'\"' -f4); do\n"
+               "  grep -q '?\?' $f && echo \"$a:1:1: error: placeholder\" >&2\n"
+               "done\n"
+               "exit 1\n");
+    fs::permissions(dir / "cc.sh", fs::perms::owner_all);
+
+    std::vector<fs::path> tus{dir / "tu1.cpp", dir / "tu2.cpp", dir / "tu3.cpp"};
+    include_graph graph;
+    for (auto && tu : tus) {
+        graph.update(tu);
+    }
+
+    multi_source_modifications mods;
+    mods.add(dir / "a.hpp", compact_modification{22, 33, "??"});
+
+    rewrite_verifier verifier{(dir / "cc.sh").string()};
+    auto reports = verifier.verify(tus, mods, graph);
+
+    BOOST_REQUIRE_EQUAL(reports.size(), 2);
+    BOOST_CHECK_EQUAL(reports[0].tu, dir / "tu1.cpp");
+    BOOST_CHECK_EQUAL(reports[1].tu, dir / "tu3.cpp");
+    BOOST_REQUIRE_EQUAL(reports[0].new_diagnostics.size(), 1);
+    BOOST_CHECK(reports[0].new_diagnostics[0].find("placeholder") != std::string::npos);
+
+    // source on disk is not modified
+    std::ifstream istr{dir / "a.hpp"};
+    std::string text{std::istreambuf_iterator<char>{istr}, {}};
+    BOOST_CHECK(text.find("??") == std::string::npos);
+}
+
+
+/// Checks that verification fails if compiler is killed or exits with unexpected status
+BOOST_FIXTURE_TEST_CASE(compiler_failure_test, temp_dir_fixture) {
+
+    write_file(dir / "a.hpp", "int a;\n");
+    write_file(dir / "tu.cpp", "#include \"a.hpp\"\n");
+    write_file(dir / "killed.sh", "#!/bin/sh\nkill -9 $$\n");
+    write_file(dir / "crashed.sh", "#!/bin/sh\nexit 70\n");
+    fs::permissions(dir / "killed.sh", fs::perms::owner_all);
+    fs::permissions(dir / "crashed.sh", fs::perms::owner_all);
+
+    std::vector<fs::path> tus{dir / "tu.cpp"};
+    include_graph graph;
+    graph.update(tus[0]);
+
+    multi_source_modifications mods;
+    mods.add(dir / "a.hpp", compact_modification{4, 5, "b"});
+
+    rewrite_verifier killed{(dir / "killed.sh").string()};
+    BOOST_CHECK_THROW(killed.verify(tus, mods, graph), std::runtime_error);
+
+    rewrite_verifier crashed{(dir / "crashed.sh").string()};
+    BOOST_CHECK_THROW(crashed.verify(tus, mods, graph), std::runtime_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
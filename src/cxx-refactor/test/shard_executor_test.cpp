@@ -0,0 +1,90 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file shard_executor_test.cpp
+/// Contains unit tests for the shard_executor class.
+
+#include "../refactor_action.hpp"
+#include "../shard_executor.hpp"
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <csignal>
+
+
+namespace fs = std::filesystem;
+
+
+/// Returns result with one modification in each translation unit of shard
+static action_result mod_per_tu(const std::vector<fs::path> & tus) {
+    action_result res;
+    for (auto && tu : tus) {
+        res.mods().add(tu, compact_modification{0, 1, "x"});
+    }
+
+    res.add_message("processed");
+    return res;
+}
+
+
+BOOST_AUTO_TEST_SUITE(shard_executor_test)
+
+
+/// Checks that results of all shards are merged
+BOOST_AUTO_TEST_CASE(merge_test) {
+    std::vector<fs::path> inputs{"s1.cpp", "s2.cpp", "s3.cpp", "s4.cpp", "s5.cpp"};
+
+    shard_executor executor{3, mod_per_tu};
+    auto res = executor.run(inputs);
+
+    BOOST_CHECK(executor.errors().empty());
+    BOOST_CHECK_EQUAL(res.mods().mods().size(), inputs.size());
+    for (auto && tu : inputs) {
+        BOOST_CHECK(res.mods().find(tu) != nullptr);
+    }
+
+    BOOST_CHECK_EQUAL(res.messages().size(), 1);
+}
+
+
+/// Checks that crash or error of one worker loses only results of its shard
+BOOST_AUTO_TEST_CASE(failed_shard_test) {
+    std::vector<fs::path> inputs{"f1.cpp", "crash.cpp", "f3.cpp", "error.cpp"};
+
+    shard_executor executor{4, [](const std::vector<fs::path> & tus) {
+        if (tus.front() == "crash.cpp") {
+            std::raise(SIGKILL);
+        }
+
+        if (tus.front() == "error.cpp") {
+            throw std::runtime_error{"can't parse"};
+        }
+
+        return mod_per_tu(tus);
+    }};
+
+    auto res = executor.run(inputs);
+
+    BOOST_CHECK_EQUAL(res.mods().mods().size(), 2);
+    BOOST_CHECK(res.mods().find("f1.cpp") != nullptr);
+    BOOST_CHECK(res.mods().find("f3.cpp") != nullptr);
+
+    BOOST_REQUIRE_EQUAL(executor.errors().size(), 2);
+    BOOST_CHECK(executor.errors()[0].find("crash.cpp") != std::string::npos);
+    BOOST_CHECK(executor.errors()[1].find("can't parse") != std::string::npos);
+}
+
+
+/// Checks that source not found error is reported if no shard found source
+BOOST_AUTO_TEST_CASE(not_found_test) {
+    shard_executor executor{2, [](const std::vector<fs::path> &) -> action_result {
+        throw source_not_found_error{"source not found"};
+    }};
+
+    BOOST_CHECK_THROW(executor.run({"n1.cpp", "n2.cpp"}), source_not_found_error);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
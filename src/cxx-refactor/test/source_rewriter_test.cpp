@@ -16,10 +16,11 @@ BOOST_AUTO_TEST_SUITE(source_rewriter_test)
 
 /// Simple rewriter test
 BOOST_AUTO_TEST_CASE(simple_test) {
-    std::istringstream istr{"test\ninput string\nlast line"};
+    std::string text{"test\ninput string\nlast line"};
+    std::istringstream istr{text};
     std::ostringstream ostr;
 
-    single_source_modifications mods;
+    single_source_modifications mods{std::make_shared<const line_index>(text)};
     mods.add(source_modification{{{1, 3}, {2, 5}}, "inserted string"});
 
     source_rewriter rw;
@@ -29,4 +30,38 @@ BOOST_AUTO_TEST_CASE(simple_test) {
 }
 
 
+/// Checks conversion of line/column positions to byte offsets and back
+BOOST_AUTO_TEST_CASE(line_index_test) {
+    line_index idx{"ab\n\ncd"};
+    BOOST_CHECK_EQUAL(idx.lines_count(), 3);
+    BOOST_CHECK_EQUAL(idx.offset({1, 1}), 0);
+    BOOST_CHECK_EQUAL(idx.offset({1, 3}), 2);
+    BOOST_CHECK_EQUAL(idx.offset({2, 1}), 3);
+    BOOST_CHECK_EQUAL(idx.offset({3, 3}), 6);
+    BOOST_CHECK_THROW(idx.offset({1, 4}), std::runtime_error);
+    BOOST_CHECK_THROW(idx.offset({4, 1}), std::runtime_error);
+    BOOST_CHECK(idx.position(5) == (cm::src::source_position{3, 2}));
+    BOOST_CHECK(idx.position(3) == (cm::src::source_position{2, 1}));
+}
+
+
+/// Checks that modifications ending at the end of source are applied and
+/// modifications outside of source are reported
+BOOST_AUTO_TEST_CASE(source_end_test) {
+    single_source_modifications mods;
+    mods.add(compact_modification{0, 1, "x"});
+    mods.add(compact_modification{3, 4, "yz"});
+
+    std::istringstream istr{"abcd"};
+    std::ostringstream ostr;
+    source_rewriter rw;
+    rw.rewrite(mods, istr, ostr);
+    BOOST_CHECK_EQUAL(ostr.str(), "xbcyz");
+
+    mods.add(compact_modification{10, 12, ""});
+    std::istringstream istr2{"abcd"};
+    BOOST_CHECK_THROW(rw.rewrite(mods, istr2, ostr), std::runtime_error);
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,52 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file source_watcher_test.cpp
+/// Contains unit tests for the source_watcher class.
+
+#include "../source_watcher.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+BOOST_AUTO_TEST_SUITE(source_watcher_test)
+
+
+/// Checks that changes of files are collected into one debounced list,
+/// and that new subdirectories are watched
+BOOST_FIXTURE_TEST_CASE(changes_test, temp_dir_fixture) {
+    fs::create_directories(dir / "inc");
+    write_file(dir / "a.cpp", "int a;\n");
+
+    source_watcher watcher{{dir}};
+    std::chrono::milliseconds debounce{50};
+
+    write_file(dir / "a.cpp", "int a = 1;\n");
+    write_file(dir / "inc" / "b.hpp", "int b;\n");
+    fs::create_directory(dir / "new");
+
+    auto changed = watcher.wait_changes(debounce, {}).files;
+    BOOST_REQUIRE_EQUAL(changed.size(), 2);
+    BOOST_CHECK_EQUAL(changed[0], dir / "a.cpp");
+    BOOST_CHECK_EQUAL(changed[1], dir / "inc" / "b.hpp");
+
+    write_file(dir / "new" / "c.hpp", "int c;\n");
+    changed = watcher.wait_changes(debounce, {}).files;
+    BOOST_REQUIRE_EQUAL(changed.size(), 1);
+    BOOST_CHECK_EQUAL(changed[0], dir / "new" / "c.hpp");
+
+    // waiting stops when stop is requested
+    std::stop_source stop;
+    stop.request_stop();
+    BOOST_CHECK(watcher.wait_changes(debounce, stop.get_token()).empty());
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,102 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file symbol_prefilter_test.cpp
+/// Contains unit tests for the symbol_prefilter class.
+
+#include "../symbol_prefilter.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+BOOST_AUTO_TEST_SUITE(symbol_prefilter_test)
+
+
+/// Checks substring search at all positions of text longer than vector block
+BOOST_AUTO_TEST_CASE(contains_substring_test) {
+    std::string text(100, 'a');
+    BOOST_CHECK(!contains_substring(text, "ab"));
+    BOOST_CHECK(contains_substring(text, "aaa"));
+    BOOST_CHECK(contains_substring(text, ""));
+    BOOST_CHECK(!contains_substring("ab", "abc"));
+
+    for (std::size_t pos = 0; pos + 3 <= text.size(); ++pos) {
+        auto str = text;
+        str.replace(pos, 3, "xyz");
+        BOOST_CHECK(contains_substring(str, "xyz"));
+        BOOST_CHECK(!contains_substring(str, "xzz"));
+    }
+}
+
+
+/// Checks selection of translation units mentioning symbol in their text or headers.
+/// Identifiers containing symbol spelling as a part don't mention symbol
+BOOST_FIXTURE_TEST_CASE(candidates_test, temp_dir_fixture) {
+
+    std::ofstream{dir / "a.hpp"} << "template <typename T> class my_class {};\n";
+    std::ofstream{dir / "tu1.cpp"} << "#include \"a.hpp\"\nmy_class<int> x;\n";
+    std::ofstream{dir / "tu2.cpp"} << "int other;\n";
+    std::ofstream{dir / "tu3.cpp"} << "int my_class_count;\n";
+    std::vector<fs::path> tus{dir / "tu1.cpp", dir / "tu2.cpp", dir / "tu3.cpp"};
+
+    include_graph graph;
+    for (auto && tu : tus) {
+        graph.update(tu);
+    }
+
+    symbol_prefilter prefilter;
+    auto res = prefilter.candidates(tus, "my_class", graph);
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res[0], tus[0]);
+
+    BOOST_CHECK(prefilter.candidates(tus, "no_such_symbol", graph).empty());
+    BOOST_CHECK_EQUAL(identifier_at(dir / "tu1.cpp", {2, 4}).value_or(""), "my_class");
+    BOOST_CHECK(!identifier_at(dir / "tu1.cpp", {2, 14}));
+}
+
+
+/// Checks that saved bitmaps are reused by another pre-filter and that files are only
+/// searched if bitmaps are not cached
+BOOST_FIXTURE_TEST_CASE(cache_test, temp_dir_fixture) {
+
+    std::ofstream{dir / "a.hpp"} << "class my_class {};\n";
+    std::ofstream{dir / "tu1.cpp"} << "#include \"a.hpp\"\nmy_class x;\n";
+    std::ofstream{dir / "tu2.cpp"} << "int other;\n";
+    std::vector<fs::path> tus{dir / "tu1.cpp", dir / "tu2.cpp"};
+
+    include_graph graph;
+    for (auto && tu : tus) {
+        graph.update(tu);
+    }
+
+    symbol_prefilter uncached{false};
+    BOOST_CHECK_EQUAL(uncached.candidates(tus, "my_class", graph).size(), 1);
+    BOOST_CHECK_EQUAL(uncached.scanned_count(), 0);
+
+    symbol_prefilter first;
+    BOOST_CHECK_EQUAL(first.candidates(tus, "my_class", graph).size(), 1);
+    BOOST_CHECK_NE(first.scanned_count(), 0);
+    first.save(dir / "cache");
+
+    symbol_prefilter second;
+    second.load(dir / "cache");
+    auto res = second.candidates(tus, "my_class", graph);
+    BOOST_REQUIRE_EQUAL(res.size(), 1);
+    BOOST_CHECK_EQUAL(res[0], tus[0]);
+    BOOST_CHECK_EQUAL(second.scanned_count(), 0);
+
+    // with bitmaps from cache files are searched only if they may contain spelling
+    auto searched = second.searched_count();
+    second.candidates(tus, "no_such_symbol", graph);
+    BOOST_CHECK_LE(second.searched_count() - searched, 1);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
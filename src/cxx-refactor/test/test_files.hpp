@@ -0,0 +1,53 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file test_files.hpp
+/// Contains helpers of unit tests working with files.
+
+#pragma once
+
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+
+/// Writes text to file located at specified path
+inline void write_file(const std::filesystem::path & p, const std::string & text) {
+    std::ofstream ostr{p};
+    ostr << text;
+}
+
+
+/// Fixture creating empty temporary directory for test case. Directory name includes
+/// name of test case, process identifier and sequence number, so concurrently running
+/// tests don't share directories. Directory is removed with its contents after test
+struct temp_dir_fixture {
+    /// Creates temporary directory
+    explicit temp_dir_fixture() {
+        static std::atomic<unsigned> counter{0};
+        auto & tc = boost::unit_test::framework::current_test_case();
+        dir = std::filesystem::temp_directory_path() /
+            ("cxx-refactor-" + std::string{tc.p_name.get()} + "-" +
+             std::to_string(::getpid()) + "-" + std::to_string(counter++));
+
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+
+    /// Removes temporary directory
+    ~temp_dir_fixture() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    temp_dir_fixture(const temp_dir_fixture &) = delete;
+    temp_dir_fixture & operator=(const temp_dir_fixture &) = delete;
+
+    std::filesystem::path dir;              ///< Temporary directory
+};
@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file thread_pool_test.cpp
+/// Contains unit tests for the thread_pool class.
+
+#include "../thread_pool.hpp"
+#include <boost/test/unit_test.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+
+BOOST_AUTO_TEST_SUITE(thread_pool_test)
+
+
+/// Checks that parallel loop executes function for each index exactly once
+BOOST_AUTO_TEST_CASE(parallel_for_test) {
+    thread_pool pool{4};
+    std::vector<std::atomic<int>> counters(1000);
+
+    pool.parallel_for(counters.size(), [&](std::size_t i) { ++counters[i]; });
+
+    for (auto && c : counters) {
+        BOOST_CHECK_EQUAL(c.load(), 1);
+    }
+}
+
+
+/// Checks nested parallel loops and exception propagation
+BOOST_AUTO_TEST_CASE(nested_test) {
+    thread_pool pool{3};
+    std::atomic<std::size_t> total{0};
+
+    pool.parallel_for(8, [&](std::size_t) {
+        pool.parallel_for(100, [&](std::size_t) { ++total; });
+    });
+
+    BOOST_CHECK_EQUAL(total.load(), 800);
+
+    auto fn = [](std::size_t i) {
+        if (i == 5) {
+            throw std::runtime_error{"test error"};
+        }
+    };
+
+    BOOST_CHECK_THROW(pool.parallel_for(10, fn), std::runtime_error);
+}
+
+
+/// Checks that time of nested tasks is counted in busy time once
+BOOST_AUTO_TEST_CASE(busy_time_test) {
+    using namespace std::chrono_literals;
+
+    thread_pool pool{4};
+    pool.parallel_for(4, [&](std::size_t) {
+        pool.parallel_for(2, [&](std::size_t) { std::this_thread::sleep_for(10ms); });
+    });
+
+    // 8 nested tasks sleep 10 ms each, outer tasks wait for nested tasks in other threads
+    auto busy = pool.busy_time();
+    BOOST_CHECK_GE(busy, 80ms);
+    BOOST_CHECK_LT(busy, 400ms);
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
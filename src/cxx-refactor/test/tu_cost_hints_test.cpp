@@ -0,0 +1,47 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file tu_cost_hints_test.cpp
+/// Contains unit tests for the tu_cost_hints class.
+
+#include "../tu_cost_hints.hpp"
+#include "test_files.hpp"
+#include <boost/test/unit_test.hpp>
+#include <fstream>
+
+
+namespace fs = std::filesystem;
+
+
+BOOST_AUTO_TEST_SUITE(tu_cost_hints_test)
+
+
+/// Checks ordering of translation units by measured and estimated costs and
+/// saving of hints
+BOOST_FIXTURE_TEST_CASE(order_test, temp_dir_fixture) {
+    using namespace std::chrono_literals;
+
+    std::vector<fs::path> tus{dir / "small.cpp", dir / "big.cpp", dir / "new.cpp"};
+    std::ofstream{tus[0]} << std::string(100, ' ');
+    std::ofstream{tus[1]} << std::string(100, ' ');
+    std::ofstream{tus[2]} << std::string(150, ' ');
+
+    tu_cost_hints hints;
+    BOOST_CHECK((hints.order(tus) == std::vector<std::size_t>{2, 0, 1}));
+
+    // unmeasured translation unit is estimated with average cost of byte
+    hints.record(tus[0], 1ms);
+    hints.record(tus[1], 100ms);
+    BOOST_CHECK((hints.order(tus) == std::vector<std::size_t>{1, 2, 0}));
+
+    hints.save(dir / "costs.txt");
+    tu_cost_hints loaded;
+    loaded.load(dir / "costs.txt");
+    BOOST_CHECK((loaded.order(tus) == std::vector<std::size_t>{1, 2, 0}));
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
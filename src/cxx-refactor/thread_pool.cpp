@@ -0,0 +1,268 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file thread_pool.cpp
+/// Contains implementation of the thread_pool class.
+
+#include "thread_pool.hpp"
+#include "cancellation.hpp"
+#include "memory_accounting.hpp"
+#include "trace_recorder.hpp"
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+
+/// Pool owning current worker thread
+static thread_local const thread_pool * current_pool = nullptr;
+
+/// Index of queue owned by current worker thread
+static thread_local std::size_t current_worker_idx = 0;
+
+/// Depth of nested tasks executed by current thread
+static thread_local std::size_t current_task_depth = 0;
+
+/// Counter of remaining tasks of parallel loop, set by task of loop at its end
+/// and decremented after busy time of task is accounted
+static thread_local std::atomic<std::size_t> * completed_loop_counter = nullptr;
+
+
+/// Increases depth of nested tasks of current thread for lifetime of object
+struct task_depth_guard {
+    task_depth_guard() { ++current_task_depth; }
+    ~task_depth_guard() { --current_task_depth; }
+};
+
+
+thread_pool::thread_pool(std::size_t threads_count) {
+    if (threads_count == 0) {
+        threads_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    auto workers_count = threads_count - 1;
+    for (std::size_t i = 0; i < workers_count + 1; ++i) {
+        queues_.push_back(std::make_unique<task_queue>());
+    }
+
+    for (std::size_t i = 0; i < workers_count; ++i) {
+        workers_.emplace_back([this, i]() { worker_main(i); });
+    }
+}
+
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard lock{sleep_mtx_};
+        stop_ = true;
+    }
+
+    sleep_cv_.notify_all();
+    workers_.clear();
+}
+
+
+std::ptrdiff_t thread_pool::current_queue_index() const {
+    return current_pool == this ? static_cast<std::ptrdiff_t>(current_worker_idx) : -1;
+}
+
+
+void thread_pool::submit(task && t) {
+    arena_suspend no_arena;
+    auto idx = current_queue_index();
+    auto & queue = idx >= 0 ? *queues_[idx] : *queues_.back();
+
+    {
+        std::lock_guard lock{queue.mtx};
+        queue.tasks.push_back(std::move(t));
+    }
+
+    {
+        std::lock_guard lock{sleep_mtx_};
+        ++pending_;
+    }
+
+    sleep_cv_.notify_one();
+}
+
+
+bool thread_pool::run_pending_task() {
+    if (pending_.load() == 0) {
+        return false;
+    }
+
+    task t;
+    auto own_idx = current_queue_index();
+
+    // trying take task from the back of own queue
+    if (own_idx >= 0) {
+        auto & queue = *queues_[own_idx];
+        std::lock_guard lock{queue.mtx};
+        if (!queue.tasks.empty()) {
+            t = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+    }
+
+    // stealing task from the front of other queues
+    if (!t) {
+        auto start = own_idx >= 0 ? static_cast<std::size_t>(own_idx) + 1 : 0;
+        for (std::size_t i = 0; i < queues_.size() && !t; ++i) {
+            auto & queue = *queues_[(start + i) % queues_.size()];
+            std::lock_guard lock{queue.mtx};
+            if (!queue.tasks.empty()) {
+                t = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+    }
+
+    if (!t) {
+        return false;
+    }
+
+    --pending_;
+
+    // measuring time of outermost tasks only, nested tasks are executed inside them
+    auto outermost = current_task_depth == 0;
+    auto start = std::chrono::steady_clock::now();
+    {
+        task_depth_guard depth_guard;
+        t();
+    }
+
+    if (outermost) {
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        busy_ns_.fetch_add(std::chrono::nanoseconds{elapsed}.count(), std::memory_order_relaxed);
+    }
+
+    // completing task of parallel loop after its busy time is accounted, so busy time
+    // includes all tasks of completed loop. Thread waiting for loop is woken up with
+    // mutex locked, so wake up is not lost between check of counter and sleeping
+    if (auto counter = std::exchange(completed_loop_counter, nullptr)) {
+        if (--*counter == 0) {
+            { std::lock_guard lock{sleep_mtx_}; }
+            sleep_cv_.notify_all();
+        }
+    }
+
+    return true;
+}
+
+
+void thread_pool::worker_main(std::size_t idx) {
+    current_pool = this;
+    current_worker_idx = idx;
+
+    if (trace_recorder::global().enabled()) {
+        trace_recorder::global().set_thread_name("worker-" + std::to_string(idx + 1));
+    }
+
+    while (true) {
+        if (run_pending_task()) {
+            continue;
+        }
+
+        std::unique_lock lock{sleep_mtx_};
+        sleep_cv_.wait(lock, [this]() { return stop_ || pending_.load() != 0; });
+        if (stop_) {
+            break;
+        }
+    }
+}
+
+
+void thread_pool::parallel_for(std::size_t count, const std::function<void(std::size_t)> & fn) {
+    if (count == 0) {
+        return;
+    }
+
+    // executing sequentially if there are no worker threads
+    if (workers_.empty() || count == 1) {
+        auto outermost = current_task_depth == 0;
+        auto start = std::chrono::steady_clock::now();
+        {
+            task_depth_guard depth_guard;
+            for (std::size_t i = 0; i < count; ++i) {
+                fn(i);
+            }
+        }
+
+        if (outermost) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            busy_ns_.fetch_add(std::chrono::nanoseconds{elapsed}.count(), std::memory_order_relaxed);
+        }
+
+        return;
+    }
+
+    std::atomic<std::size_t> remaining{count};
+    std::mutex err_mtx;
+    std::exception_ptr err;
+
+    // allocations of tasks are attributed to memory subsystem and phase of calling
+    // thread, tasks check cancellation token of calling thread
+    auto mem_subsys = memory_accounting::current_subsystem();
+    auto mem_phase = memory_accounting::current_phase();
+    auto token = cancellation_token::current();
+
+    for (std::size_t i = 0; i < count; ++i) {
+        submit([&, i, mem_subsys, mem_phase, token]() {
+            memory_scope mem_scope{mem_subsys, mem_phase};
+            cancellation_scope cancel_scope{token};
+            try {
+                fn(i);
+            }
+            catch (...) {
+                std::lock_guard lock{err_mtx};
+                if (!err) {
+                    err = std::current_exception();
+                }
+            }
+
+            completed_loop_counter = &remaining;
+        });
+    }
+
+    // executing pending tasks while waiting for completion, when there are no pending
+    // tasks calling thread sleeps until loop completes or new task is submitted.
+    // Idle waiting inside of task is not counted as busy time
+    while (remaining.load() != 0) {
+        if (run_pending_task()) {
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::unique_lock lock{sleep_mtx_};
+            sleep_cv_.wait(lock, [&]() { return remaining.load() == 0 || pending_.load() != 0; });
+        }
+
+        if (current_task_depth != 0) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            wait_ns_.fetch_add(std::chrono::nanoseconds{elapsed}.count(),
+                               std::memory_order_relaxed);
+        }
+    }
+
+    if (err) {
+        std::rethrow_exception(err);
+    }
+}
+
+
+/// Number of threads for global pool
+static std::size_t global_pool_size = 0;
+
+
+void thread_pool::configure_global(std::size_t threads_count) {
+    global_pool_size = threads_count;
+}
+
+
+thread_pool & thread_pool::global() {
+    static thread_pool pool{global_pool_size};
+    return pool;
+}
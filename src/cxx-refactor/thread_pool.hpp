@@ -0,0 +1,96 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file thread_pool.hpp
+/// Contains definition of the thread_pool class.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/// Work stealing thread pool. Each worker thread has own task queue. Workers take
+/// tasks from the back of own queue and steal tasks from the front of other queues
+/// when own queue is empty. Threads waiting for completion of parallel loops execute
+/// pending tasks too, so parallel loops may be nested. Pool measures time threads
+/// spend executing tasks for reporting core utilization.
+class thread_pool {
+public:
+    /// Task executed by pool
+    using task = std::function<void()>;
+
+    /// Constructs pool with specified number of threads including calling thread.
+    /// Zero number of threads means number of hardware threads.
+    explicit thread_pool(std::size_t threads_count = 0);
+
+    /// Stops all worker threads. Pending tasks are not executed
+    ~thread_pool();
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool & operator=(const thread_pool &) = delete;
+
+    /// Returns number of threads used by pool including calling thread
+    std::size_t size() const { return workers_.size() + 1; }
+
+    /// Submits task for execution. Tasks submitted from worker thread are pushed
+    /// into worker own queue
+    void submit(task && t);
+
+    /// Executes function for each index in range [0, count) and waits for completion.
+    /// Calling thread executes pending tasks while waiting and sleeps when there are
+    /// no pending tasks. Rethrows first exception thrown by function.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)> & fn);
+
+    /// Returns total time threads spent executing tasks. Time of nested tasks is
+    /// counted once, time spent waiting in nested parallel loops is not counted
+    std::chrono::nanoseconds busy_time() const {
+        return std::chrono::nanoseconds{busy_ns_.load(std::memory_order_relaxed) -
+                                        wait_ns_.load(std::memory_order_relaxed)};
+    }
+
+    /// Sets number of threads for global pool. Must be called before first use of
+    /// global pool
+    static void configure_global(std::size_t threads_count);
+
+    /// Returns reference to process wide thread pool
+    static thread_pool & global();
+
+private:
+    /// Queue of tasks of a single worker
+    struct task_queue {
+        std::mutex mtx;                             ///< Queue mutex
+        std::deque<task> tasks;                     ///< Queued tasks
+    };
+
+    /// Tries to find and execute single pending task. Returns false if there are
+    /// no pending tasks
+    bool run_pending_task();
+
+    /// Worker thread main function
+    void worker_main(std::size_t idx);
+
+    /// Returns index of queue owned by current thread or -1 for non worker threads
+    std::ptrdiff_t current_queue_index() const;
+
+    /// Queues of tasks. Last queue is used for tasks submitted from non worker threads
+    std::vector<std::unique_ptr<task_queue>> queues_;
+    std::vector<std::jthread> workers_;             ///< Worker threads
+    std::atomic<std::size_t> pending_{0};           ///< Number of queued tasks
+    std::mutex sleep_mtx_;                          ///< Mutex for sleeping workers
+    std::condition_variable sleep_cv_;              ///< Condition for waking up workers and
+                                                    ///< threads waiting for parallel loops
+    bool stop_ = false;                             ///< Stop flag (guarded by sleep_mtx_)
+    std::atomic<std::int64_t> busy_ns_{0};          ///< Time spent in outermost tasks
+    std::atomic<std::int64_t> wait_ns_{0};          ///< Time spent waiting inside tasks
+};
@@ -0,0 +1,70 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file trace_recorder.cpp
+/// Contains implementation of the trace_recorder class.
+
+#include "trace_recorder.hpp"
+#include "json_writer.hpp"
+
+
+trace_recorder & trace_recorder::global() {
+    static trace_recorder recorder;
+    return recorder;
+}
+
+
+trace_recorder::thread_buffer & trace_recorder::current_buffer() {
+    // buffer is owned by recorder, so events survive thread exit
+    static thread_local thread_buffer * buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard lock{buffers_mtx_};
+        auto tid = static_cast<std::uint32_t>(buffers_.size() + 1);
+        buffers_.push_back(std::make_unique<thread_buffer>());
+        buffer = buffers_.back().get();
+        buffer->tid = tid;
+        buffer->events.reserve(1024);
+    }
+
+    return *buffer;
+}
+
+
+void trace_recorder::write_json(std::ostream & ostr) const {
+    std::lock_guard lock{buffers_mtx_};
+
+    json_writer wr{ostr};
+    wr.begin_object();
+    wr.member("displayTimeUnit", "ms");
+    wr.key("traceEvents").begin_array();
+
+    for (auto && buf : buffers_) {
+        // writing thread name metadata event
+        if (!buf->name.empty()) {
+            wr.begin_object();
+            wr.member("name", "thread_name");
+            wr.member("ph", "M");
+            wr.member("pid", 1);
+            wr.member("tid", buf->tid);
+            wr.key("args").begin_object().member("name", buf->name).end_object();
+            wr.end_object();
+        }
+
+        for (auto && ev : buf->events) {
+            wr.begin_object();
+            wr.member("name", ev.name);
+            wr.member("ph", std::string_view{&ev.phase, 1});
+            wr.member("ts", static_cast<double>(ev.ts_ns) / 1000.0);
+            wr.member("pid", 1);
+            wr.member("tid", buf->tid);
+            wr.end_object();
+        }
+    }
+
+    wr.end_array();
+    wr.end_object();
+    ostr << std::endl;
+}
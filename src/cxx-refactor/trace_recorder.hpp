@@ -0,0 +1,106 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file trace_recorder.hpp
+/// Contains definitions of the trace_recorder and trace_scope classes.
+
+#pragma once
+
+#include "memory_arena.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/// Recorder of begin/end events of execution phases in Chrome trace event format.
+/// Each thread records events into own buffer without locking, buffers are only
+/// registered once per thread. Recording is disabled by default.
+class trace_recorder {
+public:
+    /// Trace event
+    struct event {
+        const char * name;                  ///< Event name (must be string literal)
+        std::int64_t ts_ns;                 ///< Event time in nanoseconds since recorder start
+        char phase;                         ///< Event phase: 'B' for begin, 'E' for end
+    };
+
+    /// Returns reference to process wide recorder
+    static trace_recorder & global();
+
+    /// Enables or disables recording of events
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    /// Returns true if recording of events is enabled
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /// Records event in buffer of current thread
+    void record(const char * name, char phase) {
+        auto ts = std::chrono::steady_clock::now() - start_;
+        arena_suspend no_arena;
+        current_buffer().events.push_back({name, ts.count(), phase});
+    }
+
+    /// Sets name of current thread displayed in trace viewer
+    void set_thread_name(const std::string & name) {
+        arena_suspend no_arena;
+        current_buffer().name = name;
+    }
+
+    /// Writes all recorded events in Chrome trace event JSON format. Must not be
+    /// called concurrently with recording events
+    void write_json(std::ostream & ostr) const;
+
+private:
+    /// Buffer of events of single thread
+    struct thread_buffer {
+        std::uint32_t tid;                  ///< Thread number
+        std::string name;                   ///< Thread name
+        std::vector<event> events;          ///< Recorded events
+    };
+
+    /// Constructs recorder
+    explicit trace_recorder(): start_{std::chrono::steady_clock::now()} {}
+
+    /// Returns buffer of current thread. Registers buffer on first use in thread
+    thread_buffer & current_buffer();
+
+    std::atomic<bool> enabled_{false};                      ///< Enabled flag
+    std::chrono::steady_clock::time_point start_;           ///< Recorder start time
+    mutable std::mutex buffers_mtx_;                        ///< Mutex for list of buffers
+    std::vector<std::unique_ptr<thread_buffer>> buffers_;   ///< Buffers of all threads
+};
+
+
+/// Scoped trace event. Records begin event on construction and end event
+/// on destruction if recording is enabled
+class trace_scope {
+public:
+    /// Records begin event with specified name (must be string literal)
+    explicit trace_scope(const char * name):
+    name_{trace_recorder::global().enabled() ? name : nullptr} {
+        if (name_) {
+            trace_recorder::global().record(name_, 'B');
+        }
+    }
+
+    /// Records end event
+    ~trace_scope() {
+        if (name_) {
+            trace_recorder::global().record(name_, 'E');
+        }
+    }
+
+    trace_scope(const trace_scope &) = delete;
+    trace_scope & operator=(const trace_scope &) = delete;
+
+private:
+    const char * name_;                     ///< Event name or nullptr if recording is disabled
+};
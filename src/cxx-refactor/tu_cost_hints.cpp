@@ -0,0 +1,122 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file tu_cost_hints.cpp
+/// Contains implementation of the tu_cost_hints class.
+
+#include "pch.hpp"
+#include "tu_cost_hints.hpp"
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace fs = std::filesystem;
+
+
+/// Header line of saved hints file
+static constexpr std::string_view hints_file_header = "cxx-refactor-tu-costs 1";
+
+
+void tu_cost_hints::load(const fs::path & p) {
+    std::ifstream istr{p};
+    if (!istr.is_open()) {
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(istr, line) || line != hints_file_header) {
+        std::ostringstream msg;
+        msg << "invalid translation unit costs file: " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    auto & paths = source_path_table::global();
+    std::lock_guard lock{mtx_};
+    while (std::getline(istr, line)) {
+        std::istringstream lstr{line};
+        tu_cost c;
+        if (!(lstr >> c.cost_ns >> c.size)) {
+            std::ostringstream msg;
+            msg << "invalid line in translation unit costs file " << p << ": " << line;
+            throw std::runtime_error{msg.str()};
+        }
+
+        lstr.get();
+        std::string path;
+        std::getline(lstr, path);
+        costs_[paths.intern(path)] = c;
+    }
+}
+
+
+void tu_cost_hints::save(const fs::path & p) const {
+    std::ofstream ostr{p};
+    if (!ostr.is_open()) {
+        std::ostringstream msg;
+        msg << "can't open translation unit costs file for writing: " << p;
+        throw std::runtime_error{msg.str()};
+    }
+
+    auto & paths = source_path_table::global();
+    std::lock_guard lock{mtx_};
+    ostr << hints_file_header << '\n';
+    for (auto && [file, c] : costs_) {
+        ostr << c.cost_ns << ' ' << c.size << ' ' << paths.path(file).string() << '\n';
+    }
+}
+
+
+void tu_cost_hints::record(const fs::path & tu, std::chrono::nanoseconds cost) {
+    std::error_code ec;
+    auto size = fs::file_size(tu, ec);
+    auto file = source_path_table::global().intern(tu);
+
+    std::lock_guard lock{mtx_};
+    costs_[file] = tu_cost{cost.count(), ec ? 0 : size};
+}
+
+
+std::vector<std::size_t> tu_cost_hints::order(const std::vector<fs::path> & tus) const {
+    auto & paths = source_path_table::global();
+    std::vector<double> costs(tus.size(), -1.0);
+    std::vector<std::uintmax_t> sizes(tus.size(), 0);
+
+    // taking measured costs, average cost of byte is used for estimating the rest
+    double known_ns = 0;
+    double known_bytes = 0;
+    {
+        std::lock_guard lock{mtx_};
+        for (std::size_t i = 0; i < tus.size(); ++i) {
+            std::error_code ec;
+            sizes[i] = fs::file_size(tus[i], ec);
+            if (ec) {
+                sizes[i] = 0;
+            }
+
+            auto it = costs_.find(paths.intern(tus[i]));
+            if (it != costs_.end()) {
+                costs[i] = static_cast<double>(it->second.cost_ns);
+                known_ns += static_cast<double>(it->second.cost_ns);
+                known_bytes += static_cast<double>(it->second.size);
+            }
+        }
+    }
+
+    auto ns_per_byte = known_bytes > 0 ? known_ns / known_bytes : 1.0;
+    for (std::size_t i = 0; i < tus.size(); ++i) {
+        if (costs[i] < 0) {
+            costs[i] = static_cast<double>(sizes[i]) * ns_per_byte;
+        }
+    }
+
+    std::vector<std::size_t> res(tus.size());
+    std::iota(res.begin(), res.end(), 0);
+    std::ranges::stable_sort(res, [&](auto x, auto y) { return costs[x] > costs[y]; });
+    return res;
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file tu_cost_hints.hpp
+/// Contains definition of the tu_cost_hints class.
+
+#pragma once
+
+#include "source_path_table.hpp"
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+/// Processing times of translation units measured in previous runs. Used for
+/// scheduling the most expensive translation units first, so long tail of a single
+/// giant translation unit doesn't leave other threads idle. Costs of translation
+/// units without measurements are estimated by file size. Recording of costs is
+/// thread safe.
+class tu_cost_hints {
+public:
+    /// Constructs empty hints
+    explicit tu_cost_hints() = default;
+
+    /// Loads hints from file saved by the save function. Does nothing if file doesn't exist
+    void load(const std::filesystem::path & p);
+
+    /// Saves hints to file
+    void save(const std::filesystem::path & p) const;
+
+    /// Records processing time of translation unit
+    void record(const std::filesystem::path & tu, std::chrono::nanoseconds cost);
+
+    /// Returns indices of translation units ordered by decreasing estimated cost.
+    /// Translation units with equal costs keep input order
+    std::vector<std::size_t> order(const std::vector<std::filesystem::path> & tus) const;
+
+private:
+    /// Measured cost of translation unit
+    struct tu_cost {
+        std::int64_t cost_ns = 0;           ///< Processing time
+        std::uintmax_t size = 0;            ///< File size at measurement
+    };
+
+    mutable std::mutex mtx_;                            ///< Mutex for costs map
+    std::unordered_map<file_id, tu_cost> costs_;        ///< Measured costs
+};
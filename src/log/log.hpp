@@ -7,21 +7,113 @@
 /// \file log.hpp
 /// Main include file for logging utilities.
 
+#pragma once
+
+#include <boost/log/attributes/constant.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/log/utility/manipulators/add_value.hpp>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+
+/// Minimal severity level of log statements compiled into program. Log statements
+/// with lower severity are removed at compile time. Defined by CXX_REFACTOR_LOG_MIN_LEVEL
+/// CMake option, may be redefined in translation unit before using log macros
+#ifndef REFACTOR_LOG_MIN_LEVEL
+#define REFACTOR_LOG_MIN_LEVEL 0
+#endif
 
 
 using logger_t = boost::log::sources::severity_logger_mt<boost::log::trivial::severity_level>;
 
+/// Identifier of log category (category and subcategory pair)
+using log_category_id = std::uint16_t;
+
+/// Maximum number of log categories
+inline constexpr std::size_t log_max_categories = 1024;
+
+/// Table of minimal enabled severity levels indexed by category identifier
+inline std::atomic<std::uint8_t> log_category_min_sev[log_max_categories];
+
+/// Global minimal enabled severity level, applied to records without category
+inline std::atomic<std::uint8_t> log_global_min_sev{
+    static_cast<std::uint8_t>(boost::log::trivial::info)};
+
+/// Name of attribute of logger used by log macros. Records of log macros are filtered
+/// by severity table of categories, other records are filtered by global severity level
+inline constexpr const char * log_categorized_attr = "Categorized";
+
 /// Returns reference to logger
 inline logger_t & refactor_get_logger() {
-    static logger_t logger;
+    static logger_t logger = []() {
+        logger_t res;
+        res.add_attribute(log_categorized_attr, boost::log::attributes::constant<bool>{true});
+        return res;
+    }();
+
     return logger;
 }
 
-#define REFACTOR_LOG(cat, level) \
-    BOOST_LOG_SEV(refactor_get_logger(), level) \
-        << ::boost::log::add_value("Category", #cat)
+/// Registers log category and subcategory (may be empty) and returns its identifier.
+/// Returns the same identifier for the same category and subcategory.
+log_category_id refactor_log_register_category(const char * cat, const char * subcat);
+
+/// Returns name of log category with specified identifier in form "cat" or "cat/subcat"
+const std::string & refactor_log_category_name(log_category_id id);
+
+/// Returns true if records with specified severity are enabled for category
+inline bool refactor_log_enabled(log_category_id id, boost::log::trivial::severity_level level) {
+    return static_cast<std::uint8_t>(level) >=
+        log_category_min_sev[id].load(std::memory_order_relaxed);
+}
+
+
+/// Log payload evaluated only when it is written into opened log record
+template <typename Fn>
+class log_lazy {
+public:
+    /// Constructs lazy payload from function computing payload value
+    explicit log_lazy(Fn fn): fn_{std::move(fn)} {}
+
+    /// Evaluates payload and writes result to stream
+    template <typename Stream>
+    friend Stream & operator<<(Stream & str, const log_lazy & lazy) {
+        str << lazy.fn_();
+        return str;
+    }
+
+private:
+    Fn fn_;                                 ///< Function computing payload value
+};
+
+
+/// Returns true if log statements with specified severity are compiled into program
+#define REFACTOR_LOG_COMPILED(level) \
+    (static_cast<int>(level) >= REFACTOR_LOG_MIN_LEVEL)
+
+/// Creates lazy log payload. Expression is evaluated only if log record is written
+#define REFACTOR_LOG_LAZY(expr) \
+    (log_lazy{[&]() -> decltype(auto) { return (expr); }})
+
+/// Returns identifier of log category. Category is registered once per log statement
+#define REFACTOR_LOG_CATEGORY_ID(cat, scat) \
+    ([]() -> log_category_id { \
+        static const log_category_id id = refactor_log_register_category(#cat, scat); \
+        return id; \
+    }())
+
+/// Opens log record for category if severity is enabled. Statements with severity
+/// below REFACTOR_LOG_MIN_LEVEL are discarded at compile time, severity check is done
+/// before any log attributes or stream operations
+#define REFACTOR_LOG_IMPL(cat_id, level) \
+    if constexpr (!REFACTOR_LOG_COMPILED(level)) {} else \
+    if (log_category_id refactor_log_cat_id_ = cat_id; \
+        !refactor_log_enabled(refactor_log_cat_id_, level)) {} else \
+        BOOST_LOG_SEV(refactor_get_logger(), level) \
+            << ::boost::log::add_value("CategoryId", refactor_log_cat_id_)
+
+#define REFACTOR_LOG(cat, level) REFACTOR_LOG_IMPL(REFACTOR_LOG_CATEGORY_ID(cat, ""), level)
 
 #define REFACTOR_LOG_TRACE(cat)         REFACTOR_LOG(cat, ::boost::log::trivial::trace)
 #define REFACTOR_LOG_DEBUG(cat)         REFACTOR_LOG(cat, ::boost::log::trivial::debug)
@@ -32,9 +124,7 @@ inline logger_t & refactor_get_logger() {
 
 
 #define REFACTOR_LOG_SCAT(cat, scat, level) \
-    BOOST_LOG_SEV(refactor_get_logger(), level) \
-        << ::boost::log::add_value("Category", #cat) \
-        << ::boost::log::add_value("Subcategory", #scat)
+    REFACTOR_LOG_IMPL(REFACTOR_LOG_CATEGORY_ID(cat, #scat), level)
 
 #define REFACTOR_LOG_SCAT_TRACE(cat, scat)      REFACTOR_LOG_SCAT(cat, scat, ::boost::log::trivial::trace)
 #define REFACTOR_LOG_SCAT_DEBUG(cat, scat)      REFACTOR_LOG_SCAT(cat, scat, ::boost::log::trivial::debug)
@@ -0,0 +1,111 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_category.cpp
+/// Contains implementation of log categories registry.
+
+#include "log.hpp"
+#include "log_init.hpp"
+#include <cassert>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+
+namespace bl = boost::log;
+
+
+/// Registry of log categories and their severity levels
+struct log_category_registry {
+    /// Returns minimal severity level for category and subcategory according
+    /// to current configuration
+    bl::trivial::severity_level category_sev(const std::string & cat,
+                                             const std::string & subcat) const {
+        // first trying get level for subcategory
+        if (!subcat.empty()) {
+            auto it = cat_sev.find(cat + "/" + subcat);
+            if (it != cat_sev.end()) {
+                return it->second;
+            }
+        }
+
+        // next trying get level for category
+        auto it = cat_sev.find(cat);
+        if (it != cat_sev.end()) {
+            return it->second;
+        }
+
+        return global_sev;
+    }
+
+    std::mutex mtx;                                     ///< Registry mutex
+    std::deque<std::pair<std::string, std::string>> categories; ///< Registered categories
+    std::deque<std::string> names;                      ///< Full names of registered categories
+    std::unordered_map<std::string, log_category_id> ids;   ///< Full name to identifier map
+    bl::trivial::severity_level global_sev = bl::trivial::info;         ///< Global severity level
+    std::unordered_map<std::string, bl::trivial::severity_level> cat_sev;   ///< Categories levels
+};
+
+
+/// Returns reference to log categories registry
+static log_category_registry & get_registry() {
+    static log_category_registry registry;
+    return registry;
+}
+
+
+log_category_id refactor_log_register_category(const char * cat, const char * subcat) {
+    auto & reg = get_registry();
+    std::lock_guard lock{reg.mtx};
+
+    std::string name = cat;
+    if (*subcat != '\0') {
+        name += "/";
+        name += subcat;
+    }
+
+    auto it = reg.ids.find(name);
+    if (it != reg.ids.end()) {
+        return it->second;
+    }
+
+    assert(reg.names.size() < log_max_categories && "too many log categories");
+    auto id = static_cast<log_category_id>(reg.names.size());
+    reg.categories.emplace_back(cat, subcat);
+    reg.names.push_back(name);
+    reg.ids.emplace(name, id);
+
+    auto sev = reg.category_sev(reg.categories.back().first, reg.categories.back().second);
+    log_category_min_sev[id].store(static_cast<std::uint8_t>(sev), std::memory_order_relaxed);
+
+    return id;
+}
+
+
+const std::string & refactor_log_category_name(log_category_id id) {
+    auto & reg = get_registry();
+    std::lock_guard lock{reg.mtx};
+    return reg.names.at(id);
+}
+
+
+void refactor_log_configure(bl::trivial::severity_level global_sev,
+                            const std::unordered_map<std::string,
+                                                     bl::trivial::severity_level> & cat_sev) {
+    auto & reg = get_registry();
+    std::lock_guard lock{reg.mtx};
+    reg.global_sev = global_sev;
+    reg.cat_sev = cat_sev;
+    log_global_min_sev.store(static_cast<std::uint8_t>(global_sev), std::memory_order_relaxed);
+
+    // recomputing severity levels of all registered categories
+    for (std::size_t id = 0; id < reg.categories.size(); ++id) {
+        auto & [cat, subcat] = reg.categories[id];
+        auto sev = reg.category_sev(cat, subcat);
+        log_category_min_sev[id].store(static_cast<std::uint8_t>(sev), std::memory_order_relaxed);
+    }
+}
+
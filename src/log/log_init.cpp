@@ -8,13 +8,17 @@
 /// Contains implementation of common log initialization functions.
 
 #include "log_init.hpp"
-#include <boost/log/attributes/timer.hpp>
+#include "log_ring_queue.hpp"
 #include <boost/log/attributes/value_extraction.hpp>
+#include <boost/log/sinks/async_frontend.hpp>
 #include <boost/log/sinks/text_file_backend.hpp>
 #include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
 #include <boost/log/utility/setup.hpp>
 #include <boost/program_options.hpp>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 
@@ -23,31 +27,132 @@ namespace fs = std::filesystem;
 namespace po = boost::program_options;
 
 
+/// Sets log core filter applying global severity level to records without category.
+/// Records of log macros are filtered by severity table of categories before record
+/// is opened (category attributes are attached to record after opening, so core
+/// filter can't see them), they are recognized by attribute of macros logger
+static void set_uncategorized_filter() {
+    bl::core::get()->set_filter([](const bl::attribute_value_set & attrs) {
+        if (attrs.count(log_categorized_attr) != 0) {
+            return true;
+        }
+
+        auto sev = attrs[bl::trivial::severity];
+        return !sev || static_cast<std::uint8_t>(*sev) >=
+            log_global_min_sev.load(std::memory_order_relaxed);
+    });
+}
+
+
+/// Background writer thread of asynchronous sink. Waits for records in sink
+/// queue and feeds all available records to backend flushing it once per batch
+class async_sink_writer {
+public:
+    /// Starts writer thread for specified sink
+    template <typename Sink>
+    explicit async_sink_writer(const boost::shared_ptr<Sink> & sink):
+    interrupt_{[sink]() { sink->interrupt_wait(); }},
+    dropped_{[sink]() { return sink->dropped(); }} {
+        thread_ = std::thread{[this, sink]() {
+            while (!stop_.load(std::memory_order_acquire)) {
+                sink->wait_records();
+                sink->flush();
+            }
+
+            // feeding remaining records
+            sink->flush();
+        }};
+    }
+
+    /// Stops writer thread. All queued records are written before stopping
+    ~async_sink_writer() {
+        stop_.store(true, std::memory_order_release);
+        interrupt_();
+        thread_.join();
+    }
+
+    /// Returns number of records dropped due to queue overflow
+    std::uint64_t dropped() const { return dropped_(); }
+
+private:
+    std::atomic<bool> stop_{false};                     ///< Stop flag
+    std::function<void()> interrupt_;                   ///< Interrupts waiting for records
+    std::function<std::uint64_t()> dropped_;            ///< Returns number of dropped records
+    std::thread thread_;                                ///< Writer thread
+};
+
+
+/// Writers of all asynchronous sinks
+static std::vector<std::unique_ptr<async_sink_writer>> async_writers;
+
+/// Mutex for writers of asynchronous sinks
+static std::mutex async_writers_mtx;
+
+
+/// Stops all asynchronous writers. Returns number of dropped records
+static std::uint64_t stop_async_writers() {
+    std::lock_guard lock{async_writers_mtx};
+
+    std::uint64_t dropped = 0;
+    for (auto && writer : async_writers) {
+        dropped += writer->dropped();
+    }
+
+    async_writers.clear();
+    return dropped;
+}
+
+
+/// Stops asynchronous writers on exit if log was not shut down explicitly,
+/// so all queued records are written
+static struct async_writers_guard {
+    ~async_writers_guard() { stop_async_writers(); }
+} async_writers_guard_inst;
+
+
+/// Creates sink for specified backend and adds it to log core
 template <typename T>
-static auto make_sink(const boost::shared_ptr<T> & backend) {
+static void add_sink(const boost::shared_ptr<T> & backend, const log_sink_options & opts) {
+    if (opts.async) {
+        using sink_t = bl::sinks::asynchronous_sink<T, log_ring_queue>;
+        auto sink = boost::make_shared<sink_t>(backend,
+                                               log_keywords::queue_capacity = opts.queue_size,
+                                               log_keywords::overflow_policy = opts.overflow,
+                                               bl::keywords::start_thread = false);
+        setup_sink_formatting(*sink);
+        bl::core::get()->add_sink(sink);
+
+        std::lock_guard lock{async_writers_mtx};
+        async_writers.push_back(std::make_unique<async_sink_writer>(sink));
+        return;
+    }
+
     using sink_t = bl::sinks::synchronous_sink<T>;
     auto sink = boost::make_shared<sink_t>(backend);
     setup_sink_formatting(*sink);
-    return sink;
+    bl::core::get()->add_sink(sink);
 }
 
 
-void log_init(bool log_console, const fs::path & log_file) {
+void log_init(bool log_console, const fs::path & log_file, const log_sink_options & opts) {
 
     if (!log_file.empty()) {
         fs::create_directories(log_file.parent_path());
+
+        // asynchronous writer flushes file once per batch of records
         auto backend = boost::make_shared<bl::sinks::text_file_backend>(bl::keywords::file_name = log_file,
-                                                                        bl::keywords::auto_flush = true);
-        bl::core::get()->add_sink(make_sink(backend));
+                                                                        bl::keywords::auto_flush = !opts.async);
+        add_sink(backend, opts);
     }
     
     if (log_console) {
         auto backend = boost::make_shared<bl::sinks::text_ostream_backend>();
         backend->add_stream(boost::shared_ptr<std::ostream>(&std::cerr, boost::null_deleter()));
-        bl::core::get()->add_sink(make_sink(backend));
+        add_sink(backend, opts);
     }
 
-    bl::core::get()->set_filter(bl::trivial::severity >= bl::trivial::info);
+    refactor_log_configure(bl::trivial::info, {});
+    set_uncategorized_filter();
 }
 
 
@@ -68,7 +173,27 @@ void log_init(const po::variables_map & vars,
               bool log_console,
               const fs::path & def_log_file) {
     fs::path log_file = vars.count("log-file") ? vars["log-file"].as<fs::path>() : def_log_file;
-    log_init(log_console, log_file);
+
+    log_sink_options sink_opts;
+    sink_opts.async = vars.count("log-async") > 0;
+    if (vars.count("log-queue-size") > 0) {
+        sink_opts.queue_size = vars["log-queue-size"].as<std::size_t>();
+    }
+
+    if (vars.count("log-overflow") > 0) {
+        auto policy = vars["log-overflow"].as<std::string>();
+        if (policy == "block") {
+            sink_opts.overflow = log_overflow_policy::block;
+        } else if (policy == "drop") {
+            sink_opts.overflow = log_overflow_policy::drop;
+        } else {
+            std::ostringstream msg;
+            msg << "invalid log overflow policy: '" << policy << "'";
+            throw std::runtime_error(msg.str());
+        }
+    }
+
+    log_init(log_console, log_file, sink_opts);
 
     if (vars.count("log-level") == 0) {
         return;
@@ -106,39 +231,8 @@ void log_init(const po::variables_map & vars,
     }
 
 
-    // setting custom log filter
-
-    auto filter = [global_sev, cat_sev_map](const bl::attribute_value_set & attrs) -> bool {
-        // extracting severity
-        bl::trivial::severity_level sev = bl::trivial::severity_level::info;
-        auto sev_attr = attrs[bl::trivial::severity];
-        if (!sev_attr.empty()) {
-            sev = *sev_attr;
-        }
-
-        // extracting category and subcategory
-        auto cat = attrs["Category"].extract_or_default<std::string, void, std::string>(std::string{});
-        auto subcat = attrs["Subcategory"].extract_or_default<std::string, void, std::string>(std::string{});
-
-        // first trying get level for subcategory
-        if (!subcat.empty()) {
-            auto it = cat_sev_map.find(cat + "/" + subcat);
-            if (it != cat_sev_map.end()) {
-                return sev >= it->second;
-            }
-        }
-
-        // next truing get level for category
-        auto it = cat_sev_map.find(cat);
-        if (it != cat_sev_map.end()) {
-            return sev >= it->second;
-        }
-
-        // checking global level
-        return sev >= global_sev;
-    };
-
-    bl::core::get()->set_filter(filter);
+    // updating severity table of log categories
+    refactor_log_configure(global_sev, cat_sev_map);
 }
 
 
@@ -148,7 +242,25 @@ po::options_description log_options() {
     desc.add_options()
             ("log-level", po::value<std::string>(),
                 "Logging level (trace, debug, info, warning, error, fatal)")
-            ("log-file", po::value<fs::path>(), "Path to log file");
+            ("log-file", po::value<fs::path>(), "Path to log file")
+            ("log-async", "Write log records from background thread")
+            ("log-queue-size", po::value<std::size_t>(),
+                "Capacity of asynchronous log queue (default: 8192)")
+            ("log-overflow", po::value<std::string>(),
+                "Asynchronous log queue overflow policy: block (default) or drop");
 
     return desc;
 }
+
+
+void log_shutdown() {
+    auto dropped = stop_async_writers();
+
+    bl::core::get()->flush();
+    bl::core::get()->remove_all_sinks();
+
+    if (dropped != 0) {
+        std::cerr << "WARNING: " << dropped << " log records were dropped "
+                  << "due to asynchronous log queue overflow" << std::endl;
+    }
+}
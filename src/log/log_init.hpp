@@ -9,7 +9,10 @@
 
 #pragma once
 
+#include "log.hpp"
+#include "log_ring_queue.hpp"
 #include <filesystem>
+#include <unordered_map>
 #include <boost/program_options/variables_map.hpp>
 #include <boost/program_options/options_description.hpp>
 #include <boost/log/expressions.hpp>
@@ -17,8 +20,30 @@
 #include <boost/log/trivial.hpp>
 
 
+/// Options of log sinks
+struct log_sink_options {
+    bool async = false;                     ///< Write records from background thread
+    std::size_t queue_size = 8192;          ///< Capacity of asynchronous queue
+    log_overflow_policy overflow = log_overflow_policy::block;  ///< Queue overflow policy
+};
+
 /// Initializes log sinks and formatting
-void log_init(bool log_console, const std::filesystem::path & log_file = {});
+void log_init(bool log_console,
+              const std::filesystem::path & log_file = {},
+              const log_sink_options & opts = {});
+
+/// Writes all queued records, stops asynchronous writers and removes all log sinks
+void log_shutdown();
+
+/// Shuts down log on destruction
+class log_shutdown_guard {
+public:
+    explicit log_shutdown_guard() = default;
+    ~log_shutdown_guard() { log_shutdown(); }
+
+    log_shutdown_guard(const log_shutdown_guard &) = delete;
+    log_shutdown_guard & operator=(const log_shutdown_guard &) = delete;
+};
 
 /// Initializes log and configures log from porgram options
 void log_init(const boost::program_options::variables_map & vars,
@@ -28,19 +53,24 @@ void log_init(const boost::program_options::variables_map & vars,
 /// Creates options description for log configuration options
 boost::program_options::options_description log_options();
 
+/// Sets global severity level and severity levels of categories ("cat" or "cat/subcat")
+/// and recomputes severity table of registered categories. Global severity level is
+/// also applied to records written without log macros
+void refactor_log_configure(boost::log::trivial::severity_level global_sev,
+                            const std::unordered_map<std::string,
+                                                     boost::log::trivial::severity_level> & cat_sev);
+
 /// Sets up formatting for sink
 template <typename Sink>
 void setup_sink_formatting(Sink & sink) {
     auto fmt = [](const boost::log::record_view & rec, boost::log::formatting_ostream & str) {
         str << "[" << rec[boost::log::trivial::severity] << "] ";
 
-        auto cat = boost::log::extract_or_default<std::string>("Category", rec, std::string{});
-        auto subcat = boost::log::extract_or_default<std::string>("Subcategory", rec, std::string{});
-
-        if (subcat.empty()) {
-            str << "[" << cat << "]";
+        auto cat_id = boost::log::extract<log_category_id>("CategoryId", rec);
+        if (cat_id) {
+            str << "[" << refactor_log_category_name(*cat_id) << "]";
         } else {
-            str << "[" << cat << "/" << subcat << "]";
+            str << "[]";
         }
 
         str << " " << rec[boost::log::expressions::smessage];
@@ -0,0 +1,204 @@
+// Copyright (c) 2024, Alexandr Esilevich
+// 
+// Distributed under the BSD 2-Clause License.
+// See accompanying file LICENSE for license information.
+//
+
+/// \file log_ring_queue.hpp
+/// Contains definition of the log_ring_queue class.
+
+#pragma once
+
+#include <boost/log/core/record_view.hpp>
+#include <boost/parameter/keyword.hpp>
+#include <atomic>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+
+/// Policy of handling overflow of asynchronous log queue
+enum class log_overflow_policy {
+    block,                                  ///< Block producer until there is space in queue
+    drop                                    ///< Drop record
+};
+
+
+namespace log_keywords {
+
+BOOST_PARAMETER_KEYWORD(tag, queue_capacity)
+BOOST_PARAMETER_KEYWORD(tag, overflow_policy)
+
+}
+
+
+/// Bounded lock free multi producer multi consumer queue of log records implementing
+/// queueing strategy of boost::log::sinks::asynchronous_sink. Capacity is rounded up
+/// to power of two. Constructed with log_keywords::queue_capacity and
+/// log_keywords::overflow_policy named arguments.
+class log_ring_queue {
+public:
+    /// Waits until queue contains records or dequeue is interrupted
+    void wait_records() {
+        while (true) {
+            auto epoch = epoch_.load(std::memory_order_acquire);
+            if (!empty() || interrupted_.load(std::memory_order_acquire)) {
+                return;
+            }
+
+            // fence pairs with fence in wake_consumer, so either consumer sees new
+            // record or producer sees waiting consumer
+            consumer_waiting_.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (empty() && !interrupted_.load(std::memory_order_acquire)) {
+                epoch_.wait(epoch, std::memory_order_acquire);
+            }
+            consumer_waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /// Returns true if queue is empty
+    bool empty() const {
+        return enqueue_pos_.load(std::memory_order_acquire) ==
+               dequeue_pos_.load(std::memory_order_acquire);
+    }
+
+    /// Returns number of dropped records
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    /// Interrupts waiting for records in wait_records function
+    void interrupt_wait() { interrupt_dequeue(); }
+
+protected:
+    /// Constructs queue from named arguments
+    template <typename ArgsT>
+    explicit log_ring_queue(const ArgsT & args):
+    capacity_{std::bit_ceil(std::max<std::size_t>(args[log_keywords::queue_capacity | 8192], 2))},
+    policy_{args[log_keywords::overflow_policy | log_overflow_policy::block]},
+    cells_{std::make_unique<cell[]>(capacity_)} {
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// Enqueues record. Blocks or drops record if queue is full depending on policy
+    void enqueue(const boost::log::record_view & rec) {
+        for (unsigned spins = 0; !try_push(rec); ++spins) {
+            if (policy_ == log_overflow_policy::drop) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // waiting for consumer to free space in queue
+            if (spins < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds{50});
+            }
+        }
+    }
+
+    /// Tries to enqueue record without blocking
+    bool try_enqueue(const boost::log::record_view & rec) { return try_push(rec); }
+
+    /// Tries to dequeue record
+    bool try_dequeue_ready(boost::log::record_view & rec) { return try_pop(rec); }
+
+    /// Tries to dequeue record
+    bool try_dequeue(boost::log::record_view & rec) { return try_pop(rec); }
+
+    /// Dequeues record. Blocks until record is available or dequeue is interrupted
+    bool dequeue_ready(boost::log::record_view & rec) {
+        while (true) {
+            if (try_pop(rec)) {
+                return true;
+            }
+
+            if (interrupted_.exchange(false, std::memory_order_acq_rel)) {
+                return false;
+            }
+
+            wait_records();
+        }
+    }
+
+    /// Interrupts blocking dequeue
+    void interrupt_dequeue() {
+        interrupted_.store(true, std::memory_order_release);
+        wake_consumer(true);
+    }
+
+private:
+    /// Queue cell
+    struct cell {
+        std::atomic<std::size_t> seq;       ///< Cell sequence number
+        boost::log::record_view rec;        ///< Queued record
+    };
+
+    /// Tries to push record into queue. Returns false if queue is full
+    bool try_push(const boost::log::record_view & rec) {
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            auto & c = cells_[pos & (capacity_ - 1)];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.rec = rec;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    wake_consumer(false);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Tries to pop record from queue. Returns false if queue is empty
+    bool try_pop(boost::log::record_view & rec) {
+        auto pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            auto & c = cells_[pos & (capacity_ - 1)];
+            auto seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    rec.swap(c.rec);
+                    c.rec = boost::log::record_view{};
+                    c.seq.store(pos + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Wakes up consumer waiting for records. Producers only pay for notification
+    /// if consumer is actually waiting
+    void wake_consumer(bool force) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (force || consumer_waiting_.load(std::memory_order_relaxed)) {
+            epoch_.fetch_add(1, std::memory_order_release);
+            epoch_.notify_all();
+        }
+    }
+
+    const std::size_t capacity_;                        ///< Queue capacity (power of two)
+    const log_overflow_policy policy_;                  ///< Overflow policy
+    std::unique_ptr<cell[]> cells_;                     ///< Queue cells
+    alignas(64) std::atomic<std::size_t> enqueue_pos_{0};  ///< Enqueue position
+    alignas(64) std::atomic<std::size_t> dequeue_pos_{0};  ///< Dequeue position
+    alignas(64) std::atomic<std::uint32_t> epoch_{0};   ///< Wake up epoch for waiting consumer
+    std::atomic<bool> consumer_waiting_{false};         ///< True if consumer is waiting
+    std::atomic<bool> interrupted_{false};              ///< Dequeue interruption flag
+    std::atomic<std::uint64_t> dropped_{0};             ///< Number of dropped records
+};